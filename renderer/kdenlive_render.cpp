@@ -20,11 +20,13 @@
 #include "framework/mlt_version.h"
 #include "mlt++/Mlt.h"
 #include "renderjob.h"
+#include "segmentedrenderjob.h"
 #include <QApplication>
 #include <QDir>
 #include <QDomDocument>
 #include <QString>
 #include <QStringList>
+#include <QTextStream>
 #include <QObject>
 #include <cstdio>
 
@@ -52,6 +54,26 @@ int main(int argc, char **argv)
             pid = args.at(0).section(QLatin1Char(':'), 1).toInt();
             args.removeFirst();
         }
+        // Do we want to render the video in concurrent segments
+        int segments = 0;
+        QString ffmpeg = QStringLiteral("ffmpeg");
+        while (args.count() > 0 && (args.at(0).startsWith(QLatin1String("-segments:")) || args.at(0).startsWith(QLatin1String("-ffmpeg:")))) {
+            if (args.at(0).startsWith(QLatin1String("-segments:"))) {
+                segments = args.at(0).section(QLatin1Char(':'), 1).toInt();
+            } else {
+                ffmpeg = args.at(0).section(QLatin1Char(':'), 1);
+            }
+            args.removeFirst();
+        }
+        if (segments > 1) {
+            auto *sJob = new SegmentedRenderJob(render, playlist, target, pid, segments, ffmpeg, qApp);
+            QObject::connect(sJob, &RenderJob::renderingFinished, [&, sJob]() {
+                sJob->deleteLater();
+                app.quit();
+            });
+            QMetaObject::invokeMethod(sJob, "start", Qt::QueuedConnection);
+            return app.exec();
+        }
         // Do we want a split render
         if (args.count() > 0 && args.at(0) == QLatin1String("-split")) {
             args.removeFirst();
@@ -89,7 +111,26 @@ int main(int argc, char **argv)
             }
             const char *localename = prod.get_lcnumeric();
             QLocale::setDefault(QLocale(localename));
-            for (const QString &frame : chunks) {
+            // With a "-" chunk list, chunks are read from stdin until it is closed, so that a pool of processes can share the work
+            const bool readInput = chunks == QStringList{QStringLiteral("-")};
+            QTextStream input(stdin);
+            int index = 0;
+            while (true) {
+                QString frame;
+                if (readInput) {
+                    frame = input.readLine();
+                    if (frame.isNull()) {
+                        break;
+                    }
+                    frame = frame.trimmed();
+                    if (frame.isEmpty()) {
+                        continue;
+                    }
+                } else if (index < chunks.count()) {
+                    frame = chunks.at(index++);
+                } else {
+                    break;
+                }
                 fprintf(stderr, "START:%d \n", frame.toInt());
                 QString fileName = QStringLiteral("%1.%2").arg(frame).arg(extension);
                 if (baseFolder.exists(fileName)) {
@@ -154,6 +195,8 @@ int main(int argc, char **argv)
                 "  -erase: if that parameter is present, src file will be erased at the end\n"
                 "  -kuiserver: if that parameter is present, use KDE job tracker\n"
                 "  -locale:LOCALE : set a locale for rendering. For example, -locale:fr_FR.UTF-8 will use a french locale (comma as numeric separator)\n"
+                "  -segments:COUNT : render the video in COUNT concurrent segments, joined without re-encoding by ffmpeg\n"
+                "  -ffmpeg:PATH : path to ffmpeg, used to join the segments\n"
                 "  in=pos: start rendering at frame pos\n"
                 "  out=pos: end rendering at frame pos\n"
                 "  render: path to MLT melt renderer\n"
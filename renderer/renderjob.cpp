@@ -97,11 +97,7 @@ void RenderJob::slotAbort()
     qWarning() << "Job aborted by user...";
     m_renderProcess->kill();
 
-    if (m_kdenliveinterface) {
-        m_dbusargs[1] = -3;
-        m_dbusargs.append(QString());
-        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
-    }
+    sendFinished(-3, QString());
     if (m_jobUiserver) {
         m_jobUiserver->call(QStringLiteral("terminate"), QString());
     }
@@ -133,32 +129,55 @@ void RenderJob::receivedStderr()
             m_progress = 50 + m_progress / 2.0;
         }
         int frame = result.section(QLatin1Char(','), 1).section(QLatin1Char(' '), -1).toInt();
-        if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
-            m_dbusargs[1] = m_progress;
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+        sendProgress(frame);
+    }
+}
+
+void RenderJob::sendProgress(int frame)
+{
+    if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
+        m_dbusargs[1] = m_progress;
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+    }
+    if (m_jobUiserver) {
+        m_jobUiserver->call(QStringLiteral("setPercent"), (uint)m_progress);
+        int seconds = m_startTime.secsTo(QTime::currentTime());
+        if (seconds < 0) {
+            // 1 day offset, add seconds in a day
+            seconds += 86400;
         }
-        if (m_jobUiserver) {
-            m_jobUiserver->call(QStringLiteral("setPercent"), (uint)m_progress);
-            int seconds = m_startTime.secsTo(QTime::currentTime());
-            if (seconds < 0) {
-                // 1 day offset, add seconds in a day
-                seconds += 86400;
-            }
-            seconds = (int)(seconds * (100 - m_progress) / m_progress);
-            if (seconds == m_seconds) {
-                return;
-            }
-            m_jobUiserver->call(QStringLiteral("setDescriptionField"), (uint)0, QString(),
-                                tr("Remaining time: ") + QTime(0, 0, 0).addSecs(seconds).toString(QStringLiteral("hh:mm:ss")));
-            // m_jobUiserver->call(QStringLiteral("setSpeed"), (frame - m_frame) / (seconds - m_seconds));
-            // m_jobUiserver->call("setSpeed", (frame - m_frame) / (seconds - m_seconds));
-            m_frame = frame;
-            m_seconds = seconds;
+        seconds = (int)(seconds * (100 - m_progress) / m_progress);
+        if (seconds == m_seconds) {
+            return;
         }
+        m_jobUiserver->call(QStringLiteral("setDescriptionField"), (uint)0, QString(),
+                            tr("Remaining time: ") + QTime(0, 0, 0).addSecs(seconds).toString(QStringLiteral("hh:mm:ss")));
+        // m_jobUiserver->call(QStringLiteral("setSpeed"), (frame - m_frame) / (seconds - m_seconds));
+        // m_jobUiserver->call("setSpeed", (frame - m_frame) / (seconds - m_seconds));
+        m_frame = frame;
+        m_seconds = seconds;
     }
 }
 
 void RenderJob::start()
+{
+    initInterfaces();
+
+    // Make sure the destination directory is writable
+    /*QFileInfo checkDestination(QFileInfo(m_dest).absolutePath());
+    if (!checkDestination.isWritable()) {
+        slotIsOver(QProcess::NormalExit, false);
+    }*/
+
+    // Because of the logging, we connect to stderr in all cases.
+    connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+    m_renderProcess->start(m_prog, m_args);
+    qDebug() << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' '));
+    m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+}
+
+void RenderJob::initInterfaces()
 {
     QDBusConnectionInterface *interface = QDBusConnection::sessionBus().interface();
     if ((interface != nullptr) && m_usekuiserver) {
@@ -200,19 +219,6 @@ void RenderJob::start()
     if (m_pid > -1) {
         initKdenliveDbusInterface();
     }
-
-    // Make sure the destination directory is writable
-    /*QFileInfo checkDestination(QFileInfo(m_dest).absolutePath());
-    if (!checkDestination.isWritable()) {
-        slotIsOver(QProcess::NormalExit, false);
-    }*/
-
-    // Because of the logging, we connect to stderr in all cases.
-    connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
-    m_renderProcess->start(m_prog, m_args);
-    qDebug() << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' '));
-    m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
-    m_logstream.flush();
 }
 
 void RenderJob::initKdenliveDbusInterface()
@@ -249,6 +255,15 @@ void RenderJob::initKdenliveDbusInterface()
     }
 }
 
+void RenderJob::sendFinished(int status, const QString &error)
+{
+    if (m_kdenliveinterface) {
+        m_dbusargs[1] = status;
+        m_dbusargs.append(error);
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+    }
+}
+
 void RenderJob::slotCheckProcess(QProcess::ProcessState state)
 {
     if (state == QProcess::NotRunning) {
@@ -279,11 +294,7 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
     }
     if (status == QProcess::CrashExit || m_renderProcess->error() != QProcess::UnknownError || m_renderProcess->exitCode() != 0) {
         // rendering crashed
-        if (m_kdenliveinterface) {
-            m_dbusargs[1] = (int)-2;
-            m_dbusargs.append(m_errorMessage);
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
-        }
+        sendFinished(-2, m_errorMessage);
         QStringList args;
         QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
         args << QStringLiteral("--error") << error;
@@ -291,10 +302,8 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
         QProcess::startDetached(QStringLiteral("kdialog"), args);
         emit renderingFinished();
     } else {
-        if (!m_dualpass && (m_kdenliveinterface != nullptr)) {
-            m_dbusargs[1] = (int)-1;
-            m_dbusargs.append(QString());
-            m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+        if (!m_dualpass) {
+            sendFinished(-1, QString());
         }
         m_logstream << "Rendering of " << m_dest << " finished" << "\n";
         if (!m_dualpass && m_player.length() > 3 && m_player.contains(QLatin1Char(' '))) {
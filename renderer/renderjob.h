@@ -34,20 +34,22 @@ class RenderJob : public QObject
 
 public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1, QObject *parent = nullptr);
-    ~RenderJob();
+    ~RenderJob() override;
     void setLocale(const QString &locale);
 
 public slots:
-    void start();
+    virtual void start();
+
+protected slots:
+    virtual void slotAbort();
 
 private slots:
     void slotIsOver(QProcess::ExitStatus status, bool isWritable = true);
     void receivedStderr();
-    void slotAbort();
     void slotAbort(const QString &url);
     void slotCheckProcess(QProcess::ProcessState state);
 
-private:
+protected:
     QString m_scenelist;
     QString m_dest;
     int m_progress;
@@ -72,6 +74,12 @@ private:
     /** @brief Used to write to the log file. */
     QTextStream m_logstream;
     void initKdenliveDbusInterface();
+    /** @brief Connects to the job tracker and to the Kdenlive instance that started the job */
+    void initInterfaces();
+    /** @brief Reports m_progress to the job tracker and to Kdenlive */
+    void sendProgress(int frame);
+    /** @brief Reports the end of the job to Kdenlive, status is -1 for success, -2 for a crash and -3 for an abort */
+    void sendFinished(int status, const QString &error);
 
 signals:
     void renderingFinished();
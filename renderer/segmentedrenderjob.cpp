@@ -0,0 +1,355 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "segmentedrenderjob.h"
+
+#include <QDBusInterface>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+namespace {
+// Keyframe interval used by x264 when the profile does not set one
+const int defaultGopSize = 250;
+} // namespace
+
+SegmentedRenderJob::SegmentedRenderJob(const QString &render, const QString &scenelist, const QString &target, int pid, int segments, const QString &ffmpeg,
+                                       QObject *parent)
+    : RenderJob(render, scenelist, target, pid, -1, -1, parent)
+    , m_hasAudio(false)
+    , m_maxProcesses(qMax(1, segments))
+    , m_ffmpeg(ffmpeg)
+    , m_concatProcess(nullptr)
+{
+}
+
+SegmentedRenderJob::~SegmentedRenderJob()
+{
+    for (const Segment &segment : m_segments) {
+        if (segment.running) {
+            segment.process->disconnect(this);
+            segment.process->kill();
+            segment.process->waitForFinished();
+        }
+    }
+}
+
+bool SegmentedRenderJob::prepareSegments(QString &error)
+{
+    QFile file(m_scenelist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file, false)) {
+        error = tr("Cannot read playlist %1").arg(m_scenelist);
+        return false;
+    }
+    file.close();
+    QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    const int in = consumer.attribute(QStringLiteral("in"), QStringLiteral("0")).toInt();
+    const int out = consumer.attribute(QStringLiteral("out"), QStringLiteral("-1")).toInt();
+    if (consumer.isNull() || out < in) {
+        error = tr("Cannot split %1, the render zone is unknown").arg(m_scenelist);
+        return false;
+    }
+    // Segments contain whole GOPs, so that they concatenate into the same stream as a single pass render
+    int gop = consumer.attribute(QStringLiteral("g")).toInt();
+    if (gop <= 0) {
+        gop = defaultGopSize;
+    }
+    const int gops = (out - in + gop) / gop;
+    const int segmentLength = (gops + m_maxProcesses - 1) / m_maxProcesses * gop;
+    m_hasAudio = consumer.attribute(QStringLiteral("an")).toInt() == 0 && consumer.attribute(QStringLiteral("audio_off")).toInt() == 0;
+    // Workaround MLT embedded consumer resize (MLT issue #453)
+    const bool multi = consumer.hasAttribute(QLatin1String("s")) || consumer.hasAttribute(QLatin1String("r"));
+
+    const QFileInfo info(m_dest);
+    const QString base = info.absoluteDir().absoluteFilePath(info.completeBaseName());
+    const QString playlistBase = m_scenelist.section(QLatin1Char('.'), 0, -2);
+    auto writeSegment = [&](Segment &segment, int ix) {
+        segment.playlist = QStringLiteral("%1-segment%2.mlt").arg(playlistBase).arg(ix);
+        consumer.setAttribute(QStringLiteral("target"), segment.target);
+        consumer.setAttribute(QStringLiteral("real_time"), -1);
+        QFile playlist(segment.playlist);
+        if (!playlist.open(QIODevice::WriteOnly | QIODevice::Text) || playlist.write(doc.toString().toUtf8()) < 0) {
+            error = tr("Cannot write to file %1").arg(segment.playlist);
+            return false;
+        }
+        if (multi) {
+            segment.playlist = QStringLiteral("xml:%1?multi=1").arg(segment.playlist);
+        }
+        return true;
+    };
+
+    consumer.setAttribute(QStringLiteral("an"), 1);
+    for (int start = in; start <= out; start += segmentLength) {
+        Segment segment;
+        const int end = qMin(out, start + segmentLength - 1);
+        segment.frames = end - start + 1;
+        segment.target = QStringLiteral("%1.segment%2.%3").arg(base).arg(m_segments.count()).arg(info.suffix());
+        consumer.setAttribute(QStringLiteral("in"), start);
+        consumer.setAttribute(QStringLiteral("out"), end);
+        if (!writeSegment(segment, m_segments.count())) {
+            return false;
+        }
+        m_segments << segment;
+    }
+    if (m_hasAudio) {
+        // The audio is rendered in one continuous pass, in a container accepting any codec
+        Segment segment;
+        segment.frames = out - in + 1;
+        segment.target = QStringLiteral("%1.audio.mka").arg(base);
+        consumer.setAttribute(QStringLiteral("in"), in);
+        consumer.setAttribute(QStringLiteral("out"), out);
+        consumer.removeAttribute(QStringLiteral("an"));
+        consumer.setAttribute(QStringLiteral("vn"), 1);
+        consumer.setAttribute(QStringLiteral("video_off"), 1);
+        consumer.setAttribute(QStringLiteral("f"), QStringLiteral("matroska"));
+        if (!writeSegment(segment, m_segments.count())) {
+            return false;
+        }
+        m_segments << segment;
+    }
+    return true;
+}
+
+void SegmentedRenderJob::start()
+{
+    initInterfaces();
+    QString error;
+    if (!prepareSegments(error)) {
+        fail(error);
+        return;
+    }
+    m_logstream << "Rendering " << m_dest << " in " << (m_segments.count() - (m_hasAudio ? 1 : 0)) << " segments" << "\n";
+    if (m_hasAudio) {
+        // The audio pass is light, it runs next to the video segments
+        startSegment(m_segments.count() - 1);
+    }
+    startNextSegments();
+}
+
+void SegmentedRenderJob::startSegment(int ix)
+{
+    Segment &segment = m_segments[ix];
+    segment.process = new QProcess(this);
+    segment.process->setReadChannel(QProcess::StandardError);
+    segment.running = true;
+    connect(segment.process, &QProcess::readyReadStandardError, this, [this, ix]() { segmentOutput(ix); });
+    connect(segment.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, ix]() { segmentFinished(ix); });
+    connect(segment.process, &QProcess::errorOccurred, this, [this, ix](QProcess::ProcessError processError) {
+        if (processError == QProcess::FailedToStart) {
+            m_segments[ix].running = false;
+            fail(tr("Cannot start %1").arg(m_prog));
+        }
+    });
+    const QStringList args = {QStringLiteral("-progress"), segment.playlist};
+    segment.process->start(m_prog, args);
+    m_logstream << "Started render process: " << m_prog << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+}
+
+void SegmentedRenderJob::segmentOutput(int ix)
+{
+    Segment &segment = m_segments[ix];
+    QString result = QString::fromLocal8Bit(segment.process->readAllStandardError()).simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        m_errorMessage.append(result + QStringLiteral("<br>"));
+        return;
+    }
+    int pro = result.section(QLatin1Char(' '), -1).toInt();
+    if (pro <= segment.progress || pro > 100) {
+        return;
+    }
+    segment.progress = pro;
+    updateProgress();
+}
+
+void SegmentedRenderJob::segmentFinished(int ix)
+{
+    Segment &segment = m_segments[ix];
+    segment.running = false;
+    if (segment.process->exitStatus() == QProcess::CrashExit || segment.process->exitCode() != 0) {
+        fail(tr("Rendering of segment %1 failed.").arg(ix + 1) + QStringLiteral("<br>") + m_errorMessage);
+        return;
+    }
+    m_logstream << "Segment " << segment.target << " finished" << "\n";
+    segment.progress = 100;
+    updateProgress();
+    startNextSegments();
+}
+
+void SegmentedRenderJob::startNextSegments()
+{
+    const int videoSegments = m_segments.count() - (m_hasAudio ? 1 : 0);
+    int running = 0;
+    bool finished = true;
+    for (int ix = 0; ix < m_segments.count(); ix++) {
+        const Segment &segment = m_segments.at(ix);
+        if (segment.running && ix < videoSegments) {
+            running++;
+        }
+        if (segment.process == nullptr || segment.running) {
+            finished = false;
+        }
+    }
+    if (finished) {
+        concatenate();
+        return;
+    }
+    for (int ix = 0; ix < videoSegments && running < m_maxProcesses; ix++) {
+        if (m_segments.at(ix).process == nullptr) {
+            startSegment(ix);
+            running++;
+        }
+    }
+}
+
+void SegmentedRenderJob::updateProgress()
+{
+    qint64 total = 0;
+    qint64 done = 0;
+    QStringList status;
+    for (const Segment &segment : m_segments) {
+        total += segment.frames;
+        done += qint64(segment.frames) * segment.progress / 100;
+        status << QString::number(segment.progress);
+    }
+    if ((m_kdenliveinterface != nullptr) && m_kdenliveinterface->isValid()) {
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingSegments"),
+                                                  {m_dest, status.join(QLatin1Char(','))});
+    }
+    // Keep the last percent for the concatenation
+    int progress = int(qMin(qint64(99), done * 100 / qMax(qint64(1), total)));
+    if (progress > m_progress) {
+        m_progress = progress;
+        sendProgress(int(done));
+    }
+}
+
+void SegmentedRenderJob::concatenate()
+{
+    m_segmentList = m_dest + QStringLiteral(".segments.txt");
+    QFile list(m_segmentList);
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fail(tr("Cannot write to file %1").arg(m_segmentList));
+        return;
+    }
+    QTextStream stream(&list);
+    const int videoSegments = m_segments.count() - (m_hasAudio ? 1 : 0);
+    for (int ix = 0; ix < videoSegments; ix++) {
+        QString path = m_segments.at(ix).target;
+        stream << "file '" << path.replace(QLatin1Char('\''), QLatin1String("'\\''")) << "'\n";
+    }
+    stream.flush();
+    list.close();
+
+    QStringList args = {QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-f"), QStringLiteral("concat"),
+                        QStringLiteral("-safe"), QStringLiteral("0"), QStringLiteral("-i"), m_segmentList};
+    if (m_hasAudio) {
+        args << QStringLiteral("-i") << m_segments.last().target << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map")
+             << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_concatProcess = new QProcess(this);
+    m_concatProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_concatProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &SegmentedRenderJob::concatFinished);
+    connect(m_concatProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError processError) {
+        if (processError == QProcess::FailedToStart) {
+            fail(tr("Cannot start %1").arg(m_ffmpeg));
+        }
+    });
+    m_concatProcess->start(m_ffmpeg, args);
+    m_logstream << "Started concat process: " << m_ffmpeg << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+}
+
+void SegmentedRenderJob::concatFinished()
+{
+    if (m_concatProcess->exitStatus() == QProcess::CrashExit || m_concatProcess->exitCode() != 0) {
+        fail(tr("Joining the segments failed.") + QStringLiteral("<br>") + QString::fromLocal8Bit(m_concatProcess->readAll()));
+        return;
+    }
+    m_progress = 100;
+    sendProgress(0);
+    sendFinished(-1, QString());
+    if (m_jobUiserver) {
+        m_jobUiserver->call(QStringLiteral("setDescriptionField"), (uint)1, tr("Rendered file"), m_dest);
+        m_jobUiserver->call(QStringLiteral("terminate"), QString());
+    }
+    m_logstream << "Rendering of " << m_dest << " finished" << "\n";
+    m_logstream.flush();
+    cleanup();
+    m_logfile.remove();
+    emit renderingFinished();
+}
+
+void SegmentedRenderJob::fail(const QString &error)
+{
+    for (Segment &segment : m_segments) {
+        if (segment.running) {
+            segment.process->disconnect(this);
+            segment.process->kill();
+            segment.running = false;
+        }
+    }
+    sendFinished(-2, error);
+    if (m_jobUiserver) {
+        m_jobUiserver->call(QStringLiteral("terminate"), QString());
+    }
+    QString message = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
+    m_logstream << message << "\n" << error << "\n";
+    m_logstream.flush();
+    QProcess::startDetached(QStringLiteral("kdialog"), {QStringLiteral("--error"), message});
+    cleanup();
+    emit renderingFinished();
+}
+
+void SegmentedRenderJob::slotAbort()
+{
+    for (Segment &segment : m_segments) {
+        if (segment.running) {
+            segment.process->disconnect(this);
+            segment.process->kill();
+            segment.process->waitForFinished();
+            segment.running = false;
+        }
+    }
+    if (m_concatProcess) {
+        m_concatProcess->disconnect(this);
+        m_concatProcess->kill();
+        m_concatProcess->waitForFinished();
+    }
+    cleanup();
+    RenderJob::slotAbort();
+}
+
+void SegmentedRenderJob::cleanup()
+{
+    for (const Segment &segment : m_segments) {
+        QFile::remove(segment.playlist.startsWith(QLatin1String("xml:")) ? segment.playlist.mid(4).section(QLatin1Char('?'), 0, -2) : segment.playlist);
+        QFile::remove(segment.target);
+    }
+    if (!m_segmentList.isEmpty()) {
+        QFile::remove(m_segmentList);
+    }
+    if (m_erase) {
+        QFile::remove(m_scenelist);
+    }
+}
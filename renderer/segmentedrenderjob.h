@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef SEGMENTEDRENDERJOB_H
+#define SEGMENTEDRENDERJOB_H
+
+#include "renderjob.h"
+
+#include <QVector>
+
+/** @class SegmentedRenderJob
+ *  @brief Renders the video in GOP aligned segments with concurrent melt processes.
+ *  The audio is rendered in a single pass next to the segments. Once everything is done,
+ *  the segments are concatenated and the audio muxed in with ffmpeg, without re-encoding.
+ */
+class SegmentedRenderJob : public RenderJob
+{
+    Q_OBJECT
+
+public:
+    SegmentedRenderJob(const QString &render, const QString &scenelist, const QString &target, int pid, int segments, const QString &ffmpeg,
+                       QObject *parent = nullptr);
+    ~SegmentedRenderJob() override;
+
+public slots:
+    void start() override;
+
+protected slots:
+    void slotAbort() override;
+
+private:
+    struct Segment
+    {
+        QString playlist;
+        QString target;
+        int frames{0};
+        int progress{0};
+        bool running{false};
+        QProcess *process{nullptr};
+    };
+    /** @brief The video segments, followed by the audio pass if there is one */
+    QVector<Segment> m_segments;
+    bool m_hasAudio;
+    int m_maxProcesses;
+    QString m_ffmpeg;
+    QProcess *m_concatProcess;
+    QString m_segmentList;
+
+    /** @brief Writes the playlist of each segment and of the audio pass */
+    bool prepareSegments(QString &error);
+    void startSegment(int ix);
+    void segmentOutput(int ix);
+    void segmentFinished(int ix);
+    /** @brief Starts the next waiting segments, or the concatenation once all are done */
+    void startNextSegments();
+    void concatenate();
+    void concatFinished();
+    /** @brief Sends the aggregated and per segment progress to Kdenlive */
+    void updateProgress();
+    void fail(const QString &error);
+    /** @brief Removes the intermediate files */
+    void cleanup();
+};
+
+#endif
@@ -41,6 +41,8 @@ KeyframeModel::KeyframeModel(std::weak_ptr<AssetParameterModel> model, const QMo
     , m_index(index)
     , m_lastData()
     , m_lock(QReadWriteLock::Recursive)
+    , m_animationLength(0)
+    , m_animationOpacity(false)
 {
     qDebug() << "Construct keyframemodel. Checking model:" << m_model.expired();
     if (auto ptr = m_model.lock()) {
@@ -917,40 +919,13 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
-    Mlt::Properties mlt_prop;
-    QString animData;
-    int in = 0;
-    int out = 0;
-    bool useOpacity = false;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(mlt_prop);
-        in = ptr->data(m_index, AssetParameterModel::ParentInRole).toInt();
-        out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
-        useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
-    }
-    if (m_paramType == ParamType::KeyframeParam) {
-        if (!animData.isEmpty()) {
-            mlt_prop.set("key", animData.toUtf8().constData());
-            // This is a fake query to force the animation to be parsed
-            (void)mlt_prop.anim_get_double("key", 0, out);
-            return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
-        }
-        return QVariant();
-    } else if (m_paramType == ParamType::AnimatedRect) {
-        if (!animData.isEmpty()) {
-            QLocale locale;
-            mlt_prop.set("key", animData.toUtf8().constData());
-            // This is a fake query to force the animation to be parsed
-            (void)mlt_prop.anim_get_double("key", 0, out);
-            mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
-            QString res = QStringLiteral("%1 %2 %3 %4").arg((int)rect.x).arg((int)rect.y).arg((int)rect.w).arg((int)rect.h);
-            if (useOpacity) {
-                res.append(QStringLiteral(" %1").arg(locale.toString(rect.o)));
-            }
-            return QVariant(res);
+    if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::AnimatedRect) {
+        QMutexLocker lock(&m_animationMutex);
+        Mlt::Properties *animation = compiledAnimation();
+        if (animation == nullptr) {
+            return QVariant();
         }
-        return QVariant();
+        return animationValue(*animation, pos.frames(pCore->getCurrentFps()));
     } else if (m_paramType == ParamType::Roto_spline) {
         // interpolate
         auto next = m_keyframeList.upper_bound(pos);
@@ -994,6 +969,84 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     return QVariant();
 }
 
+QVector<QVariant> KeyframeModel::getInterpolatedValues(int from, int to) const
+{
+    QVector<QVariant> values;
+    if (to < from) {
+        return values;
+    }
+    values.reserve(to - from + 1);
+    if (m_paramType != ParamType::KeyframeParam && m_paramType != ParamType::AnimatedRect) {
+        for (int frame = from; frame <= to; ++frame) {
+            values << getInterpolatedValue(frame);
+        }
+        return values;
+    }
+    QReadLocker locker(&m_lock);
+    QMutexLocker lock(&m_animationMutex);
+    Mlt::Properties *animation = m_keyframeList.empty() ? nullptr : compiledAnimation();
+    const double fps = pCore->getCurrentFps();
+    for (int frame = from; frame <= to; ++frame) {
+        auto kf = m_keyframeList.find(GenTime(frame, fps));
+        if (kf != m_keyframeList.end()) {
+            values << kf->second.second;
+        } else if (animation != nullptr) {
+            values << animationValue(*animation, frame);
+        } else {
+            values << QVariant();
+        }
+    }
+    return values;
+}
+
+Mlt::Properties *KeyframeModel::compiledAnimation() const
+{
+    int length = 0;
+    auto ptr = m_model.lock();
+    if (ptr) {
+        length = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
+    }
+    if (m_animation && length == m_animationLength) {
+        return m_animation.get();
+    }
+    m_animation.reset();
+    if (!ptr) {
+        return nullptr;
+    }
+    const QString animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    if (animData.isEmpty()) {
+        return nullptr;
+    }
+    m_animation.reset(new Mlt::Properties());
+    ptr->passProperties(*m_animation.get());
+    m_animation->set("key", animData.toUtf8().constData());
+    // This is a fake query to force the animation to be parsed, MLT then keeps it until the property changes
+    (void)m_animation->anim_get_double("key", 0, length);
+    m_animationLength = length;
+    m_animationOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+    return m_animation.get();
+}
+
+QVariant KeyframeModel::animationValue(Mlt::Properties &animation, int frame) const
+{
+    if (m_paramType == ParamType::AnimatedRect) {
+        QLocale locale;
+        mlt_rect rect = animation.anim_get_rect("key", frame);
+        QString res = QStringLiteral("%1 %2 %3 %4").arg((int)rect.x).arg((int)rect.y).arg((int)rect.w).arg((int)rect.h);
+        if (m_animationOpacity) {
+            res.append(QStringLiteral(" %1").arg(locale.toString(rect.o)));
+        }
+        return QVariant(res);
+    }
+    return QVariant(animation.anim_get_double("key", frame));
+}
+
+void KeyframeModel::invalidateAnimation()
+{
+    QMutexLocker lock(&m_animationMutex);
+    m_animation.reset();
+}
+
 void KeyframeModel::sendModification()
 {
     if (auto ptr = m_model.lock()) {
@@ -1001,6 +1054,7 @@ void KeyframeModel::sendModification()
         QString name = ptr->data(m_index, AssetParameterModel::NameRole).toString();
         if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::Roto_spline) {
             m_lastData = getAnimProperty();
+            invalidateAnimation();
             ptr->setParameter(name, m_lastData, false);
         } else {
             Q_ASSERT(false); // Not implemented, TODO
@@ -1011,6 +1065,7 @@ void KeyframeModel::sendModification()
 void KeyframeModel::refresh()
 {
     Q_ASSERT(m_index.isValid());
+    invalidateAnimation();
     QString animData;
     if (auto ptr = m_model.lock()) {
         animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
@@ -1045,6 +1100,7 @@ void KeyframeModel::refresh()
 void KeyframeModel::reset()
 {
     Q_ASSERT(m_index.isValid());
+    invalidateAnimation();
     QString animData;
     if (auto ptr = m_model.lock()) {
         animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
@@ -28,6 +28,7 @@
 #include "undohelper.hpp"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
 
 #include <map>
@@ -156,6 +157,8 @@ public:
     /* @brief Return the interpolated value at given pos */
     QVariant getInterpolatedValue(int pos) const;
     QVariant getInterpolatedValue(const GenTime &pos) const;
+    /* @brief Return the interpolated values for each frame in the range [from, to] */
+    QVector<QVariant> getInterpolatedValues(int from, int to) const;
     QVariant updateInterpolated(const QVariant &interpValue, double val);
     /* @brief Return the real value from a normalized one */
     QVariant getNormalizedValue(double newVal) const;
@@ -199,6 +202,14 @@ protected:
     void parseAnimProperty(const QString &prop);
     void parseRotoProperty(const QString &prop);
 
+    /* @brief Returns the MLT properties holding the parsed animation in their "key" property, or nullptr if the parameter has no value.
+       The animation is parsed on first use and kept until the parameter is modified. m_animationMutex must be locked by the caller */
+    Mlt::Properties *compiledAnimation() const;
+    /* @brief Evaluates the compiled animation at the given frame */
+    QVariant animationValue(Mlt::Properties &animation, int frame) const;
+    /* @brief Drops the compiled animation, it will be parsed again on next query */
+    void invalidateAnimation();
+
 private:
     std::weak_ptr<AssetParameterModel> m_model;
     std::weak_ptr<DocUndoStack> m_undoStack;
@@ -206,6 +217,10 @@ private:
     QString m_lastData;
     ParamType m_paramType;
     mutable QReadWriteLock m_lock; // This is a lock that ensures safety in case of concurrent access
+    mutable QMutex m_animationMutex;
+    mutable std::unique_ptr<Mlt::Properties> m_animation;
+    mutable int m_animationLength;
+    mutable bool m_animationOpacity;
 
     std::map<GenTime, std::pair<KeyframeType, QVariant>> m_keyframeList;
 
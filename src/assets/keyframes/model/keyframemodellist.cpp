@@ -321,6 +321,13 @@ QVariant KeyframeModelList::getInterpolatedValue(int pos, const QPersistentModel
     return m_parameters.at(index)->getInterpolatedValue(pos);
 }
 
+QVector<QVariant> KeyframeModelList::getInterpolatedValues(int from, int to, const QPersistentModelIndex &index) const
+{
+    READ_LOCK();
+    Q_ASSERT(m_parameters.count(index) > 0);
+    return m_parameters.at(index)->getInterpolatedValues(from, to);
+}
+
 KeyframeModel *KeyframeModelList::getKeyModel()
 {
     if (m_inTimelineIndex.isValid()) {
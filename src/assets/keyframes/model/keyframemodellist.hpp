@@ -126,6 +126,8 @@ public:
        @param pos is the position where we interpolate
        @param index is the index of the queried parameter. */
     QVariant getInterpolatedValue(int pos, const QPersistentModelIndex &index) const;
+    /* @brief Return the interpolated values of the given parameter for each frame in the range [from, to] */
+    QVector<QVariant> getInterpolatedValues(int from, int to, const QPersistentModelIndex &index) const;
 
     /* @brief Load keyframes from the current parameter value. */
     void refresh();
@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "assetchangebatcher.hpp"
+#include "assetparametermodel.hpp"
+#include "core.h"
+
+#include <QSize>
+#include <climits>
+#include <map>
+
+std::unique_ptr<AssetChangeBatcher> AssetChangeBatcher::instance;
+std::once_flag AssetChangeBatcher::m_onceFlag;
+
+AssetChangeBatcher::AssetChangeBatcher()
+    : QObject()
+    , m_stats({0, 0, 0, 0, 0})
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(FrameInterval);
+    connect(&m_timer, &QTimer::timeout, this, &AssetChangeBatcher::flush);
+}
+
+std::unique_ptr<AssetChangeBatcher> &AssetChangeBatcher::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new AssetChangeBatcher()); });
+    return instance;
+}
+
+void AssetChangeBatcher::assetChanged(const std::shared_ptr<AssetParameterModel> &asset, bool pending)
+{
+    m_stats.changes++;
+    if (pending) {
+        m_stats.coalesced++;
+        return;
+    }
+    m_assets.push_back(asset);
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void AssetChangeBatcher::flush()
+{
+    m_timer.stop();
+    if (m_assets.empty()) {
+        return;
+    }
+    m_stats.flushes++;
+    // Notifications might trigger new changes, they will be sent on the next frame
+    std::vector<std::weak_ptr<AssetParameterModel>> assets;
+    std::swap(assets, m_assets);
+    struct OwnerChanges
+    {
+        QStringList services;
+        bool refresh = false;
+        bool wholeItem = false;
+        int start = INT_MAX;
+        int end = -1;
+    };
+    std::map<ObjectId, OwnerChanges> owners;
+    for (const auto &weak : assets) {
+        std::shared_ptr<AssetParameterModel> asset = weak.lock();
+        if (!asset || !asset->flushChanges()) {
+            // Deleted, or only its view needed an update
+            continue;
+        }
+        OwnerChanges &changes = owners[asset->getOwnerId()];
+        if (!changes.services.contains(asset->getAssetId())) {
+            changes.services << asset->getAssetId();
+        }
+        if (asset->isAudio()) {
+            continue;
+        }
+        changes.refresh = true;
+        QSize range = asset->coveredRange();
+        if (!range.isValid()) {
+            changes.wholeItem = true;
+        } else {
+            changes.start = qMin(changes.start, range.width());
+            changes.end = qMax(changes.end, range.height());
+        }
+    }
+    for (const auto &owner : owners) {
+        for (const QString &service : owner.second.services) {
+            // Update fades in timeline
+            pCore->updateItemModel(owner.first, service);
+        }
+        if (!owner.second.refresh) {
+            continue;
+        }
+        // Trigger monitor refresh
+        pCore->refreshProjectItem(owner.first);
+        m_stats.monitorRefreshes++;
+        // Invalidate timeline preview
+        if (owner.second.wholeItem) {
+            pCore->invalidateItem(owner.first);
+            m_stats.invalidations++;
+        } else if (owner.second.end > owner.second.start) {
+            pCore->invalidateRange(QSize(owner.second.start, owner.second.end));
+            m_stats.invalidations++;
+        }
+    }
+}
+
+AssetChangeBatcher::Stats AssetChangeBatcher::stats() const
+{
+    return m_stats;
+}
+
+void AssetChangeBatcher::resetStats()
+{
+    m_stats = {0, 0, 0, 0, 0};
+}
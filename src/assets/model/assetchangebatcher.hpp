@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "definitions.h"
+#include <QObject>
+#include <QTimer>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AssetParameterModel;
+
+/** @brief This class delays the notifications caused by asset parameter changes until the next display frame.
+    Dragging a slider changes a parameter many times per frame. The values are applied immediately, but the view updates, monitor refreshes
+    and timeline preview invalidations are only sent once per frame and per owner, with the smallest changed row range for each asset and the
+    frame range actually covered by the changed effects.
+ * Note that this class is a Singleton
+ */
+class AssetChangeBatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Delay between a change and its notifications, in milliseconds */
+    static const int FrameInterval = 16;
+
+    /** @brief Usage counters, for diagnostics */
+    struct Stats
+    {
+        // Parameter changes received
+        quint64 changes;
+        // Changes merged in notifications that were already pending
+        quint64 coalesced;
+        // Number of batches sent
+        quint64 flushes;
+        quint64 monitorRefreshes;
+        quint64 invalidations;
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<AssetChangeBatcher> &get();
+
+    /** @brief Schedules the notifications of @param asset, whose pending changes are stored in the asset itself
+        @param pending is true if the asset already had changes waiting for the next frame
+    */
+    void assetChanged(const std::shared_ptr<AssetParameterModel> &asset, bool pending);
+
+    /** @brief Sends all pending notifications immediately */
+    void flush();
+
+    /** @brief Returns the counters, reset them with resetStats */
+    Stats stats() const;
+    void resetStats();
+
+protected:
+    AssetChangeBatcher();
+    static std::unique_ptr<AssetChangeBatcher> instance;
+    static std::once_flag m_onceFlag; // flag to create the repository only once;
+
+private:
+    QTimer m_timer;
+    // Assets with pending notifications, in the order of their first change
+    std::vector<std::weak_ptr<AssetParameterModel>> m_assets;
+    Stats m_stats;
+};
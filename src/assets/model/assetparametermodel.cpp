@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 #include "assetparametermodel.hpp"
+#include "assetchangebatcher.hpp"
 #include "assets/keyframes/model/keyframemodellist.hpp"
 #include "core.h"
 #include "kdenlivesettings.h"
@@ -40,6 +41,10 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
     , m_ownerId(ownerId)
     , m_asset(std::move(asset))
     , m_keyframes(nullptr)
+    , m_changedFirst(-1)
+    , m_changedLast(-1)
+    , m_changedModel(false)
+    , m_changedOwner(false)
 {
     Q_ASSERT(m_asset->is_valid());
     QDomNodeList nodeList = assetXml.elementsByTagName(QStringLiteral("parameter"));
@@ -186,16 +191,8 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
         emit replugEffect(shared_from_this());
     }
     if (update) {
-        emit modelChanged();
-        emit dataChanged(index(0, 0), index(m_rows.count() - 1, 0), {});
-        // Update fades in timeline
-        pCore->updateItemModel(m_ownerId, m_assetId);
-        if (!m_isAudio) {
-            // Trigger monitor refresh
-            pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
-        }
+        int row = m_rows.indexOf(name);
+        queueChange(row, row, true, true);
     }
 }
 
@@ -281,15 +278,12 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
         // these effects don't understand param change and need to be rebuild
         emit replugEffect(shared_from_this());
         updateChildRequired = false;
-    } else if (update) {
-        qDebug() << "// SENDING DATA CHANGE....";
-        if (paramIndex.isValid()) {
-            emit dataChanged(paramIndex, paramIndex);
-        } else {
-            QModelIndex ix = index(m_rows.indexOf(name), 0);
-            emit dataChanged(ix, ix);
-        }
-        emit modelChanged();
+    }
+    // Views are notified once per frame, see AssetChangeBatcher
+    bool notifyModel = update && updateChildRequired;
+    int row = -1;
+    if (notifyModel) {
+        row = paramIndex.isValid() ? paramIndex.row() : m_rows.indexOf(name);
     }
     if (updateChildRequired) {
         emit updateChildren(name);
@@ -297,17 +291,69 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
     // Update timeline view if necessary
     if (m_ownerId.first == ObjectType::NoItem) {
         // Used for generator clips
-        if (!update) emit modelChanged();
+        queueChange(row, row, notifyModel || !update, false);
     } else {
-        // Update fades in timeline
-        pCore->updateItemModel(m_ownerId, m_assetId);
-        if (!m_isAudio) {
-            // Trigger monitor refresh
-            pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
-        }
+        queueChange(row, row, notifyModel, true);
+    }
+}
+
+void AssetParameterModel::queueChange(int first, int last, bool notifyModel, bool refreshOwner)
+{
+    bool pending = m_changedFirst > -1 || m_changedModel || m_changedOwner;
+    if (first > -1) {
+        m_changedFirst = m_changedFirst == -1 ? first : qMin(m_changedFirst, first);
+        m_changedLast = qMax(m_changedLast, last);
+    }
+    m_changedModel = m_changedModel || notifyModel;
+    m_changedOwner = m_changedOwner || refreshOwner;
+    AssetChangeBatcher::get()->assetChanged(shared_from_this(), pending);
+}
+
+bool AssetParameterModel::flushChanges()
+{
+    // Reset the pending state before notifying, so that changes made by the receivers are queued for the next frame
+    int first = m_changedFirst;
+    int last = m_changedLast;
+    bool notifyModel = m_changedModel;
+    bool refreshOwner = m_changedOwner;
+    m_changedFirst = -1;
+    m_changedLast = -1;
+    m_changedModel = false;
+    m_changedOwner = false;
+    if (first > -1) {
+        emit dataChanged(index(first, 0), index(last, 0));
+    }
+    if (notifyModel) {
+        emit modelChanged();
     }
+    return refreshOwner;
+}
+
+bool AssetParameterModel::isAudio() const
+{
+    return m_isAudio;
+}
+
+QSize AssetParameterModel::coveredRange() const
+{
+    if (m_ownerId.first != ObjectType::TimelineClip) {
+        return {};
+    }
+    // Effects without in and out points apply to the whole clip
+    int in = m_asset->get_int("in");
+    int out = m_asset->get_int("out");
+    int duration = pCore->getItemDuration(m_ownerId);
+    if (out <= in || duration <= 0) {
+        return {};
+    }
+    int clipIn = pCore->getItemIn(m_ownerId);
+    int start = qMax(0, in - clipIn);
+    int end = qMin(duration, out - clipIn + 1);
+    if (start == 0 && end == duration) {
+        return {};
+    }
+    int position = pCore->getItemPosition(m_ownerId);
+    return {position + start, position + qMax(start, end)};
 }
 
 AssetParameterModel::~AssetParameterModel() = default;
@@ -854,7 +900,17 @@ void AssetParameterModel::setParameters(const QVector<QPair<QString, QVariant>>
     if (!update) {
         m_ownerId.first = itemId;
     }
-    emit dataChanged(index(0), index(m_rows.count()), {});
+    // Only notify the rows of the changed parameters
+    int first = -1;
+    int last = -1;
+    for (const auto &param : params) {
+        int row = m_rows.indexOf(param.first);
+        if (row > -1) {
+            first = first == -1 ? row : qMin(first, row);
+            last = qMax(last, row);
+        }
+    }
+    queueChange(first, last, false, false);
 }
 
 ObjectId AssetParameterModel::getOwnerId() const
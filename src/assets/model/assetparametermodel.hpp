@@ -171,6 +171,14 @@ public:
     void passProperties(Mlt::Properties &target);
     /* @brief Returns a list of the parameter names that are keyframable */
     QStringList getKeyframableParameters() const;
+    /* @brief Returns true if this is an audio asset, whose changes don't need monitor refresh or preview invalidation */
+    bool isAudio() const;
+    /* @brief Returns the timeline range (in as width, out as height) covered by this asset, invalid if it covers its whole owner */
+    QSize coveredRange() const;
+    /* @brief Sends the view notifications of the changes collected since the last display frame
+       Returns true if the owner of the asset must be refreshed
+     */
+    bool flushChanges();
 
 protected:
     /* @brief Helper function to retrieve the type of a parameter given the string corresponding to it*/
@@ -219,6 +227,17 @@ protected:
      */
     void internalSetParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex = QModelIndex());
 
+    /* @brief Collects a change to be notified on the next display frame by the AssetChangeBatcher
+       @param first and last are the changed rows, -1 if no row needs to be updated
+       @param notifyModel if true, modelChanged will be emitted
+       @param refreshOwner if true, the monitor will be refreshed and the owner's timeline preview invalidated
+     */
+    void queueChange(int first, int last, bool notifyModel, bool refreshOwner);
+    int m_changedFirst;
+    int m_changedLast;
+    bool m_changedModel;
+    bool m_changedOwner;
+
 signals:
     void modelChanged();
     /** @brief inform child effects (in case of bin effect with timeline producers)
@@ -153,17 +153,18 @@ void AudioLevelWidget::drawBackground(int channels)
 }
 
 // cppcheck-suppress unusedFunction
-void AudioLevelWidget::setAudioValues(const QVector<double> &values)
+void AudioLevelWidget::setAudioValues(const QVector<double> &values, const QVector<double> &peaks)
 {
     m_values = values;
+    const QVector<double> &newPeaks = peaks.size() == values.size() ? peaks : values;
     if (m_peaks.size() != m_values.size()) {
-        m_peaks = values;
+        m_peaks = newPeaks;
         drawBackground(values.size());
     } else {
         for (int i = 0; i < m_values.size(); i++) {
             m_peaks[i] -= .003;
-            if (m_values.at(i) > m_peaks.at(i)) {
-                m_peaks[i] = m_values.at(i);
+            if (newPeaks.at(i) > m_peaks.at(i)) {
+                m_peaks[i] = newPeaks.at(i);
             }
         }
     }
@@ -58,7 +58,8 @@ private:
     void drawBackground(int channels = 2);
 
 public slots:
-    void setAudioValues(const QVector<double> &values);
+    /** @brief Display the level of each channel, peak hold marks follow @param peaks if given, otherwise the levels */
+    void setAudioValues(const QVector<double> &values, const QVector<double> &peaks = QVector<double>());
 };
 
 #endif
@@ -71,6 +71,8 @@ MixerManager::MixerManager(QWidget *parent)
     m_channelsLayout->addStretch(10);
     m_box->addLayout(m_masterBox);
     setLayout(m_box);
+    m_levelsTimer.setInterval(40);
+    connect(&m_levelsTimer, &QTimer::timeout, this, &MixerManager::drainLevels);
 }
 
 void MixerManager::registerTrack(int tid, std::shared_ptr<Mlt::Tractor> service, const QString &trackTag)
@@ -198,6 +200,21 @@ void MixerManager::connectMixer(bool doConnect)
     if (m_masterMixer != nullptr) {
         m_masterMixer->connectMixer(m_visibleMixerManager);
     }
+    if (m_visibleMixerManager) {
+        m_levelsTimer.start();
+    } else {
+        m_levelsTimer.stop();
+    }
+}
+
+void MixerManager::drainLevels()
+{
+    for (const auto &item : m_mixers) {
+        item.second->drainLevels();
+    }
+    if (m_masterMixer != nullptr) {
+        m_masterMixer->drainLevels();
+    }
 }
 
 void MixerManager::collapseMixers()
@@ -26,6 +26,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include <QTimer>
 #include <QWidget>
 
 namespace Mlt {
@@ -59,6 +60,8 @@ public slots:
 
 private slots:
     void resetSizePolicy();
+    /** @brief Collect the audio levels measured since last call in all mixers */
+    void drainLevels();
 
 signals:
     void updateLevels(int);
@@ -84,6 +87,8 @@ private:
     int m_expandedWidth;
     QVector <int> m_soloMuted;
     int m_recommandedWidth;
+    /** @brief Single timer collecting the audio levels of all mixers */
+    QTimer m_levelsTimer;
 
 };
 
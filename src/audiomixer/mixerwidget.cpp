@@ -44,6 +44,8 @@
 #include <QMouseEvent>
 #include <QStyle>
 #include <QFontDatabase>
+#include <cmath>
+#include <limits>
 
 static inline double IEC_Scale(double dB)
 {
@@ -82,15 +84,31 @@ static inline int fromDB(double level)
 
 void MixerWidget::property_changed( mlt_service , MixerWidget *widget, char *name )
 {
+    // Called on the audio thread. The peak and loudness filters are attached before the monitor filter,
+    // so they already processed the frame
     if (widget && !strcmp(name, "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES( widget->m_monitorFilter->get_filter());
-        int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            widget->m_levels[pos] = {IEC_Scale(mlt_properties_get_double(filter_props, "_audio_level.0")), IEC_Scale(mlt_properties_get_double(filter_props, "_audio_level.1"))};
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
+        mlt_properties peak_props = widget->m_peakFilter ? MLT_FILTER_PROPERTIES(widget->m_peakFilter->get_filter()) : nullptr;
+        MeterFrame frame;
+        frame.position = mlt_properties_get_int(filter_props, "_position");
+        char key[20];
+        for (int i = 0; i < MeterFrame::MaxChannels; i++) {
+            snprintf(key, sizeof(key), "_audio_level.%d", i);
+            if (mlt_properties_get(filter_props, key) == nullptr) {
+                break;
             }
+            frame.rms[size_t(i)] = float(mlt_properties_get_double(filter_props, key));
+            frame.peak[size_t(i)] = peak_props ? float(mlt_properties_get_double(peak_props, key)) : frame.rms[size_t(i)];
+            frame.channels++;
         }
+        if (widget->m_loudnessFilter) {
+            mlt_properties loudness_props = MLT_FILTER_PROPERTIES(widget->m_loudnessFilter->get_filter());
+            frame.shortTerm = float(mlt_properties_get_double(loudness_props, "shortterm"));
+            frame.integrated = float(mlt_properties_get_double(loudness_props, "program"));
+        } else {
+            frame.shortTerm = frame.integrated = std::numeric_limits<float>::quiet_NaN();
+        }
+        widget->m_meterRing.push(frame);
     }
 }
 
@@ -107,6 +125,7 @@ MixerWidget::MixerWidget(int tid, std::shared_ptr<Mlt::Tractor> service, const Q
     , m_collapse(nullptr)
     , m_lastVolume(0)
     , m_listener(nullptr)
+    , m_loudnessLabel(nullptr)
     , m_recording(false)
 {
     buildUI(service.get(), trackTag);
@@ -125,6 +144,7 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, const QString &trackTag
     , m_collapse(nullptr)
     , m_lastVolume(0)
     , m_listener(nullptr)
+    , m_loudnessLabel(nullptr)
     , m_recording(false)
 {
     buildUI(service, trackTag);
@@ -178,8 +198,16 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
         }
         const QString filterService = fl->get("mlt_service");
         if (filterService == QLatin1String("audiolevel")) {
-            m_monitorFilter = fl;
-            m_monitorFilter->set("disable", 0);
+            if (fl->get_int("dbpeak") == 1) {
+                m_peakFilter = fl;
+                m_peakFilter->set("disable", 0);
+            } else {
+                m_monitorFilter = fl;
+                m_monitorFilter->set("disable", 0);
+            }
+        } else if (filterService == QLatin1String("loudness_meter")) {
+            m_loudnessFilter = fl;
+            m_loudnessFilter->set("disable", 0);
         } else if (filterService == QLatin1String("volume")) {
             m_levelFilter = fl;
             int volume = m_levelFilter->get_int("level");
@@ -211,6 +239,38 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
         }
     }
     // Monitoring should be appended last so that other effects are reflected in audio monitor
+    bool meterAdded = false;
+    if (m_loudnessFilter == nullptr) {
+        m_loudnessFilter.reset(new Mlt::Filter(service->get_profile(), "loudness_meter"));
+        if (m_loudnessFilter->is_valid()) {
+            m_loudnessFilter->set("calc_program", 1);
+            m_loudnessFilter->set("calc_shortterm", 1);
+            m_loudnessFilter->set("calc_momentary", 0);
+            m_loudnessFilter->set("calc_range", 0);
+            m_loudnessFilter->set("calc_peak", 0);
+            m_loudnessFilter->set("calc_true_peak", 0);
+            service->attach(*m_loudnessFilter.get());
+            meterAdded = true;
+        } else {
+            m_loudnessFilter.reset();
+        }
+    }
+    if (m_peakFilter == nullptr) {
+        m_peakFilter.reset(new Mlt::Filter(service->get_profile(), "audiolevel"));
+        if (m_peakFilter->is_valid()) {
+            m_peakFilter->set("iec_scale", 0);
+            m_peakFilter->set("dbpeak", 1);
+            service->attach(*m_peakFilter.get());
+            meterAdded = true;
+        } else {
+            m_peakFilter.reset();
+        }
+    }
+    if (m_monitorFilter != nullptr && meterAdded) {
+        // The monitor filter reads the other meters, it has to come after them
+        service->detach(*m_monitorFilter.get());
+        service->attach(*m_monitorFilter.get());
+    }
     if (m_monitorFilter == nullptr) {
         m_monitorFilter.reset(new Mlt::Filter(service->get_profile(), "audiolevel"));
         if (m_monitorFilter->is_valid()) {
@@ -349,6 +409,12 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
     lay->addLayout(hlay);
     lay->addWidget(m_volumeSpin);
     lay->setStretch(4, 10);
+    if (m_loudnessFilter) {
+        m_loudnessLabel = new QLabel(this);
+        m_loudnessLabel->setAlignment(Qt::AlignHCenter);
+        m_loudnessLabel->setText(i18n("- LUFS"));
+        lay->addWidget(m_loudnessLabel);
+    }
     setLayout(lay);
     if (service->get_int("hide") > 1) {
         setMute(true);
@@ -400,29 +466,67 @@ void MixerWidget::updateLabel()
     }
 }
 
+void MixerWidget::drainLevels()
+{
+    MeterFrame frame;
+    while (m_meterRing.pop(frame)) {
+        if (!m_levels.contains(frame.position)) {
+            m_levels.insert(frame.position, frame);
+            if (m_levels.size() > m_maxLevels) {
+                m_levels.erase(m_levels.begin());
+            }
+        }
+    }
+}
+
 void MixerWidget::updateAudioLevel(int pos)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues({m_levels.value(pos).first, m_levels.value(pos).second});
-        //m_levels.remove(pos);
+    drainLevels();
+    auto frame = m_levels.constFind(pos);
+    if (frame != m_levels.constEnd()) {
+        showLevels(frame.value());
     } else {
         m_audioMeterWidget->setAudioValues({-100, -100});
     }
 }
 
+void MixerWidget::showLevels(const MeterFrame &frame)
+{
+    if (frame.channels == 0) {
+        m_audioMeterWidget->setAudioValues({-100, -100});
+    } else {
+        QVector<double> values(frame.channels);
+        QVector<double> peaks(frame.channels);
+        for (int i = 0; i < frame.channels; i++) {
+            values[i] = IEC_Scale(frame.rms[size_t(i)]);
+            peaks[i] = IEC_Scale(frame.peak[size_t(i)]);
+        }
+        m_audioMeterWidget->setAudioValues(values, peaks);
+    }
+    if (m_loudnessLabel) {
+        // Silence is reported as -inf
+        auto lufs = [](float value) {
+            return std::isfinite(value) && value > -70 ? QString::number(double(value), 'f', 1) : QStringLiteral("-");
+        };
+        m_loudnessLabel->setText(i18n("%1 LUFS", lufs(frame.shortTerm)));
+        m_loudnessLabel->setToolTip(i18n("Short-term loudness: %1 LUFS\nIntegrated loudness: %2 LUFS", lufs(frame.shortTerm), lufs(frame.integrated)));
+    }
+}
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    clear();
     m_audioMeterWidget->setAudioValues({-100, -100});
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
+    m_meterRing.clear();
     m_levels.clear();
+    if (m_loudnessFilter) {
+        // Restart the integrated loudness measurement
+        m_loudnessFilter->set("reset", 1);
+    }
 }
 
 
@@ -495,7 +599,10 @@ void MixerWidget::connectMixer(bool doConnect)
 
 void MixerWidget::pauseMonitoring(bool pause)
 {
-    if (m_monitorFilter) {
-        m_monitorFilter->set("disable", pause ? 1 : 0);
+    // Meters must not end up enabled in the saved scene
+    for (const auto &filter : {m_monitorFilter, m_peakFilter, m_loudnessFilter}) {
+        if (filter) {
+            filter->set("disable", pause ? 1 : 0);
+        }
     }
 }
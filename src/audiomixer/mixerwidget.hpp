@@ -24,11 +24,13 @@
 
 #include "definitions.h"
 #include "mlt++/MltService.h"
+#include "utils/spscring.hpp"
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 #include <QWidget>
-#include <QMutex>
+#include <QMap>
 
 class KDualAction;
 class AudioLevelWidget;
@@ -45,6 +47,20 @@ namespace Mlt {
     class Event;
 }
 
+/** @brief The audio levels of a frame, as measured on the audio thread */
+struct MeterFrame
+{
+    static constexpr int MaxChannels = 8;
+    int position = -1;
+    int channels = 0;
+    /** @brief Linear peak and RMS levels of each channel */
+    std::array<float, MaxChannels> peak;
+    std::array<float, MaxChannels> rms;
+    /** @brief EBU R128 loudness in LUFS, NaN if not measured */
+    float shortTerm;
+    float integrated;
+};
+
 class MixerWidget : public QWidget
 {
     Q_OBJECT
@@ -70,6 +86,8 @@ public:
     void connectMixer(bool doConnect);
     /** @brief Disable/enable monitoring by disabling/enabling filter */
     void pauseMonitoring(bool pause);
+    /** @brief Move the levels measured on the audio thread to the displayable levels */
+    void drainLevels();
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -87,7 +105,13 @@ protected:
     std::shared_ptr<Mlt::Filter> m_levelFilter;
     std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QPair<double, double>> m_levels;
+    /** @brief Measures the peak levels, m_monitorFilter measures the RMS levels */
+    std::shared_ptr<Mlt::Filter> m_peakFilter;
+    std::shared_ptr<Mlt::Filter> m_loudnessFilter;
+    /** @brief Levels measured on the audio thread, waiting for the GUI thread */
+    SpscRing<MeterFrame, 256> m_meterRing;
+    /** @brief Levels by frame position, only accessed from the GUI thread */
+    QMap<int, MeterFrame> m_levels;
     KDualAction *m_muteAction;
     QSpinBox *m_balanceSpin;
     QDial *m_balanceDial;
@@ -101,12 +125,13 @@ private:
     QToolButton *m_record;
     QToolButton *m_collapse;
     QLabel *m_trackLabel;
-    QMutex m_storeMutex;
+    QLabel *m_loudnessLabel;
     int m_lastVolume;
     Mlt::Event *m_listener;
     bool m_recording;
     /** @Update track label to reflect state */
     void updateLabel();
+    void showLevels(const MeterFrame &frame);
 
 signals:
     void gotLevels(QPair <double, double>);
@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "producerpool.h"
+#include "kdenlive_debug.h"
+
+#include <QMutexLocker>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltFilter.h>
+#include <vector>
+
+ProducerPool::ProducerPool(int maxIdle)
+    : m_maxIdle(maxIdle)
+{
+}
+
+ProducerPool::~ProducerPool()
+{
+    qCDebug(KDENLIVE_LOG) << "Producer pool:" << m_stats.hits << "hits," << m_stats.misses << "misses," << m_stats.recycled << "recycled,"
+                          << m_stats.discarded << "discarded," << m_stats.evicted << "evicted," << m_stats.checkedOut << "still checked out";
+}
+
+std::shared_ptr<ProducerPool> &ProducerPool::get()
+{
+    static std::shared_ptr<ProducerPool> instance = std::make_shared<ProducerPool>();
+    return instance;
+}
+
+std::shared_ptr<Mlt::Producer> ProducerPool::checkout(const QString &clipId, int variant, const std::function<Mlt::Producer *()> &create)
+{
+    QMutexLocker lock(&m_mutex);
+    const int generation = m_generations.value(clipId);
+    for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+        if (it->clipId == clipId && it->variant == variant && it->generation == generation) {
+            Idle entry = std::move(*it);
+            m_idle.erase(it);
+            m_stats.hits++;
+            m_stats.idle = int(m_idle.size());
+            lock.unlock();
+            // The previous user left it anywhere in the clip
+            entry.producer->seek(0);
+            return wrap(std::move(entry));
+        }
+    }
+    m_stats.misses++;
+    lock.unlock();
+
+    // Opening the producer is the slow part, don't block the other clips meanwhile
+    Idle entry{clipId, variant, generation, std::unique_ptr<Mlt::Producer>(create()), std::make_shared<Mlt::Properties>(), 0};
+    if (!entry.producer || !entry.producer->is_valid()) {
+        return std::shared_ptr<Mlt::Producer>(entry.producer.release());
+    }
+    entry.state->inherit(*entry.producer);
+    entry.filters = entry.producer->filter_count();
+    return wrap(std::move(entry));
+}
+
+std::shared_ptr<Mlt::Producer> ProducerPool::wrap(Idle entry)
+{
+    std::weak_ptr<ProducerPool> pool = shared_from_this();
+    const QString clipId = entry.clipId;
+    const int variant = entry.variant;
+    const int generation = entry.generation;
+    std::shared_ptr<Mlt::Properties> state = entry.state;
+    const int filters = entry.filters;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stats.checkedOut++;
+    }
+    return std::shared_ptr<Mlt::Producer>(entry.producer.release(), [pool, clipId, variant, generation, state, filters](Mlt::Producer *producer) {
+        if (auto ptr = pool.lock()) {
+            ptr->checkin(Idle{clipId, variant, generation, std::unique_ptr<Mlt::Producer>(producer), state, filters});
+        } else {
+            delete producer;
+        }
+    });
+}
+
+void ProducerPool::checkin(Idle entry)
+{
+    QMutexLocker lock(&m_mutex);
+    m_stats.checkedOut--;
+    if (entry.generation != m_generations.value(entry.clipId) || !reset(entry)) {
+        m_stats.discarded++;
+        lock.unlock();
+        entry.producer.reset();
+        return;
+    }
+    m_stats.recycled++;
+    m_idle.push_front(std::move(entry));
+    std::list<Idle> evicted = trim();
+    lock.unlock();
+    evicted.clear();
+}
+
+std::list<ProducerPool::Idle> ProducerPool::trim()
+{
+    std::list<Idle> evicted;
+    while (int(m_idle.size()) > m_maxIdle) {
+        evicted.splice(evicted.end(), m_idle, std::prev(m_idle.end()));
+        m_stats.evicted++;
+    }
+    m_stats.idle = int(m_idle.size());
+    return evicted;
+}
+
+bool ProducerPool::reset(Idle &entry)
+{
+    Mlt::Producer *producer = entry.producer.get();
+    if (producer->ref_count() > 1) {
+        // Still used in an MLT playlist or as the parent of cuts
+        return false;
+    }
+    int count = producer->filter_count();
+    if (count < entry.filters) {
+        return false;
+    }
+    // Remove the filters added while checked out
+    while (count > entry.filters) {
+        std::unique_ptr<Mlt::Filter> filter(producer->filter(--count));
+        if (!filter || producer->detach(*filter) != 0) {
+            return false;
+        }
+    }
+    // Drop the properties that were added, the others get their original value back
+    std::vector<QByteArray> added;
+    for (int i = 0; i < producer->count(); ++i) {
+        const char *name = producer->get_name(i);
+        if (name && name[0] != '_' && producer->get(i) != nullptr && entry.state->get(name) == nullptr) {
+            added.emplace_back(name);
+        }
+    }
+    for (const QByteArray &name : added) {
+        producer->set(name.constData(), (char *)nullptr);
+    }
+    producer->inherit(*entry.state);
+    return true;
+}
+
+void ProducerPool::invalidate(const QString &clipId)
+{
+    // Declared before the lock so that producers are closed once it is released
+    std::list<Idle> outdated;
+    QMutexLocker lock(&m_mutex);
+    m_generations[clipId]++;
+    for (auto it = m_idle.begin(); it != m_idle.end();) {
+        auto current = it++;
+        if (current->clipId == clipId) {
+            outdated.splice(outdated.end(), m_idle, current);
+        }
+    }
+    m_stats.idle = int(m_idle.size());
+}
+
+void ProducerPool::clear()
+{
+    std::list<Idle> idle;
+    QMutexLocker lock(&m_mutex);
+    idle.swap(m_idle);
+    m_stats.idle = 0;
+}
+
+void ProducerPool::setMaxIdle(int maxIdle)
+{
+    std::list<Idle> evicted;
+    QMutexLocker lock(&m_mutex);
+    m_maxIdle = qMax(0, maxIdle);
+    evicted = trim();
+}
+
+ProducerPool::Stats ProducerPool::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef PRODUCERPOOL_H
+#define PRODUCERPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <functional>
+#include <list>
+#include <memory>
+
+namespace Mlt {
+class Producer;
+class Properties;
+} // namespace Mlt
+
+/** @class ProducerPool
+    @brief Keeps opened clones of the bin clip producers so that they can be reused.
+    Cloning a producer means serializing it and opening its file again, which is slow for
+    avformat producers. Producers are checked out from the pool and return to it when the last
+    reference to them is released, their properties and filters reset to the state they had when
+    created. Idle producers are closed in least recently used order above a given count.
+    Checked out producers are not capped: each one is used by a timeline clip or a job, which
+    cannot wait for another to be released. Their count is reported in the stats.
+    The pool must be owned by a shared_ptr, released producers only return to a living pool.
+ */
+class ProducerPool : public std::enable_shared_from_this<ProducerPool>
+{
+public:
+    struct Stats
+    {
+        /** @brief Checkouts served by an idle producer */
+        int hits = 0;
+        /** @brief Checkouts that had to create a producer */
+        int misses = 0;
+        /** @brief Producers that went back to the pool */
+        int recycled = 0;
+        /** @brief Released producers that could not be reused (outdated, or still used by MLT) */
+        int discarded = 0;
+        /** @brief Idle producers closed to stay under the pool size */
+        int evicted = 0;
+        /** @brief Current count of idle producers */
+        int idle = 0;
+        /** @brief Current count of checked out producers */
+        int checkedOut = 0;
+    };
+
+    explicit ProducerPool(int maxIdle = 16);
+    ~ProducerPool();
+
+    /** @brief Returns the pool shared by the bin clips */
+    static std::shared_ptr<ProducerPool> &get();
+
+    /** @brief Returns an opened producer for the clip @param clipId, calling @param create if none is idle.
+        A reused producer is seeked back to its first frame.
+        @param variant distinguishes different kind of clones of the same clip */
+    std::shared_ptr<Mlt::Producer> checkout(const QString &clipId, int variant, const std::function<Mlt::Producer *()> &create);
+    /** @brief The clip producer changed: close its idle producers, and don't reuse the checked out ones */
+    void invalidate(const QString &clipId);
+    /** @brief Close all idle producers */
+    void clear();
+    /** @brief Set the maximum count of idle producers */
+    void setMaxIdle(int maxIdle);
+    /** @brief Returns the reuse counters of the pool */
+    Stats stats() const;
+
+private:
+    struct Idle
+    {
+        QString clipId;
+        int variant;
+        int generation;
+        std::unique_ptr<Mlt::Producer> producer;
+        /** @brief The properties of the producer when it was created */
+        std::shared_ptr<Mlt::Properties> state;
+        int filters;
+    };
+    mutable QMutex m_mutex;
+    /** @brief Idle producers, most recently used first */
+    std::list<Idle> m_idle;
+    /** @brief Incremented on each invalidation of a clip */
+    QHash<QString, int> m_generations;
+    int m_maxIdle;
+    Stats m_stats;
+
+    std::shared_ptr<Mlt::Producer> wrap(Idle entry);
+    void checkin(Idle entry);
+    /** @brief Remove the idle producers above the pool size, returning them so that they are closed outside the lock */
+    std::list<Idle> trim();
+    /** @brief Restore the state of a released producer, returns false if it cannot be reused */
+    static bool reset(Idle &entry);
+};
+
+#endif
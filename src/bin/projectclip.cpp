@@ -33,10 +33,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "jobs/thumbjob.hpp"
 #include "jobs/cachejob.hpp"
 #include "kdenlivesettings.h"
+#include "lib/audio/audioPeaks.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/clippropertiescontroller.h"
 #include "model/markerlistmodel.hpp"
+#include "producerpool.h"
 #include "profiles/profilemodel.hpp"
 #include "project/projectcommands.h"
 #include "project/projectmanager.h"
@@ -46,7 +48,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "timecode.h"
 #include "timeline2/model/snapmodel.hpp"
 
+#include "utils/filehashindex.hpp"
 #include "utils/thumbnailcache.hpp"
+#include "utils/waveformtilecache.hpp"
 #include "xml/xml.hpp"
 #include <QPainter>
 #include <jobs/proxyclipjob.h>
@@ -174,6 +178,8 @@ ProjectClip::~ProjectClip()
 void ProjectClip::connectEffectStack()
 {
     connect(m_effectStack.get(), &EffectStackModel::dataChanged, [&]() {
+        // Pooled clones carry the clip effects
+        ProducerPool::get()->invalidate(m_binId);
         if (auto ptr = m_model.lock()) {
             std::static_pointer_cast<ProjectItemModel>(ptr)->onItemUpdated(std::static_pointer_cast<ProjectClip>(shared_from_this()),
                                                                            AbstractProjectItem::IconOverlay);
@@ -208,6 +214,12 @@ void ProjectClip::updateAudioThumbnail()
         return;
     }
     m_audioThumbCreated = true;
+    {
+        // Peak files were rewritten, map them again on next access
+        QMutexLocker lk(&m_audioPeaksMutex);
+        m_audioPeaks.clear();
+    }
+    WaveformTileCache::get()->invalidateClip(hash());
     audioThumbReady();
     updateTimelineClips({TimelineModel::ReloadThumbRole});
 }
@@ -530,36 +542,44 @@ std::shared_ptr<Mlt::Producer> ProjectClip::thumbProducer()
         return nullptr;
     }
     QMutexLocker lock(&m_thumbMutex);
+    m_thumbsProducer = createThumbProducer();
+    return m_thumbsProducer;
+}
+
+std::shared_ptr<Mlt::Producer> ProjectClip::createThumbProducer()
+{
+    if (clipType() == ClipType::Unknown) {
+        return nullptr;
+    }
     std::shared_ptr<Mlt::Producer> prod = originalProducer();
     if (!prod->is_valid()) {
         return nullptr;
     }
     if (KdenliveSettings::gpu_accel()) {
         // TODO: when the original producer changes, we must reload this thumb producer
-        m_thumbsProducer = softClone(ClipController::getPassPropertiesList());
-    } else {
-        QString mltService = m_masterProducer->get("mlt_service");
-        const QString mltResource = m_masterProducer->get("resource");
-        if (mltService == QLatin1String("avformat")) {
-            mltService = QStringLiteral("avformat-novalidate");
-        }
-        m_thumbsProducer.reset(new Mlt::Producer(*pCore->thumbProfile(), mltService.toUtf8().constData(), mltResource.toUtf8().constData()));
-        if (m_thumbsProducer->is_valid()) {
-            Mlt::Properties original(m_masterProducer->get_properties());
-            Mlt::Properties cloneProps(m_thumbsProducer->get_properties());
-            cloneProps.pass_list(original, ClipController::getPassPropertiesList());
-            Mlt::Filter scaler(*pCore->thumbProfile(), "swscale");
-            Mlt::Filter padder(*pCore->thumbProfile(), "resize");
-            Mlt::Filter converter(*pCore->thumbProfile(), "avcolor_space");
-            m_thumbsProducer->set("audio_index", -1);
-            // Required to make get_playtime() return > 1
-            m_thumbsProducer->set("out", m_thumbsProducer->get_length() -1);
-            m_thumbsProducer->attach(scaler);
-            m_thumbsProducer->attach(padder);
-            m_thumbsProducer->attach(converter);
-        }
+        return softClone(ClipController::getPassPropertiesList());
     }
-    return m_thumbsProducer;
+    QString mltService = m_masterProducer->get("mlt_service");
+    const QString mltResource = m_masterProducer->get("resource");
+    if (mltService == QLatin1String("avformat")) {
+        mltService = QStringLiteral("avformat-novalidate");
+    }
+    std::shared_ptr<Mlt::Producer> thumbProd(new Mlt::Producer(*pCore->thumbProfile(), mltService.toUtf8().constData(), mltResource.toUtf8().constData()));
+    if (thumbProd->is_valid()) {
+        Mlt::Properties original(m_masterProducer->get_properties());
+        Mlt::Properties cloneProps(thumbProd->get_properties());
+        cloneProps.pass_list(original, ClipController::getPassPropertiesList());
+        Mlt::Filter scaler(*pCore->thumbProfile(), "swscale");
+        Mlt::Filter padder(*pCore->thumbProfile(), "resize");
+        Mlt::Filter converter(*pCore->thumbProfile(), "avcolor_space");
+        thumbProd->set("audio_index", -1);
+        // Required to make get_playtime() return > 1
+        thumbProd->set("out", thumbProd->get_length() -1);
+        thumbProd->attach(scaler);
+        thumbProd->attach(padder);
+        thumbProd->attach(converter);
+    }
+    return thumbProd;
 }
 
 void ProjectClip::createDisabledMasterProducer()
@@ -761,6 +781,11 @@ std::pair<std::shared_ptr<Mlt::Producer>, bool> ProjectClip::giveMasterAndGetTim
 }
 
 std::shared_ptr<Mlt::Producer> ProjectClip::cloneProducer(bool removeEffects)
+{
+    return ProducerPool::get()->checkout(m_binId, removeEffects ? 1 : 0, [this, removeEffects]() { return createClone(removeEffects); });
+}
+
+Mlt::Producer *ProjectClip::createClone(bool removeEffects)
 {
     Mlt::Consumer c(pCore->getCurrentProfile()->profile(), "xml", "string");
     Mlt::Service s(m_masterProducer->get_service());
@@ -780,8 +805,7 @@ std::shared_ptr<Mlt::Producer> ProjectClip::cloneProducer(bool removeEffects)
         s.set("ignore_points", ignore);
     }
     const QByteArray clipXml = c.get("string");
-    std::shared_ptr<Mlt::Producer> prod;
-    prod.reset(new Mlt::Producer(pCore->getCurrentProfile()->profile(), "xml-string", clipXml.constData()));
+    auto *prod = new Mlt::Producer(pCore->getCurrentProfile()->profile(), "xml-string", clipXml.constData());
 
     if (strcmp(prod->get("mlt_service"), "avformat") == 0) {
         prod->set("mlt_service", "avformat-novalidate");
@@ -921,26 +945,19 @@ const QString ProjectClip::getFileHash()
         fileData = getProducerProperty(QStringLiteral("resource")).toUtf8();
         fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
-    default:
-        QFile file(clipUrl());
-        if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
-            /*
-             * 1 MB = 1 second per 450 files (or faster)
-             * 10 MB = 9 seconds per 450 files (or faster)
-             */
-            if (file.size() > 2000000) {
-                fileData = file.read(1000000);
-                if (file.seek(file.size() - 1000000)) {
-                    fileData.append(file.readAll());
-                }
-            } else {
-                fileData = file.readAll();
-            }
-            file.close();
-            ClipController::setProducerProperty(QStringLiteral("kdenlive:file_size"), QString::number(file.size()));
-            fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
+    default: {
+        // Keep the format of the hash the clip was created with
+        const QString previousHash = getProducerProperty(QStringLiteral("kdenlive:file_hash"));
+        const QString result = FileHashIndex::get()->fileHash(clipUrl(), FileHashIndex::algorithmFor(previousHash));
+        if (result.isEmpty()) {
+            qDebug() << "// WARNING EMPTY CLIP HASH: ";
+            return QString();
         }
-        break;
+        // write size and hash only if resource points to a file
+        ClipController::setProducerProperty(QStringLiteral("kdenlive:file_size"), QString::number(QFileInfo(clipUrl()).size()));
+        ClipController::setProducerProperty(QStringLiteral("kdenlive:file_hash"), result);
+        return result;
+    }
     }
     if (fileHash.isEmpty()) {
         qDebug() << "// WARNING EMPTY CLIP HASH: ";
@@ -1266,6 +1283,15 @@ void ProjectClip::discardAudioThumb()
     if (!audioThumbPath.isEmpty()) {
         QFile::remove(audioThumbPath);
     }
+    QString audioPeakPath = getAudioPeakPath(audioInfo()->ffmpeg_audio_index());
+    if (!audioPeakPath.isEmpty()) {
+        QFile::remove(audioPeakPath);
+    }
+    {
+        QMutexLocker lk(&m_audioPeaksMutex);
+        m_audioPeaks.clear();
+    }
+    WaveformTileCache::get()->invalidateClip(hash());
     qCDebug(KDENLIVE_LOG) << "////////////////////  DISCARD AUDIO THUMBS";
     m_audioThumbCreated = false;
     refreshAudioInfo();
@@ -1309,6 +1335,16 @@ const QString ProjectClip::getAudioThumbPath(int stream, bool miniThumb)
     return audioPath;
 }
 
+const QString ProjectClip::getAudioPeakPath(int stream)
+{
+    QString audioPath = getAudioThumbPath(stream);
+    if (audioPath.isEmpty()) {
+        return QString();
+    }
+    audioPath.replace(audioPath.length() - 4, 4, QStringLiteral(".peaks"));
+    return audioPath;
+}
+
 QStringList ProjectClip::updatedAnalysisData(const QString &name, const QString &data, int offset)
 {
     if (data.isEmpty()) {
@@ -1537,32 +1573,37 @@ void ProjectClip::setRating(uint rating)
     pCore->currentDoc()->setModified(true);
 }
 
-QVector <uint8_t> ProjectClip::audioFrameCache(int stream)
+std::shared_ptr<const AudioPeakFile> ProjectClip::audioPeaks(int stream)
 {
-    QVector <uint8_t> audioLevels;
     if (stream == -1) {
         if (m_audioInfo) {
             stream = m_audioInfo->ffmpeg_audio_index();
         } else {
-            return audioLevels;
+            return nullptr;
         }
     }
-    // convert cached image
-    const QString cachePath = getAudioThumbPath(stream);
-    // checking for cached thumbs
-    QImage image(cachePath);
-    if (!image.isNull()) {
-        int channels = m_audioInfo->channels();
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p = image.pixel(i / channels, i % channels);
-            audioLevels << (uint8_t)qRed(p);
-            audioLevels << (uint8_t)qGreen(p);
-            audioLevels << (uint8_t)qBlue(p);
-            audioLevels << (uint8_t)qAlpha(p);
+    QMutexLocker lk(&m_audioPeaksMutex);
+    auto it = m_audioPeaks.find(stream);
+    if (it != m_audioPeaks.end()) {
+        return it->second;
+    }
+    const QString peakPath = getAudioPeakPath(stream);
+    if (peakPath.isEmpty()) {
+        return nullptr;
+    }
+    if (!QFile::exists(peakPath)) {
+        // Convert the cache created by previous versions
+        const QString legacyPath = getAudioThumbPath(stream);
+        if (!QFile::exists(legacyPath) || !AudioPeakFile::convertLegacyImage(legacyPath, m_audioInfo->channels(), peakPath)) {
+            return nullptr;
         }
+        QFile::remove(legacyPath);
+    }
+    std::shared_ptr<const AudioPeakFile> peaks = AudioPeakFile::open(peakPath);
+    if (peaks) {
+        m_audioPeaks[stream] = peaks;
     }
-    return audioLevels;
+    return peaks;
 }
 
 void ProjectClip::setClipStatus(AbstractProjectItem::CLIPSTATUS status)
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMutex>
 #include <memory>
 
+class AudioPeakFile;
 class ClipPropertiesController;
 class ProjectFolder;
 class ProjectSubClip;
@@ -151,6 +152,8 @@ public:
 
     /** @brief Returns this clip's producer. */
     std::shared_ptr<Mlt::Producer> thumbProducer() override;
+    /** @brief Creates a new producer suitable for thumbnail extraction, independent from the one returned by thumbProducer() */
+    std::shared_ptr<Mlt::Producer> createThumbProducer();
 
     /** @brief Recursively disable/enable bin effects. */
     void setBinEffectsEnabled(bool enabled) override;
@@ -188,6 +191,8 @@ public:
     void discardAudioThumb();
     /** @brief Get path for this clip's audio thumbnail */
     const QString getAudioThumbPath(int stream, bool miniThumb = false);
+    /** @brief Get path for this clip's audio peak file */
+    const QString getAudioPeakPath(int stream);
     /** @brief Returns true if this producer has audio and can be splitted on timeline*/
     bool isSplittable() const;
 
@@ -210,6 +215,8 @@ public:
     */
     std::pair<std::shared_ptr<Mlt::Producer>, bool> giveMasterAndGetTimelineProducer(int clipId, std::shared_ptr<Mlt::Producer> master, PlaylistState::ClipState state, int tid);
 
+    /** @brief Returns a copy of the master producer, with its own demuxer and decoder.
+        Copies come from the producer pool and return to it once released, so that their file is not reopened each time */
     std::shared_ptr<Mlt::Producer> cloneProducer(bool removeEffects = false);
     static std::shared_ptr<Mlt::Producer> cloneProducer(const std::shared_ptr<Mlt::Producer> &producer);
     std::shared_ptr<Mlt::Producer> softClone(const char *list);
@@ -223,9 +230,9 @@ public:
     /** @brief Display Bin thumbnail given a percent
      */
     void getThumbFromPercent(int percent);
-    /** @brief Return audio cache for a stream
+    /** @brief Return the audio peaks for a stream, converting a legacy png cache if needed
      */
-    QVector <uint8_t> audioFrameCache(int stream = -1);
+    std::shared_ptr<const AudioPeakFile> audioPeaks(int stream = -1);
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
@@ -270,12 +277,17 @@ private:
     const QString getFileHash();
     QMutex m_producerMutex;
     QMutex m_thumbMutex;
+    QMutex m_audioPeaksMutex;
+    /** @brief The mapped peak files, by audio stream */
+    std::unordered_map<int, std::shared_ptr<const AudioPeakFile>> m_audioPeaks;
     QFuture<void> m_thumbThread;
     QList<int> m_requestedThumbs;
     const QString geometryWithOffset(const QString &data, int offset);
 
     // This is a helper function that creates the disabled producer. This is a clone of the original one, with audio and video disabled
     void createDisabledMasterProducer();
+    /** @brief Serializes the master producer and opens a new producer from it */
+    Mlt::Producer *createClone(bool removeEffects);
 
     std::map<int, std::weak_ptr<TimelineModel>> m_registeredClips;
 
@@ -375,34 +375,39 @@ void ProjectItemModel::onItemUpdated(const QString &binId, int role)
     }
 }
 
+std::shared_ptr<AbstractProjectItem> ProjectItemModel::getIndexedItem(const QString &binId) const
+{
+    auto it = m_binIdIndex.find(binId);
+    if (it == m_binIdIndex.end()) {
+        return nullptr;
+    }
+    auto item = m_allItems.find(it->second);
+    if (item == m_allItems.end()) {
+        return nullptr;
+    }
+    return std::static_pointer_cast<AbstractProjectItem>(item->second.lock());
+}
+
 std::shared_ptr<ProjectClip> ProjectItemModel::getClipByBinID(const QString &binId)
 {
     READ_LOCK();
-    if (binId.contains(QLatin1Char('_'))) {
-        return getClipByBinID(binId.section(QLatin1Char('_'), 0, 0));
-    }
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::ClipItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectClip>(c);
-        }
+    // Sub clips and timeline clips may be referenced as "binId_xxx", only the part before the underscore identifies the bin clip
+    int ix = binId.indexOf(QLatin1Char('_'));
+    auto c = getIndexedItem(ix > -1 ? binId.left(ix) : binId);
+    if (c && c->itemType() == AbstractProjectItem::ClipItem) {
+        return std::static_pointer_cast<ProjectClip>(c);
     }
     return nullptr;
 }
 
-const QVector<uint8_t> ProjectItemModel::getAudioLevelsByBinID(const QString &binId, int stream)
+std::shared_ptr<const AudioPeakFile> ProjectItemModel::getAudioPeaksByBinID(const QString &binId, int stream)
 {
     READ_LOCK();
-    if (binId.contains(QLatin1Char('_'))) {
-        return getAudioLevelsByBinID(binId.section(QLatin1Char('_'), 0, 0), stream);
-    }
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::ClipItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectClip>(c)->audioFrameCache(stream);
-        }
+    std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
+    if (clip) {
+        return clip->audioPeaks(stream);
     }
-    return QVector<uint8_t>();
+    return nullptr;
 }
 
 bool ProjectItemModel::hasClip(const QString &binId)
@@ -414,11 +419,9 @@ bool ProjectItemModel::hasClip(const QString &binId)
 std::shared_ptr<ProjectFolder> ProjectItemModel::getFolderByBinId(const QString &binId)
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->itemType() == AbstractProjectItem::FolderItem && c->clipId() == binId) {
-            return std::static_pointer_cast<ProjectFolder>(c);
-        }
+    auto c = getIndexedItem(binId);
+    if (c && c->itemType() == AbstractProjectItem::FolderItem) {
+        return std::static_pointer_cast<ProjectFolder>(c);
     }
     return nullptr;
 }
@@ -438,13 +441,7 @@ const QString ProjectItemModel::getFolderIdByName(const QString &folderName)
 std::shared_ptr<AbstractProjectItem> ProjectItemModel::getItemByBinId(const QString &binId)
 {
     READ_LOCK();
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->clipId() == binId) {
-            return c;
-        }
-    }
-    return nullptr;
+    return getIndexedItem(binId);
 }
 
 void ProjectItemModel::setBinEffectsEnabled(bool enabled)
@@ -600,6 +597,7 @@ void ProjectItemModel::registerItem(const std::shared_ptr<TreeItem> &item)
     auto clip = std::static_pointer_cast<AbstractProjectItem>(item);
     m_binPlaylist->manageBinItemInsertion(clip);
     AbstractTreeModel::registerItem(item);
+    m_binIdIndex[clip->clipId()] = clip->getId();
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = std::static_pointer_cast<ProjectClip>(clip);
         updateWatcher(clipItem);
@@ -612,6 +610,10 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     m_binPlaylist->manageBinItemDeletion(clip);
     // TODO : here, we should suspend jobs belonging to the item we delete. They can be restarted if the item is reinserted by undo
     AbstractTreeModel::deregisterItem(id, item);
+    auto indexed = m_binIdIndex.find(clip->clipId());
+    if (indexed != m_binIdIndex.end() && indexed->second == id) {
+        m_binIdIndex.erase(indexed);
+    }
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = static_cast<ProjectClip *>(clip);
         m_fileWatcher->removeFile(clipItem->clipId());
@@ -953,13 +955,7 @@ bool ProjectItemModel::isIdFree(const QString &id) const
     if (id.isEmpty()) {
         return false;
     }
-    for (const auto &clip : m_allItems) {
-        auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
-        if (c->clipId() == id) {
-            return false;
-        }
-    }
-    return true;
+    return m_binIdIndex.count(id) == 0;
 }
 
 void ProjectItemModel::loadBinPlaylist(Mlt::Tractor *documentTractor, Mlt::Tractor *modelTractor, std::unordered_map<QString, QString> &binIdCorresp, QProgressDialog *progressDialog)
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QSize>
 
 class AbstractProjectItem;
+class AudioPeakFile;
 class BinPlaylist;
 class FileWatcher;
 class MarkerListModel;
@@ -67,8 +68,8 @@ public:
 
     /** @brief Returns a clip from the hierarchy, given its id */
     std::shared_ptr<ProjectClip> getClipByBinID(const QString &binId);
-    /** @brief Returns audio levels for a clip from its id */
-    const QVector <uint8_t>getAudioLevelsByBinID(const QString &binId, int stream);
+    /** @brief Returns the audio peaks of a clip stream from its id */
+    std::shared_ptr<const AudioPeakFile> getAudioPeaksByBinID(const QString &binId, int stream);
 
     /** @brief Returns a list of clips using the given url */
     QStringList getClipByUrl(const QFileInfo &url) const;
@@ -215,6 +216,9 @@ protected:
     /* @brief Deregister the existence of a new element*/
     void deregisterItem(int id, TreeItem *item) override;
 
+    /* @brief Returns the item registered under the given bin id, or nullptr. Caller must hold the model lock */
+    std::shared_ptr<AbstractProjectItem> getIndexedItem(const QString &binId) const;
+
     /* @brief Helper function to generate a lambda that rename a folder */
     Fun requestRenameFolder_lambda(const std::shared_ptr<AbstractProjectItem> &folder, const QString &newName);
 
@@ -245,6 +249,9 @@ private:
 
     std::unique_ptr<BinPlaylist> m_binPlaylist;
 
+    /** @brief Maps a bin id to the id of the corresponding tree item, kept in sync by registerItem / deregisterItem */
+    std::unordered_map<QString, int> m_binIdIndex;
+
     std::unique_ptr<FileWatcher> m_fileWatcher;
 
     int m_nextId;
@@ -781,6 +781,17 @@ int Core::getTimelinePosition() const
     return 0;
 }
 
+void Core::setVisibleTimelineRange(int start, int end)
+{
+    m_visibleTimelineRange = (qint64(start) << 32) | quint32(end);
+}
+
+QPair<int, int> Core::visibleTimelineRange() const
+{
+    qint64 range = m_visibleTimelineRange;
+    return {int(range >> 32), int(quint32(range))};
+}
+
 void Core::triggerAction(const QString &name)
 {
     QAction *action = m_mainWindow->actionCollection()->action(name);
@@ -17,6 +17,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QMutex>
 #include <QObject>
 #include <QUrl>
+#include <atomic>
 #include <memory>
 #include <QPoint>
 #include "timecode.h"
@@ -193,6 +194,10 @@ public:
     bool hasTimelinePreview() const;
     /** @brief Returns current timeline cursor position  */
     int getTimelinePosition() const;
+    /** @brief Set the range of frames displayed in the timeline view, so that jobs can process the visible clips first */
+    void setVisibleTimelineRange(int start, int end);
+    /** @brief Returns the range of frames displayed in the timeline view, the end is -1 if it is not known yet. Can be called from any thread */
+    QPair<int, int> visibleTimelineRange() const;
     /** @brief Handles audio and video capture **/
     void startMediaCapture(int tid, bool, bool);
     void stopMediaCapture(int tid, bool, bool);
@@ -251,6 +256,8 @@ private:
     std::unique_ptr<MediaCapture> m_capture;
     QUrl m_mediaCaptureFile;
     QMutex m_thumbProfileMutex;
+    /** @brief Visible timeline range, start in the high 32 bits and end in the low ones so that both are read at once */
+    std::atomic<qint64> m_visibleTimelineRange{0xffffffffLL};
 
 public slots:
     void triggerAction(const QString &name);
@@ -90,12 +90,6 @@ enum {
     ErrorRole
 };
 
-// Render job roles
-const int ParametersRole = Qt::UserRole + 1;
-const int TimeRole = Qt::UserRole + 2;
-const int ProgressRole = Qt::UserRole + 3;
-const int ExtraInfoRole = Qt::UserRole + 5;
-
 // Running job status
 enum JOBSTATUS { WAITINGJOB = 0, STARTINGJOB, RUNNINGJOB, FINISHEDJOB, FAILEDJOB, ABORTEDJOB };
 
@@ -356,9 +350,12 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
 #endif
     m_view.parallel_process->setChecked(KdenliveSettings::parallelrender());
     connect(m_view.parallel_process, &QCheckBox::stateChanged, [](int state) { KdenliveSettings::setParallelrender(state == Qt::Checked); });
+    m_view.segmented_render->setChecked(KdenliveSettings::segmentedrender());
+    connect(m_view.segmented_render, &QCheckBox::stateChanged, [](int state) { KdenliveSettings::setSegmentedrender(state == Qt::Checked); });
     if (KdenliveSettings::gpu_accel()) {
         // Disable parallel rendering for movit
         m_view.parallel_process->setEnabled(false);
+        m_view.segmented_render->setEnabled(false);
     }
     m_view.field_order->setEnabled(false);
     connect(m_view.scanning_list, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int index) { m_view.field_order->setEnabled(index == 2); });
@@ -1545,7 +1542,18 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
     }
     QStringList playlists;
     QString renderedFile = m_view.out_file->url().toLocalFile();
-    if (m_view.advanced_params->toPlainText().simplified().contains("=stills/"))
+    const bool stills = m_view.advanced_params->toPlainText().simplified().contains("=stills/");
+    // Render the video in concurrent segments, joined without re-encoding. Not possible for image sequences,
+    // audio only and 2 pass renders
+    QStringList segmentArgs;
+    if (m_view.segmented_render->isChecked() && m_view.segmented_render->isEnabled() && passes == 1 && !stills &&
+        !renderArgs.contains(QLatin1String("vn=1")) && !renderArgs.contains(QLatin1String("video_off=1"))) {
+        segmentArgs << QStringLiteral("-segments:%1").arg(qBound(2, QThread::idealThreadCount() / 2, 8));
+        if (!KdenliveSettings::ffmpegpath().isEmpty()) {
+            segmentArgs << QStringLiteral("-ffmpeg:%1").arg(KdenliveSettings::ffmpegpath());
+        }
+    }
+    if (stills)
     {
         // Image sequence, ensure we have a %0xd at file end
         QString extension = renderedFile.section(QLatin1Char('.'), -1);
@@ -1624,7 +1632,9 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
             renderItem->setData(1, Qt::UserRole, i18n("Waiting..."));
             QStringList argsJob = {KdenliveSettings::rendererpath(), playlistPath, renderedFile,
                                    QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid())};
+            argsJob << segmentArgs;
             renderItem->setData(1, ParametersRole, argsJob);
+            renderItem->setData(1, SegmentsRole, QVariant());
             renderItem->setData(1, TimeRole, QDateTime::currentDateTime());
             if (!exportAudio) {
                 renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
@@ -1646,6 +1656,7 @@ void RenderWidget::generateRenderFiles(QDomDocument doc, const QString &playlist
         renderItem = new RenderJobItem(m_view.running_jobs, QStringList() << QString() << renderedFile);
         renderItem->setData(1, TimeRole, QDateTime::currentDateTime());
         QStringList argsJob = {KdenliveSettings::rendererpath(), pl, renderedFile, QStringLiteral("-pid:%1").arg(QCoreApplication::applicationPid())};
+        argsJob << segmentArgs;
         renderItem->setData(1, ParametersRole, argsJob);
         qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
         if (!exportAudio) {
@@ -2566,6 +2577,14 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     checkRenderStatus();
 }
 
+void RenderWidget::setRenderSegments(const QString &dest, const QStringList &segments)
+{
+    QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
+    if (!existing.isEmpty()) {
+        existing.at(0)->setData(1, SegmentsRole, segments);
+    }
+}
+
 void RenderWidget::slotAbortCurrentJob()
 {
     auto *current = static_cast<RenderJobItem *>(m_view.running_jobs->currentItem());
@@ -39,6 +39,13 @@ class Menu;
 class QDomElement;
 class QKeyEvent;
 
+// Render job roles
+const int ParametersRole = Qt::UserRole + 1;
+const int TimeRole = Qt::UserRole + 2;
+const int ProgressRole = Qt::UserRole + 3;
+const int ExtraInfoRole = Qt::UserRole + 5;
+const int SegmentsRole = Qt::UserRole + 6;
+
 // RenderViewDelegate is used to draw the progress bars.
 class RenderViewDelegate : public QStyledItemDelegate
 {
@@ -71,7 +78,7 @@ public:
             font.setBold(false);
             painter->setFont(font);
             painter->drawText(r1, Qt::AlignLeft | Qt::AlignTop, index.data(Qt::UserRole).toString());
-            int progress = index.data(Qt::UserRole + 3).toInt();
+            int progress = index.data(ProgressRole).toInt();
             if (progress > 0 && progress < 100) {
                 // draw progress bar
                 QColor color = option.palette.alternateBase().color();
@@ -88,10 +95,26 @@ public:
                 painter->setPen(Qt::NoPen);
                 bgrect.setWidth((width - 2) * progress / 100);
                 painter->drawRect(bgrect);
+                // progress of each segment for segmented renders
+                const QStringList segments = index.data(SegmentsRole).toStringList();
+                if (!segments.isEmpty()) {
+                    int left = r1.left() + width + 10;
+                    int segmentWidth = qMin(30, (r1.right() - left) / segments.count() - 2);
+                    for (int i = 0; segmentWidth > 4 && i < segments.count(); ++i) {
+                        QRect segrect(left + i * (segmentWidth + 2), option.rect.bottom() - 6 - textMargin, segmentWidth, 6);
+                        painter->setBrush(QBrush(color));
+                        painter->setPen(QPen(fgColor));
+                        painter->drawRect(segrect);
+                        painter->setBrush(QBrush(fgColor));
+                        painter->setPen(Qt::NoPen);
+                        segrect.setWidth(segmentWidth * qBound(0, segments.at(i).toInt(), 100) / 100);
+                        painter->drawRect(segrect);
+                    }
+                }
             } else {
                 r1.setBottom(opt.rect.bottom());
                 r1.setTop(r1.bottom() - mid);
-                painter->drawText(r1, Qt::AlignLeft | Qt::AlignBottom, index.data(Qt::UserRole + 5).toString());
+                painter->drawText(r1, Qt::AlignLeft | Qt::AlignBottom, index.data(ExtraInfoRole).toString());
             }
             painter->restore();
         } else {
@@ -125,6 +148,8 @@ public:
     void focusFirstVisibleItem(const QString &profile = QString());
     void setRenderJob(const QString &dest, int progress = 0);
     void setRenderStatus(const QString &dest, int status, const QString &error);
+    /** @brief Update the progress of each segment of a segmented render */
+    void setRenderSegments(const QString &dest, const QStringList &segments);
     void updateDocumentPath();
     void reloadProfiles();
     void setRenderProfile(const QMap<QString, QString> &props);
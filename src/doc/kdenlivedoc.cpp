@@ -37,9 +37,11 @@
 #include "mltcontroller/clipcontroller.h"
 #include "profiles/profilemodel.hpp"
 #include "profiles/profilerepository.hpp"
+#include "project/autosavejournal.h"
 #include "project/projectcommands.h"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/filehashindex.hpp"
 
 #include <config-kdenlive.h>
 
@@ -58,6 +60,7 @@
 #include <QFileDialog>
 #include <QUndoGroup>
 #include <QUndoStack>
+#include <QtConcurrent>
 
 #include <KJobWidgets/KJobWidgets>
 #include <QStandardPaths>
@@ -87,6 +90,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
     bool success = false;
     connect(m_commandStack.get(), &QUndoStack::indexChanged, this, &KdenliveDoc::slotModified);
     connect(m_commandStack.get(), &DocUndoStack::invalidate, this, &KdenliveDoc::checkPreviewStack);
+    connect(&m_autoSaveWatcher, &QFutureWatcher<AutoSaveResult>::finished, this, &KdenliveDoc::slotAutoSaveFinished);
     // connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
 
     // init default document properties
@@ -281,6 +285,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
 
 KdenliveDoc::~KdenliveDoc()
 {
+    m_autoSaveWatcher.waitForFinished();
     if (m_url.isEmpty()) {
         // Document was never saved, delete cache folder
         QString documentId = QDir::cleanPath(getDocumentProperty(QStringLiteral("documentid")));
@@ -299,6 +304,7 @@ KdenliveDoc::~KdenliveDoc()
     // qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN done";
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) {
+            AutoSaveJournal::discard(m_autosave->fileName());
             m_autosave->remove();
         }
         delete m_autosave;
@@ -440,9 +446,10 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+void KdenliveDoc::slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements)
 {
     if (m_autosave != nullptr) {
+        m_autoSaveWatcher.waitForFinished();
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
             // show error: could not open the autosave file
             qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
@@ -454,12 +461,75 @@ void KdenliveDoc::slotAutoSave(const QString &scene)
             KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
             return;
         }
+        if (m_autosave->fileName() != m_autoSaveBaseFile) {
+            // The autosave file changed, journal entries need a new base
+            m_autoSaveBase.clear();
+            m_autoSaveHash.clear();
+            m_autoSaveBaseFile = m_autosave->fileName();
+        }
+        m_autoSaveWatcher.setFuture(QtConcurrent::run(this, &KdenliveDoc::writeAutoSave, scene, replacements));
+    }
+}
+
+KdenliveDoc::AutoSaveResult KdenliveDoc::writeAutoSave(QString scene, const QMap<QString, QString> &replacements)
+{
+    QMapIterator<QString, QString> i(replacements);
+    while (i.hasNext()) {
+        i.next();
+        scene.replace(i.key(), i.value());
+    }
+    const QByteArray data = scene.toUtf8();
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (hash == m_autoSaveHash) {
+        return AutoSaveUnchanged;
+    }
+    if (!m_autoSaveBase.isEmpty()) {
+        const QByteArray entry = AutoSaveJournal::createEntry(m_autoSaveBase, data);
+        // Once the changes get too large, write a new base instead
+        if (entry.size() < data.size() / 4 && AutoSaveJournal::write(m_autoSaveBaseFile, entry)) {
+            m_autoSaveHash = hash;
+            return AutoSaveIncremental;
+        }
+    }
+    m_autoSaveBase.clear();
+    m_autoSaveHash.clear();
+    m_autosave->resize(0);
+    if (m_autosave->write(data) < 0) {
+        return AutoSaveFailed;
+    }
+    m_autosave->flush();
+    // The journal was created against the previous base
+    AutoSaveJournal::discard(m_autoSaveBaseFile);
+    m_autoSaveBase = data;
+    m_autoSaveHash = hash;
+    return AutoSaveFull;
+}
+
+void KdenliveDoc::slotAutoSaveFinished()
+{
+    AutoSaveResult result = m_autoSaveWatcher.result();
+    if (result == AutoSaveFailed) {
+        pCore->displayMessage(i18n("Cannot create autosave file %1", m_autoSaveBaseFile), ErrorMessage);
+    }
+    emit autoSaved(result);
+}
+
+bool KdenliveDoc::isAutoSaving() const
+{
+    return m_autoSaveWatcher.isRunning();
+}
+
+void KdenliveDoc::clearAutoSave()
+{
+    m_autoSaveWatcher.waitForFinished();
+    if (m_autosave != nullptr) {
         m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        };
-        m_autosave->flush();
+        if (!m_autosave->fileName().isEmpty()) {
+            AutoSaveJournal::discard(m_autosave->fileName());
+        }
     }
+    m_autoSaveBase.clear();
+    m_autoSaveHash.clear();
 }
 
 void KdenliveDoc::setZoom(int horizontal, int vertical)
@@ -792,34 +862,21 @@ const QString KdenliveDoc::description() const
 QString KdenliveDoc::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const
 {
     QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
+    QStringList candidates;
     QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (file.open(QIODevice::ReadOnly)) {
-            if (QString::number(file.size()) == matchSize) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-                qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << "size match but not hash";
-            }
+    for (const QString &fileName : filesAndDirs) {
+        const QString path = dir.absoluteFilePath(fileName);
+        if (QString::number(QFileInfo(path).size()) == matchSize) {
+            candidates << path;
         }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
+    }
+    // Files of the same size are hashed in parallel, and remembered for the next search
+    foundFileName = FileHashIndex::get()->findFile(candidates, matchHash);
+    if (!foundFileName.isEmpty()) {
+        return foundFileName;
+    }
+    if (!candidates.isEmpty()) {
+        qCDebug(KDENLIVE_LOG) << candidates << "size match but not hash";
     }
     filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
     for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
@@ -27,6 +27,7 @@
 
 #include <QAction>
 #include <QDir>
+#include <QFutureWatcher>
 #include <QList>
 #include <QMap>
 #include <memory>
@@ -68,6 +69,12 @@ public:
     int height() const;
     QUrl url() const;
     KAutoSaveFile *m_autosave;
+    /** @brief Outcome of a background autosave */
+    enum AutoSaveResult { AutoSaveFailed, AutoSaveUnchanged, AutoSaveFull, AutoSaveIncremental };
+    /** @brief Returns true while an autosave is being written */
+    bool isAutoSaving() const;
+    /** @brief Waits for a running autosave, then empties the autosave file and its journal */
+    void clearAutoSave();
     Timecode timecode() const;
     std::shared_ptr<DocUndoStack> commandStack();
 
@@ -187,6 +194,14 @@ private:
     QMap<QString, QString> m_documentProperties;
     QMap<QString, QString> m_documentMetadata;
     std::shared_ptr<MarkerListModel> m_guideModel;
+    /** @brief Running autosave write */
+    QFutureWatcher<AutoSaveResult> m_autoSaveWatcher;
+    /** @brief Scene last written in full to the autosave file, the journal entries are created against it */
+    QByteArray m_autoSaveBase;
+    /** @brief Autosave file m_autoSaveBase was written to */
+    QString m_autoSaveBaseFile;
+    /** @brief Hash of the last autosaved scene */
+    QByteArray m_autoSaveHash;
 
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
 
@@ -204,6 +219,8 @@ private:
     void updateProjectProfile(bool reloadProducers = false, bool reloadThumbs = false);
     /** @brief initialize proxy settings based on hw status */
     void initProxySettings();
+    /** @brief Writes the scene to the autosave file or its journal, runs in a worker thread */
+    AutoSaveResult writeAutoSave(QString scene, const QMap<QString, QString> &replacements);
 
 public slots:
     void slotCreateTextTemplateClip(const QString &group, const QString &groupId, QUrl path);
@@ -216,8 +233,11 @@ public slots:
     void slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<ProjectClip>> clipList = QList<std::shared_ptr<ProjectClip>>(), bool force = false,
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
-     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * @description The autosave files are in ~/.kde/data/stalefiles/kdenlive/ \n
+     * The replacements and the write are done in a worker thread. Small changes are only written as a journal entry
+     * against the last full autosave, see AutoSaveJournal. Emits autoSaved when done.
+     * @param replacements strings to replace in the scene before writing it */
+    void slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements = QMap<QString, QString>());
     /** @brief Groups were changed, save to MLT. */
     void groupsChanged(const QString &groups);
 
@@ -229,6 +249,7 @@ private slots:
     void checkPreviewStack();
     /** @brief Guides were changed, save to MLT. */
     void guidesChanged();
+    void slotAutoSaveFinished();
 
 signals:
     void resetProjectList();
@@ -242,6 +263,8 @@ signals:
     void saveTimelinePreview(const QString &path);
     /** @brief Trigger the autosave timer start */
     void startAutoSave();
+    /** @brief A background autosave finished */
+    void autoSaved(KdenliveDoc::AutoSaveResult result);
     /** @brief Current doc created effects, reload list */
     void reloadEffects(const QStringList &paths);
     /** @brief Fps was changed, update timeline (changed = 1 means no change) */
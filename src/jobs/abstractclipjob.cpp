@@ -22,6 +22,8 @@
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
 
+#include <QThread>
+
 AbstractClipJob::AbstractClipJob(JOBTYPE type, QString id, QObject *parent)
     : QObject(parent)
     , m_clipId(std::move(id))
@@ -64,3 +66,9 @@ AbstractClipJob::JOBTYPE AbstractClipJob::jobType() const
     return m_jobType;
 }
 
+// static
+int AbstractClipJob::maxClipWorkers()
+{
+    // More decoders on the same file mostly compete for the disk
+    return qBound(1, QThread::idealThreadCount(), 4);
+}
@@ -82,6 +82,9 @@ public:
     /* @brief return the type of this job */
     JOBTYPE jobType() const;
 
+    /** @brief Returns how many producers (and decoders) a job may open on a single clip to process it in parallel */
+    static int maxClipWorkers();
+
 protected:
     QString m_clipId;
     QString m_errorMessage;
@@ -27,11 +27,12 @@
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
+#include "lib/audio/audioLevels.h"
+#include "lib/audio/audioPeaks.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "macros.hpp"
 #include "utils/thumbnailcache.hpp"
 #include <QScopedPointer>
-#include <QTemporaryFile>
 #include <QProcess>
 #include <memory>
 #include <mlt++/MltProducer.h>
@@ -49,7 +50,8 @@ const QString AudioThumbJob::getDescription() const
 
 bool AudioThumbJob::computeWithMlt()
 {
-    m_audioLevels.clear();
+    m_minimums.clear();
+    m_maximums.clear();
     m_errorMessage.clear();
     // MLT audio thumbs: slower but safer
     QString service = m_prod->get("mlt_service");
@@ -102,9 +104,14 @@ bool AudioThumbJob::computeWithMlt()
             }
         }
     }
-    // Normalize
+    // Normalize, MLT only gives us one level per frame, stored as symmetrical extrema
+    m_binsPerFrame = 1;
+    m_minimums.reserve(size_t(mltLevels.size()));
+    m_maximums.reserve(size_t(mltLevels.size()));
     for (double &v : mltLevels) {
-        m_audioLevels << 255 * v / maxLevel;
+        auto peak = qint16(32767 * v / maxLevel);
+        m_minimums.push_back(qint16(-peak));
+        m_maximums.push_back(peak);
     }
 
     m_done = true;
@@ -154,124 +161,63 @@ bool AudioThumbJob::computeWithFFMPEG()
     }
     if (!m_dataInCache && !m_done && KdenliveSettings::audiothumbnails()) {
         // Generate timeline audio thumbnail data
-        m_audioLevels.clear();
-        std::vector<std::unique_ptr<QTemporaryFile>> channelFiles;
-        for (int i = 0; i < m_channels; i++) {
-            std::unique_ptr<QTemporaryFile> channelTmpfile(new QTemporaryFile());
-            if (!channelTmpfile->open()) {
-                m_errorMessage.append(i18n("Audio thumbs: cannot create temporary file, check disk space and permissions\n"));
-                return false;
-            }
-            channelTmpfile->close();
-            channelFiles.emplace_back(std::move(channelTmpfile));
-        }
-        // Always create audio thumbs from the original source file, because proxy 
-        // can have a different audio config (channels / mono/ stereo)
-        QStringList args {QStringLiteral("-hide_banner"), QStringLiteral("-i"), QUrl::fromLocalFile(filePath).toLocalFile(), QStringLiteral("-progress")};
-#ifdef Q_OS_WIN
-        args << QStringLiteral("-");
-#else
-        args << QStringLiteral("/dev/stdout");
-#endif
-        bool isFFmpeg = KdenliveSettings::ffmpegpath().contains(QLatin1String("ffmpeg"));
-        args << QStringLiteral("-filter_complex");
-        if (m_channels == 1) {
-            if (m_audioStream >= 0) {
-                args << QStringLiteral("[a:%1]aformat=channel_layouts=mono,%2=100").arg(audioStreamIndex).arg(isFFmpeg ? "aresample=async" : "sample_rates");
-            } else {
-                args << QStringLiteral("[a]aformat=channel_layouts=mono,%1=100").arg(isFFmpeg ? "aresample=async" : "sample_rates");
-            }
-            /*args << QStringLiteral("-map") << QStringLiteral("0:a%1").arg(m_audioStream > 0 ? ":" + QString::number(audioStreamIndex) : QString())*/
-            args << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-frames:v") 
-             << QStringLiteral("1") << QStringLiteral("-y") << QStringLiteral("-f") << QStringLiteral("data")
-             << channelFiles[0]->fileName();
-        } else {
-            QString aformat = QStringLiteral("[a%1]%2=100,channelsplit=channel_layout=%3")
-                              .arg(audioStreamIndex >= 0 ? ":" + QString::number(audioStreamIndex) : QString())
-                              .arg(isFFmpeg ? "aresample=async" : "aformat=sample_rates")
-                              .arg(m_channels > 2 ? "5.1" : "stereo");
-            for (int i = 0; i < m_channels; ++i) {
-                aformat.append(QStringLiteral("[0:%1]").arg(i));
-            }
-            args << aformat;
-            args << QStringLiteral("-frames:v") << QStringLiteral("1");
-            for (int i = 0; i < m_channels; i++) {
-                // Channel 1
-                args << QStringLiteral("-map") << QStringLiteral("[0:%1]").arg(i) << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-y")
-                 << QStringLiteral("-f") << QStringLiteral("data") << channelFiles[size_t(i)]->fileName();
-            }
-        }
+        m_minimums.clear();
+        m_maximums.clear();
+        // Always create audio thumbs from the original source file, because proxy
+        // can have a different audio config (channels / mono/ stereo).
+        // FFmpeg writes interleaved PCM to its stdout, which we reduce on the fly to per frame levels
+        QStringList args {QStringLiteral("-hide_banner"), QStringLiteral("-nostats"), QStringLiteral("-loglevel"), QStringLiteral("error"),
+                          QStringLiteral("-i"), QUrl::fromLocalFile(filePath).toLocalFile()};
+        args << QStringLiteral("-vn") << QStringLiteral("-map") << QStringLiteral("0:a:%1").arg(qMax(0, audioStreamIndex));
+        args << QStringLiteral("-ac") << QString::number(m_channels) << QStringLiteral("-ar") << QString::number(m_frequency);
+        args << QStringLiteral("-c:a") << QStringLiteral("pcm_s16le") << QStringLiteral("-f") << QStringLiteral("s16le") << QStringLiteral("pipe:1");
         m_ffmpegProcess.reset(new QProcess);
-        connect(m_ffmpegProcess.get(), &QProcess::readyReadStandardOutput, this, &AudioThumbJob::updateFfmpegProgress, Qt::UniqueConnection);
+        m_ffmpegProcess->setReadChannel(QProcess::StandardOutput);
         connect(this, &AudioThumbJob::jobCanceled, [&]() {
             if (m_ffmpegProcess) {
-                disconnect(m_ffmpegProcess.get(), &QProcess::readyReadStandardOutput, this, &AudioThumbJob::updateFfmpegProgress);
                 m_ffmpegProcess->kill();
             }
         });
+        // Keep several bins per frame, so that the waveform stays detailed when zooming in
+        AudioLevelReducer reducer(m_channels, m_frequency, m_prod->get_fps(), 4);
+        const qint64 totalSamples = qMax(qint64(1), qint64(m_lengthInFrames) * m_frequency / qMax(1., m_prod->get_fps()));
+        const int sampleSize = int(sizeof(qint16)) * m_channels;
+        // Read in fixed blocks, whole samples only; an incomplete sample stays in the buffer until the next read
+        QByteArray buffer(sampleSize * 16384, Qt::Uninitialized);
+        int pending = 0;
+        int progress = 0;
         m_ffmpegProcess->start(KdenliveSettings::ffmpegpath(), args);
-        m_ffmpegProcess->waitForFinished(-1);
-        disconnect(m_ffmpegProcess.get(), &QProcess::readyReadStandardOutput, this, &AudioThumbJob::updateFfmpegProgress);
-        if (m_ffmpegProcess->exitStatus() != QProcess::CrashExit) {
-            int dataSize = 0;
-            std::vector<const qint16 *> rawChannels;
-            std::vector<QByteArray> sourceChannels;
-            for (auto &channelFile : channelFiles) {
-                channelFile->open();
-                sourceChannels.emplace_back(channelFile->readAll());
-                QByteArray &res = sourceChannels.back();
-                channelFile->close();
-                if (dataSize == 0) {
-                    dataSize = res.size();
-                }
-                if (res.isEmpty() || res.size() != dataSize) {
-                    // Something went wrong, abort
-                    m_errorMessage.append(i18n("Audio thumbs: error reading audio thumbnail created with FFmpeg\n"));
-                    return false;
-                }
-                rawChannels.emplace_back(reinterpret_cast<const qint16 *>(res.constData()));
-            }
-            int progress = 0;
-            std::vector<long> channelsData;
-            double offset = (double)dataSize / (2.0 * m_lengthInFrames);
-            int intraOffset = 1;
-            if (offset > 1000) {
-                intraOffset = offset / 60;
-            } else if (offset > 250) {
-                intraOffset = offset / 10;
-            }
-            long maxLevel = 1;
-            QVector <long> ffmpegLevels;
-            for (int i = 0; i < m_lengthInFrames; i++) {
-                channelsData.resize((size_t)rawChannels.size());
-                std::fill(channelsData.begin(), channelsData.end(), 0);
-                int pos = (int)(i * offset);
-                int steps = 0;
-                for (int j = 0; j < (int)offset && (pos + j < dataSize); j += intraOffset) {
-                    steps++;
-                    for (size_t k = 0; k < rawChannels.size(); k++) {
-                        channelsData[k] += abs(rawChannels[k][pos + j]);
-                    }
+        while (m_ffmpegProcess->waitForReadyRead(-1) || m_ffmpegProcess->bytesAvailable() > 0) {
+            while (m_ffmpegProcess->bytesAvailable() > 0) {
+                qint64 read = m_ffmpegProcess->read(buffer.data() + pending, buffer.size() - pending);
+                if (read <= 0) {
+                    break;
                 }
-                for (long &k : channelsData) {
-                    if (steps != 0) {
-                        k /= steps;
-                    }
-                    maxLevel = qMax(k, maxLevel);
-                    ffmpegLevels << k;
+                pending += int(read);
+                int samples = pending / sampleSize;
+                reducer.process(reinterpret_cast<const qint16 *>(buffer.constData()), samples);
+                int remaining = pending - samples * sampleSize;
+                if (remaining > 0) {
+                    memmove(buffer.data(), buffer.constData() + samples * sampleSize, size_t(remaining));
                 }
-                int p = 80 + (i * 20 / m_lengthInFrames);
+                pending = remaining;
+                int p = int(qMin(qint64(100), 100 * reducer.samplesConsumed() / totalSamples));
                 if (p != progress) {
                     emit jobProgress(p);
                     progress = p;
                 }
             }
-            for (long &v : ffmpegLevels) {
-                m_audioLevels << (uint8_t) (255 * v / maxLevel);
-            }
+        }
+        m_ffmpegProcess->waitForFinished(-1);
+        reducer.finish();
+        if (m_ffmpegProcess->exitStatus() != QProcess::CrashExit && m_ffmpegProcess->exitCode() == 0 && reducer.binCount() > 0) {
+            m_binsPerFrame = reducer.binsPerFrame();
+            m_minimums = reducer.minimums();
+            m_maximums = reducer.maximums();
             m_done = true;
             return true;
         }
+        m_errorMessage.append(i18n("Audio thumbs: error reading audio thumbnail created with FFmpeg\n"));
     }
     if (!KdenliveSettings::audiothumbnails()) {
         // We only wanted the thumb generation
@@ -342,11 +288,10 @@ bool AudioThumbJob::startJob()
         int stream = st.key();
         // Generate one thumb per stream
         m_audioStream = stream;
-        m_cachePath = m_binClip->getAudioThumbPath(stream);
+        m_cachePath = m_binClip->getAudioPeakPath(stream);
 
-        // checking for cached thumbs
-        QImage image(m_cachePath);
-        if (!image.isNull()) {
+        // checking for cached peaks, a legacy png cache is converted when first displayed
+        if (QFile::exists(m_cachePath) || QFile::exists(m_binClip->getAudioThumbPath(stream))) {
             // Audio cache already exists
             continue;
         }
@@ -356,29 +301,11 @@ bool AudioThumbJob::startJob()
         ok = ok ? ok : computeWithMlt();
         Q_ASSERT(ok == m_done);
 
-        if (ok && m_done && !m_audioLevels.isEmpty()) {
-            // Put into an image for caching.
-            int count = m_audioLevels.size();
-            image = QImage((int)lrint((count + 3) / 4.0 / m_channels), m_channels, QImage::Format_ARGB32);
-            int n = image.width() * image.height();
-            for (int i = 0; i < n; i++) {
-                QRgb p;
-                if ((4 * i + 3) < count) {
-                    p = qRgba(m_audioLevels.at(4 * i), m_audioLevels.at(4 * i + 1), m_audioLevels.at(4 * i + 2),
-                          m_audioLevels.at(4 * i + 3));
-                } else {
-                    int last = m_audioLevels.last();
-                    int r = (4 * i + 0) < count ? m_audioLevels.at(4 * i + 0) : last;
-                    int g = (4 * i + 1) < count ? m_audioLevels.at(4 * i + 1) : last;
-                    int b = (4 * i + 2) < count ? m_audioLevels.at(4 * i + 2) : last;
-                    int a = last;
-                    p = qRgba(r, g, b, a);
-                }
-                image.setPixel(i / m_channels, i % m_channels, p);
-            }
-            image.save(m_cachePath);
+        if (ok && m_done && !m_minimums.empty()) {
+            AudioPeakFile::write(m_cachePath, m_channels, m_binsPerFrame, m_minimums, m_maximums);
         }
-        m_audioLevels.clear();
+        m_minimums.clear();
+        m_maximums.clear();
     }
     if (m_done || !KdenliveSettings::audiothumbnails()) {
         m_successful = true;
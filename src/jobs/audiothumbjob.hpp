@@ -24,6 +24,7 @@
 #include "abstractclipjob.h"
 
 #include <memory>
+#include <vector>
 #include <QImage>
 
 /* @brief This class represents the job that corresponds to computing the audio thumb of a clip (waveform)
@@ -72,6 +73,9 @@ private:
 
     bool m_done{false}, m_successful{false};
     int m_channels, m_frequency, m_lengthInFrames, m_audioStream;
-    QVector <uint8_t>m_audioLevels;
+    // interleaved extrema of each bin, written to the peak file
+    std::vector<qint16> m_minimums;
+    std::vector<qint16> m_maximums;
+    int m_binsPerFrame{1};
     std::unique_ptr<QProcess> m_ffmpegProcess;
 };
@@ -31,9 +31,16 @@
 #include <QImage>
 #include <QScopedPointer>
 #include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <mlt++/MltProducer.h>
 
-#include <set>
+#include <algorithm>
+
+namespace {
+// Don't open a producer for less than this number of thumbnails
+const int minFramesPerWorker = 4;
+} // namespace
 
 CacheJob::CacheJob(const QString &binId, int thumbsCount, int inPoint, int outPoint)
     : AbstractClipJob(CACHEJOB, binId)
@@ -80,11 +87,6 @@ bool CacheJob::startJob()
         m_done = true;
         return true;
     }
-    m_prod = m_binClip->thumbProducer();
-    if ((m_prod == nullptr) || !m_prod->is_valid()) {
-        qDebug() << "********\nCOULD NOT READ THUMB PRODUCER\n********";
-        return false;
-    }
     int duration = m_outPoint > 0 ? m_outPoint - m_inPoint : (int)m_binClip->frameDuration();
     if (m_thumbsCount * 5 > duration) {
         m_thumbsCount = duration / 10;
@@ -93,36 +95,136 @@ bool CacheJob::startJob()
     double steps = qMax(pCore->getCurrentFps(), (double)duration / m_thumbsCount);
     int pos = m_inPoint;
     for (int i = 1; i <= m_thumbsCount && pos <= duration; ++i) {
-        frames.insert(pos);
+        if (!ThumbnailCache::get()->hasThumbnail(m_clipId, pos)) {
+            frames.insert(pos);
+        }
         pos = m_inPoint + (steps * i);
     }
-    int size = (int)frames.size();
-    int count = 0;
-    for (int i : frames) {
-        emit jobProgress(100 * count / size);
-        count++;
-        if (m_clipId.isEmpty() || ThumbnailCache::get()->hasThumbnail(m_clipId, i)) {
-            continue;
-        }
-        if (m_done || !m_semaphore.tryAcquire(1)) {
-            m_semaphore.release();
+    if (frames.empty()) {
+        m_done = true;
+        return true;
+    }
+    if (m_done || !m_semaphore.tryAcquire(1)) {
+        return false;
+    }
+    // Use dedicated producers, so that the thumbnail requests from the timeline don't have to wait for us
+    int workers = qBound(1, (int)frames.size() / minFramesPerWorker, maxClipWorkers());
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    for (int i = 0; i < workers; ++i) {
+        std::shared_ptr<Mlt::Producer> prod = m_binClip->createThumbProducer();
+        if (prod == nullptr || !prod->is_valid()) {
             break;
         }
-        m_prod->seek(i);
-        QScopedPointer<Mlt::Frame> frame(m_prod->get_frame());
-        frame->set("deinterlace_method", "onefield");
-        frame->set("top_field_first", -1);
-        frame->set("rescale.interp", "nearest");
-        if (frame != nullptr && frame->is_valid()) {
-            QImage result = KThumb::getFrame(frame.data(), 0, 0, m_fullWidth);
-            ThumbnailCache::get()->storeThumbnail(m_clipId, i, result, true);
-        }
-        m_semaphore.release(1);
+        producers.push_back(prod);
     }
+    if (producers.empty()) {
+        qDebug() << "********\nCOULD NOT READ THUMB PRODUCER\n********";
+        m_semaphore.release();
+        return false;
+    }
+    const QString binId = m_clipId;
+    const int size = (int)frames.size();
+    std::atomic<int> count{0};
+    // Thumbnails displayed in the timeline are extracted first
+    for (const std::vector<int> &batch : frameBatches(frames, visibleSourceRanges())) {
+        extractFrames(producers, batch, m_fullWidth,
+                      [&](int frame, const QImage &img) {
+                          if (!m_done) {
+                              ThumbnailCache::get()->storeThumbnail(binId, frame, img, true);
+                              emit jobProgress(100 * (++count) / size);
+                          }
+                      },
+                      [&]() { return m_done.load(); });
+    }
+    m_semaphore.release(1);
     m_done = true;
     return true;
 }
 
+// static
+void CacheJob::extractFrames(const std::vector<std::shared_ptr<Mlt::Producer>> &producers, const std::vector<int> &frames, int fullWidth,
+                             const std::function<void(int, const QImage &)> &store, const std::function<bool()> &canceled)
+{
+    auto extract = [&](const std::shared_ptr<Mlt::Producer> &prod, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (canceled()) {
+                break;
+            }
+            prod->seek(frames[i]);
+            QScopedPointer<Mlt::Frame> frame(prod->get_frame());
+            if (frame == nullptr || !frame->is_valid()) {
+                continue;
+            }
+            frame->set("deinterlace_method", "onefield");
+            frame->set("top_field_first", -1);
+            frame->set("rescale.interp", "nearest");
+            QImage result = KThumb::getFrame(frame.data(), 0, 0, fullWidth);
+            if (!result.isNull()) {
+                store(frames[i], result);
+            }
+        }
+    };
+    if (producers.empty() || frames.empty()) {
+        return;
+    }
+    size_t workers = qMin(producers.size(), frames.size());
+    size_t chunk = (frames.size() + workers - 1) / workers;
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, (int)workers - 1));
+    QList<QFuture<void>> futures;
+    for (size_t w = 1; w < workers; ++w) {
+        size_t first = w * chunk;
+        size_t last = qMin(frames.size(), first + chunk);
+        if (first < last) {
+            futures << QtConcurrent::run(&pool, extract, producers[w], first, last);
+        }
+    }
+    // The first chunk is processed in the calling thread
+    extract(producers.front(), 0, qMin(frames.size(), chunk));
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+// static
+std::vector<std::vector<int>> CacheJob::frameBatches(const std::set<int> &frames, const std::vector<std::pair<int, int>> &visible)
+{
+    std::vector<int> first;
+    std::vector<int> others;
+    for (int frame : frames) {
+        bool isVisible = std::any_of(visible.begin(), visible.end(), [frame](const std::pair<int, int> &range) { return frame >= range.first && frame < range.second; });
+        (isVisible ? first : others).push_back(frame);
+    }
+    std::vector<std::vector<int>> batches;
+    for (auto *batch : {&first, &others}) {
+        if (!batch->empty()) {
+            batches.push_back(std::move(*batch));
+        }
+    }
+    return batches;
+}
+
+std::vector<std::pair<int, int>> CacheJob::visibleSourceRanges() const
+{
+    std::vector<std::pair<int, int>> ranges;
+    QPair<int, int> visible = pCore->visibleTimelineRange();
+    if (visible.second < 0) {
+        return ranges;
+    }
+    for (int cid : m_binClip->timelineInstances()) {
+        ObjectId id(ObjectType::TimelineClip, cid);
+        int position = pCore->getItemPosition(id);
+        int start = qMax(position, visible.first);
+        int end = qMin(position + pCore->getItemDuration(id), visible.second);
+        if (start < end) {
+            // Speed changes are not taken into account, this is only used to order the extraction
+            int offset = pCore->getItemIn(id) - position;
+            ranges.emplace_back(start + offset, end + offset);
+        }
+    }
+    return ranges;
+}
+
 bool CacheJob::commitResult(Fun &undo, Fun &redo)
 {
     Q_UNUSED(undo)
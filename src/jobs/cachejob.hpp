@@ -24,12 +24,17 @@
 #include "abstractclipjob.h"
 
 #include <QSemaphore>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <set>
+#include <vector>
 
 /* @brief This class represents the job that corresponds to computing the thumb of a clip
  */
 
 class ProjectClip;
+class QImage;
 namespace Mlt {
 class Producer;
 }
@@ -53,14 +58,33 @@ public:
         By design, the job should store the result of the computation but not share it with the rest of the code. This happens when we call commitResult */
     bool commitResult(Fun &undo, Fun &redo) override;
 
+    /** @brief Extracts thumbnails for the given frames, splitting the work across several producers used on separate threads.
+        Each producer gets a contiguous range of frames that it reads in increasing order, so that seeks only move forward and
+        don't restart decoding from a previous keyframe for every thumbnail.
+        @param producers independent producers of the same clip, one per worker thread
+        @param frames the frames to extract, in increasing order
+        @param fullWidth width of the thumbnails, 0 to keep the producer's width
+        @param store called from the worker threads with each extracted thumbnail
+        @param canceled polled before each frame, the extraction stops when it returns true
+    */
+    static void extractFrames(const std::vector<std::shared_ptr<Mlt::Producer>> &producers, const std::vector<int> &frames, int fullWidth,
+                              const std::function<void(int, const QImage &)> &store, const std::function<bool()> &canceled);
+
+    /** @brief Splits the frames to extract in batches processed one after the other: first the frames inside one of the @param visible
+        source ranges (as [start, end) pairs), then the others. Empty batches are skipped and each batch is in increasing order.
+    */
+    static std::vector<std::vector<int>> frameBatches(const std::set<int> &frames, const std::vector<std::pair<int, int>> &visible);
+
 private:
+    /** @brief Returns the ranges of the source clip that are currently displayed in the timeline */
+    std::vector<std::pair<int, int>> visibleSourceRanges() const;
+
     int m_fullWidth;
 
     std::shared_ptr<ProjectClip> m_binClip;
-    std::shared_ptr<Mlt::Producer> m_prod;
     QSemaphore m_semaphore;
 
-    bool m_done{false};
+    std::atomic<bool> m_done{false};
     int m_thumbsCount;
     int m_inPoint;
     int m_outPoint;
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "jobmanager.h"
+#include "jobscheduler.hpp"
 #include "bin/abstractprojectitem.h"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
@@ -37,6 +38,7 @@ int JobManager::m_currentId = 0;
 JobManager::JobManager(QObject *parent)
     : QAbstractListModel(parent)
     , m_lock(QReadWriteLock::Recursive)
+    , m_scheduler(new JobScheduler())
 {
 }
 
@@ -239,8 +241,26 @@ void JobManager::createJob(const std::shared_ptr<Job_t> &job)
     connect(&job->m_future, &QFutureWatcher<bool>::started, this, &JobManager::updateJobCount);
     connect(&job->m_future, &QFutureWatcher<bool>::finished, [this, id = job->m_id]() { if (m_jobs.count(id)> 0) slotManageFinishedJob(id); });
     connect(&job->m_future, &QFutureWatcher<bool>::canceled, [this, id = job->m_id]() { slotManageCanceledJob(id); });
-    job->m_actualFuture = QtConcurrent::mapped(job->m_job, AbstractClipJob::execute);
+    job->m_remaining = int(job->m_job.size());
+    job->m_interface.reportStarted();
+    job->m_actualFuture = job->m_interface.future();
     job->m_future.setFuture(job->m_actualFuture);
+    job->m_queueTimer.start();
+    JobScheduler::Priority priority = JobScheduler::priorityForType(job->m_type);
+    for (size_t i = 0; i < job->m_job.size(); ++i) {
+        m_scheduler->enqueue(priority, [job, i]() {
+            qint64 pending = -1;
+            job->m_waitTime.compare_exchange_strong(pending, job->m_queueTimer.elapsed());
+            bool res = false;
+            if (!job->m_interface.isCanceled()) {
+                res = AbstractClipJob::execute(job->m_job[i]);
+            }
+            job->m_interface.reportResult(res, int(i));
+            if (--job->m_remaining == 0) {
+                job->m_interface.reportFinished();
+            }
+        });
+    }
 }
 
 void JobManager::slotManageCanceledJob(int id)
@@ -345,7 +365,7 @@ void JobManager::slotManageFinishedJob(int id)
         std::vector<int> children = m_jobsByParents[id];
         for (int cid : children) {
             if (!m_jobs[cid]->m_processed) {
-                QtConcurrent::run(this, &JobManager::createJob, m_jobs[cid]);
+                createJob(m_jobs[cid]);
             }
         }
         m_jobsByParents.erase(id);
@@ -372,12 +392,17 @@ JobManagerStatus JobManager::getJobStatus(int jobId) const
     if (job->m_future.isCanceled()) {
         return JobManagerStatus::Canceled;
     }
-    if (job->m_future.isRunning()) {
+    if (job->m_future.isRunning() && job->m_waitTime >= 0) {
         return JobManagerStatus::Running;
     }
     return JobManagerStatus::Pending;
 }
 
+int JobManager::queueDepth(AbstractClipJob::JOBTYPE type) const
+{
+    return m_scheduler->queueDepth(JobScheduler::priorityForType(type));
+}
+
 bool JobManager::jobSucceded(int jobId) const
 {
     READ_LOCK();
@@ -421,10 +446,35 @@ QVariant JobManager::data(const QModelIndex &index, int role) const
     case Qt::DisplayRole:
         return QVariant(it->second->m_job.front()->getDescription());
         break;
+    case PriorityRole:
+        return int(JobScheduler::priorityForType(it->second->m_type));
+    case StatusRole:
+        return QVariant::fromValue(getJobStatus(it->first));
+    case WaitTimeRole: {
+        // While the job is pending, report the time it has spent in queue so far
+        qint64 wait = it->second->m_waitTime;
+        if (wait < 0 && it->second->m_queueTimer.isValid()) {
+            wait = it->second->m_queueTimer.elapsed();
+        }
+        return qMax(qint64(0), wait);
+    }
+    case QueueDepthRole:
+        return queueDepth(it->second->m_type);
     }
     return QVariant();
 }
 
+QHash<int, QByteArray> JobManager::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[Qt::DisplayRole] = "display";
+    roles[PriorityRole] = "priority";
+    roles[StatusRole] = "status";
+    roles[WaitTimeRole] = "waitTime";
+    roles[QueueDepthRole] = "queueDepth";
+    return roles;
+}
+
 int JobManager::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
@@ -27,15 +27,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "definitions.h"
 
 #include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QFutureInterface>
 #include <QFutureWatcher>
 #include <QObject>
 #include <QReadWriteLock>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 class AbstractClipJob;
+class JobScheduler;
 
 /**
  * @class JobManager
@@ -52,6 +56,10 @@ struct Job_t
     std::unordered_map<QString, size_t> m_indices;       // keys are binIds, value are ids in the vectors m_job and m_progress;
     QFutureWatcher<bool> m_future;                       // future of the job
     QFuture<bool> m_actualFuture;
+    QFutureInterface<bool> m_interface;                  // reports the results of the scheduled tasks to m_actualFuture
+    std::atomic<int> m_remaining{0};                     // number of clip tasks that did not complete yet
+    QElapsedTimer m_queueTimer;                          // started when the job is handed to the scheduler
+    std::atomic<qint64> m_waitTime{-1};                  // time spent in queue before the first task started, -1 while pending
     QMutex m_completionMutex; // mutex that is locked during execution of the process
     AbstractClipJob::JOBTYPE m_type;
     QString m_undoString;
@@ -69,6 +77,8 @@ public:
     explicit JobManager(QObject *parent);
     ~JobManager() override;
 
+    enum { PriorityRole = Qt::UserRole + 1, StatusRole, WaitTimeRole, QueueDepthRole };
+
     /** @brief Start a job
         This function calls the prepareJob function of the job if it provides one.
         @param T is the type of job (must inherit from AbstractClipJob)
@@ -118,6 +128,9 @@ public:
     /** @brief return the type of a given job */
     JobManagerStatus getJobStatus(int jobId) const;
 
+    /** @brief return the number of tasks waiting in the scheduler queue of the given job type's priority class */
+    int queueDepth(AbstractClipJob::JOBTYPE type) const;
+
     /** @brief returns false if job failed */
     bool jobSucceded(int jobId) const;
 
@@ -130,10 +143,11 @@ public:
     // Mandatory overloads
     QVariant data(const QModelIndex &index, int role) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QHash<int, QByteArray> roleNames() const override;
 
 protected:
     // Helper function to launch a given job.
-    // This has to be launched asynchrnously since it blocks until all parents are finished
+    // Its parents must be finished: the clip tasks are queued on the scheduler right away
     void createJob(const std::shared_ptr<Job_t> &job);
 
     void updateJobCount();
@@ -159,6 +173,8 @@ private:
     /** @brief List of all the jobs by clip. */
     std::unordered_map<QString, std::vector<int>> m_jobsByClip;
     std::unordered_map<int, std::vector<int>> m_jobsByParents;
+    /** @brief Dispatches the clip tasks by priority class on a dedicated thread pool */
+    std::unique_ptr<JobScheduler> m_scheduler;
 
 signals:
     void jobCount(int);
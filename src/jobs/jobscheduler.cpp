@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "jobscheduler.hpp"
+
+#include <QMutexLocker>
+#include <QRunnable>
+
+class JobScheduler::Runner : public QRunnable
+{
+public:
+    Runner(JobScheduler *scheduler, Priority priority, std::function<void()> task)
+        : m_scheduler(scheduler)
+        , m_priority(priority)
+        , m_task(std::move(task))
+    {
+    }
+
+    void run() override
+    {
+        m_task();
+        m_scheduler->taskFinished(m_priority);
+    }
+
+private:
+    JobScheduler *m_scheduler;
+    Priority m_priority;
+    std::function<void()> m_task;
+};
+
+JobScheduler::JobScheduler(int maxThreads)
+    : m_maxThreads(qMax(2, maxThreads))
+{
+    m_pool.setMaxThreadCount(m_maxThreads);
+    // Thumbnails can use the whole pool, long running jobs are restricted so that they never starve the interactive ones
+    m_caps[ThumbPriority] = m_maxThreads;
+    m_caps[AudioThumbPriority] = qMax(1, m_maxThreads / 2);
+    m_caps[LoadPriority] = m_maxThreads;
+    m_caps[ProcessingPriority] = qMax(1, m_maxThreads / 2);
+    m_caps[TranscodePriority] = qMax(1, m_maxThreads / 4);
+}
+
+JobScheduler::~JobScheduler()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto &queue : m_queues) {
+            queue.clear();
+        }
+    }
+    m_pool.waitForDone();
+}
+
+// static
+JobScheduler::Priority JobScheduler::priorityForType(AbstractClipJob::JOBTYPE type)
+{
+    switch (type) {
+    case AbstractClipJob::THUMBJOB:
+    case AbstractClipJob::CACHEJOB:
+        return ThumbPriority;
+    case AbstractClipJob::AUDIOTHUMBJOB:
+        return AudioThumbPriority;
+    case AbstractClipJob::LOADJOB:
+        return LoadPriority;
+    case AbstractClipJob::FILTERCLIPJOB:
+    case AbstractClipJob::ANALYSECLIPJOB:
+        return ProcessingPriority;
+    default:
+        return TranscodePriority;
+    }
+}
+
+void JobScheduler::enqueue(Priority priority, std::function<void()> task)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        Task t;
+        t.run = std::move(task);
+        t.queued.start();
+        m_queues[priority].push_back(std::move(t));
+    }
+    dispatch();
+}
+
+void JobScheduler::dispatch()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_running < m_maxThreads) {
+        int selected = -1;
+        for (int p = 0; p < PriorityCount; ++p) {
+            if (!m_queues[p].empty() && m_runningByClass[p] < m_caps[p]) {
+                selected = p;
+                break;
+            }
+        }
+        if (selected == -1) {
+            return;
+        }
+        Task task = std::move(m_queues[selected].front());
+        m_queues[selected].pop_front();
+        m_totalWait[selected] += task.queued.elapsed();
+        m_startedCount[selected]++;
+        m_runningByClass[selected]++;
+        m_running++;
+        // We never start more runners than threads, so the pool's own queue stays empty and priority is decided here
+        m_pool.start(new Runner(this, Priority(selected), std::move(task.run)));
+    }
+}
+
+void JobScheduler::taskFinished(Priority priority)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_runningByClass[priority]--;
+        m_running--;
+    }
+    dispatch();
+}
+
+int JobScheduler::queueDepth(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return (int)m_queues[priority].size();
+}
+
+int JobScheduler::runningCount(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_runningByClass[priority];
+}
+
+qint64 JobScheduler::averageWaitTime(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_startedCount[priority] > 0 ? m_totalWait[priority] / m_startedCount[priority] : 0;
+}
+
+void JobScheduler::waitForDone()
+{
+    m_pool.waitForDone();
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "abstractclipjob.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <array>
+#include <deque>
+#include <functional>
+
+/** @brief This class dispatches the clip jobs on a dedicated thread pool.
+    Tasks are queued by priority class, and a task is only handed to a thread when one is free, so that a queued thumbnail always starts
+    before any queued transcode. Each class also has a cap on the number of threads it can use at the same time, so that long jobs
+    (proxies, transcodes) can never occupy the whole pool. Whenever a task finishes, the freed thread picks the most urgent runnable
+    task of any class, so idle threads take over work from saturated classes.
+ */
+class JobScheduler
+{
+public:
+    /** @brief Priority classes, from the most to the least urgent */
+    enum Priority { ThumbPriority = 0, AudioThumbPriority, LoadPriority, ProcessingPriority, TranscodePriority, PriorityCount };
+
+    explicit JobScheduler(int maxThreads = QThread::idealThreadCount());
+    ~JobScheduler();
+
+    /** @brief Returns the priority class of a given job type */
+    static Priority priorityForType(AbstractClipJob::JOBTYPE type);
+
+    /** @brief Queues a task, to be executed on the pool as soon as a thread is available for its class */
+    void enqueue(Priority priority, std::function<void()> task);
+
+    /** @brief Returns the number of queued (not yet running) tasks of a class */
+    int queueDepth(Priority priority) const;
+    /** @brief Returns the number of running tasks of a class */
+    int runningCount(Priority priority) const;
+    /** @brief Returns the average time spent in queue by the tasks of a class that already started, in milliseconds */
+    qint64 averageWaitTime(Priority priority) const;
+
+    /** @brief Waits until all queued and running tasks are done */
+    void waitForDone();
+
+private:
+    struct Task
+    {
+        std::function<void()> run;
+        QElapsedTimer queued;
+    };
+    class Runner;
+
+    /** @brief Starts as many queued tasks as the free threads and class caps allow */
+    void dispatch();
+    void taskFinished(Priority priority);
+
+    mutable QMutex m_mutex;
+    QThreadPool m_pool;
+    int m_maxThreads;
+    int m_running{0};
+    std::array<std::deque<Task>, PriorityCount> m_queues;
+    std::array<int, PriorityCount> m_runningByClass{};
+    std::array<int, PriorityCount> m_caps{};
+    std::array<qint64, PriorityCount> m_totalWait{};
+    std::array<qint64, PriorityCount> m_startedCount{};
+};
@@ -31,6 +31,7 @@
 #include "macros.hpp"
 #include "profiles/profilemodel.hpp"
 #include "project/dialogs/slideshowclip.h"
+#include "utils/filehashindex.hpp"
 #include "effects/effectsrepository.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
 #include "monitor/monitor.h"
@@ -412,6 +413,19 @@ bool LoadJob::startJob()
         return false;
     }
     processProducerProperties(m_producer, m_xml);
+    const QString fileHash = Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:file_hash"));
+    if (fileHash.isEmpty() &&
+        (type == ClipType::AV || type == ClipType::Audio || type == ClipType::Video || type == ClipType::Image || type == ClipType::Playlist)) {
+        // Hash the source file on this thread, so that the bin clip finds it in the index. Clips loaded from a project already have their hash
+        QString hashedPath = Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:originalurl"));
+        if (hashedPath.isEmpty()) {
+            hashedPath = m_resource;
+        }
+        if (QFileInfo(hashedPath).isRelative()) {
+            hashedPath.prepend(pCore->currentDoc()->documentRoot());
+        }
+        FileHashIndex::get()->fileHash(QFileInfo(hashedPath).absoluteFilePath(), FileHashIndex::algorithmFor());
+    }
     QString clipName = Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:clipname"));
     if (clipName.isEmpty()) {
         clipName = QFileInfo(Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:originalurl"))).fileName();
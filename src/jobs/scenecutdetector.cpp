@@ -0,0 +1,263 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scenecutdetector.hpp"
+
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
+#include <cstdlib>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+
+#if defined(__SSE2__) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#define SCENECUT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+// A cut must be this many times above the average difference of the previous frames
+const double motionRatio = 3.;
+// Mean block difference, in luma levels, that counts as a complete change of picture
+const double maxBlockDifference = 64.;
+// Don't start a segment for less than this number of frames
+const int minFramesPerSegment = 100;
+
+const int blockColumns = SceneCutDetector::Width / SceneCutDetector::BlockSize;
+} // namespace
+
+SceneCutDetector::SceneCutDetector(double threshold)
+    : m_threshold(threshold)
+{
+}
+
+void SceneCutDetector::lumaFromYuv422(const uchar *yuv, int count, uchar *luma)
+{
+    int i = 0;
+#ifdef SCENECUT_SSE2
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    for (; i + 16 <= count; i += 16) {
+        // Y0 U0 Y1 V0 ..., keep the even bytes
+        __m128i lo = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(yuv + 2 * i)), mask);
+        __m128i hi = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(yuv + 2 * i + 16)), mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(luma + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < count; ++i) {
+        luma[i] = yuv[2 * i];
+    }
+}
+
+void SceneCutDetector::signature(const uchar *luma, Signature &sig)
+{
+    // Interleaved partial histograms avoid stalling on consecutive pixels of the same bin
+    std::array<std::array<int, HistogramBins>, 4> partial{};
+    const int count = Width * Height;
+    for (int i = 0; i < count; i += 4) {
+        partial[0][luma[i] >> 2]++;
+        partial[1][luma[i + 1] >> 2]++;
+        partial[2][luma[i + 2] >> 2]++;
+        partial[3][luma[i + 3] >> 2]++;
+    }
+    for (int bin = 0; bin < HistogramBins; ++bin) {
+        sig.histogram[(size_t)bin] = partial[0][(size_t)bin] + partial[1][(size_t)bin] + partial[2][(size_t)bin] + partial[3][(size_t)bin];
+    }
+    std::array<int, blockColumns> sums;
+    for (int blockRow = 0; blockRow < Height / BlockSize; ++blockRow) {
+        sums.fill(0);
+        for (int y = blockRow * BlockSize; y < (blockRow + 1) * BlockSize; ++y) {
+            const uchar *row = luma + y * Width;
+            int x = 0;
+#ifdef SCENECUT_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; x + 16 <= Width; x += 16) {
+                // Sums of the two halves, that is of a row of two adjacent blocks
+                __m128i sad = _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x)), zero);
+                sums[size_t(x / BlockSize)] += _mm_cvtsi128_si32(sad);
+                sums[size_t(x / BlockSize + 1)] += _mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+            }
+#endif
+            for (; x < Width; ++x) {
+                sums[size_t(x / BlockSize)] += row[x];
+            }
+        }
+        for (int column = 0; column < blockColumns; ++column) {
+            sig.blocks[size_t(blockRow * blockColumns + column)] = uchar(sums[(size_t)column] / (BlockSize * BlockSize));
+        }
+    }
+}
+
+double SceneCutDetector::difference(const Signature &a, const Signature &b)
+{
+    int histogramDiff = 0;
+    int blockDiff = 0;
+    size_t i = 0;
+#ifdef SCENECUT_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 4 <= a.histogram.size(); i += 4) {
+        __m128i d = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a.histogram.data() + i)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.histogram.data() + i)));
+        __m128i sign = _mm_srai_epi32(d, 31);
+        acc = _mm_add_epi32(acc, _mm_sub_epi32(_mm_xor_si128(d, sign), sign));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    histogramDiff = _mm_cvtsi128_si32(acc);
+#endif
+    for (; i < a.histogram.size(); ++i) {
+        histogramDiff += std::abs(a.histogram[i] - b.histogram[i]);
+    }
+    i = 0;
+#ifdef SCENECUT_SSE2
+    __m128i sad = _mm_setzero_si128();
+    for (; i + 16 <= a.blocks.size(); i += 16) {
+        sad = _mm_add_epi64(sad, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a.blocks.data() + i)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.blocks.data() + i))));
+    }
+    blockDiff = _mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+#endif
+    for (; i < a.blocks.size(); ++i) {
+        blockDiff += std::abs(a.blocks[i] - b.blocks[i]);
+    }
+    // Each pixel moved to another bin is counted twice
+    double histogramScore = histogramDiff / (2. * Width * Height);
+    double blockScore = qMin(1., blockDiff / (maxBlockDifference * a.blocks.size()));
+    return (histogramScore + blockScore) / 2.;
+}
+
+void SceneCutDetector::detectSegment(const Reader &reader, int first, int last, const std::function<bool()> &canceled,
+                                     const std::function<void()> &frameRead, std::vector<int> &cuts) const
+{
+    // Start early enough to know the previous frame and the differences averaged for the first position
+    const int start = qMax(0, first - Window - 1);
+    std::vector<uchar> luma((size_t)(Width * Height));
+    Signature previous, current;
+    bool hasPrevious = false;
+    std::array<double, Window> history{};
+    int historyCount = 0;
+    int historyIndex = 0;
+    for (int position = start; position < last; ++position) {
+        if (canceled()) {
+            break;
+        }
+        bool valid = reader(position, luma.data());
+        frameRead();
+        if (!valid) {
+            continue;
+        }
+        signature(luma.data(), current);
+        if (hasPrevious) {
+            double diff = difference(previous, current);
+            // Sum in chronological order, so that all segments get the exact same values
+            double average = 0.;
+            for (int i = 0; i < historyCount; ++i) {
+                average += history[size_t((historyIndex + Window - historyCount + i) % Window)];
+            }
+            if (historyCount > 0) {
+                average /= historyCount;
+            }
+            if (position >= first && diff >= m_threshold && diff >= motionRatio * average) {
+                cuts.push_back(position);
+            }
+            history[(size_t)historyIndex] = diff;
+            historyIndex = (historyIndex + 1) % Window;
+            historyCount = qMin(historyCount + 1, (int)Window);
+        }
+        std::swap(previous, current);
+        hasPrevious = true;
+    }
+}
+
+std::vector<int> SceneCutDetector::detect(const std::vector<Reader> &readers, int length, const std::function<bool()> &canceled,
+                                          const std::function<void(int)> &progress) const
+{
+    if (readers.empty() || length <= 0) {
+        return {};
+    }
+    const int workers = qBound(1, length / minFramesPerSegment, (int)readers.size());
+    std::vector<std::vector<int>> cuts((size_t)workers);
+    std::atomic<int> framesRead{0};
+    auto frameRead = [&]() {
+        int count = ++framesRead;
+        if (progress) {
+            progress(count);
+        }
+    };
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, workers - 1));
+    QList<QFuture<void>> futures;
+    for (int w = 1; w < workers; ++w) {
+        int first = int((qint64)length * w / workers);
+        int last = int((qint64)length * (w + 1) / workers);
+        futures << QtConcurrent::run(&pool, [&, w, first, last]() { detectSegment(readers[(size_t)w], first, last, canceled, frameRead, cuts[(size_t)w]); });
+    }
+    // The first segment is processed in the calling thread
+    detectSegment(readers.front(), 0, length / workers, canceled, frameRead, cuts.front());
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+    // Segments are contiguous and their cuts sorted, so merging is a concatenation
+    std::vector<int> result;
+    for (const auto &segment : cuts) {
+        result.insert(result.end(), segment.begin(), segment.end());
+    }
+    return result;
+}
+
+std::vector<int> SceneCutDetector::detect(const std::vector<std::shared_ptr<Mlt::Producer>> &producers, int length, const std::function<bool()> &canceled,
+                                          const std::function<void(int)> &progress) const
+{
+    std::vector<Reader> readers;
+    for (const auto &prod : producers) {
+        readers.push_back([prod](int position, uchar *luma) {
+            prod->seek(position);
+            QScopedPointer<Mlt::Frame> frame(prod->get_frame());
+            if (frame == nullptr || !frame->is_valid()) {
+                return false;
+            }
+            // We only compare pictures, use the fastest methods
+            frame->set("deinterlace_method", "onefield");
+            frame->set("top_field_first", -1);
+            frame->set("rescale.interp", "nearest");
+            mlt_image_format format = mlt_image_yuv422;
+            int width = Width;
+            int height = Height;
+            const uchar *image = frame->get_image(format, width, height);
+            if (image == nullptr || format != mlt_image_yuv422 || width <= 0 || height <= 0) {
+                return false;
+            }
+            if (width == Width && height == Height) {
+                lumaFromYuv422(image, Width * Height, luma);
+                return true;
+            }
+            // The producer did not scale, pick the nearest pixels
+            for (int y = 0; y < Height; ++y) {
+                const uchar *row = image + (y * height / Height) * width * 2;
+                for (int x = 0; x < Width; ++x) {
+                    luma[y * Width + x] = row[(x * width / Width) * 2];
+                }
+            }
+            return true;
+        });
+    }
+    return detect(readers, length, canceled, progress);
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace Mlt {
+class Producer;
+}
+
+/**
+ * @class SceneCutDetector
+ * @brief Finds the shot boundaries of a clip from downscaled luma frames
+ *
+ * Each frame is reduced to a signature: a 64 bins luma histogram and the mean luma
+ * of 8x8 pixel blocks. Consecutive signatures are compared, and a cut is reported
+ * when the difference is above an absolute threshold and clearly above the average
+ * difference of the previous frames, so that fast motion does not look like a cut.
+ *
+ * The clip is split in segments that are scanned in parallel, each with its own
+ * frame reader. A segment starts reading a few frames before its first position,
+ * so that its boundaries at the segment edges are exactly those of a single pass.
+ */
+class SceneCutDetector
+{
+public:
+    /** @brief Size of the luma frames given to the detector */
+    static const int Width = 128;
+    static const int Height = 72;
+    static const int BlockSize = 8;
+    static const int HistogramBins = 64;
+    /** @brief Number of previous frame differences averaged to get the adaptive threshold */
+    static const int Window = 8;
+
+    struct Signature
+    {
+        std::array<int, HistogramBins> histogram;
+        std::array<uchar, (Width / BlockSize) * (Height / BlockSize)> blocks;
+    };
+
+    /** @brief Fills @param luma with the luma plane of a Width x Height frame, returns false if the frame could not be read */
+    using Reader = std::function<bool(int position, uchar *luma)>;
+
+    /** @param threshold minimum difference between two frames, between 0 and 1, to report a cut */
+    explicit SceneCutDetector(double threshold = 0.3);
+
+    /** @brief Returns the positions in [0, length) that start a new scene, in increasing order.
+        @param readers independent frame readers of the same clip, one per worker thread
+        @param canceled polled before each frame, the detection stops when it returns true
+        @param progress called from the worker threads with the number of frames read so far
+    */
+    std::vector<int> detect(const std::vector<Reader> &readers, int length, const std::function<bool()> &canceled,
+                            const std::function<void(int)> &progress = nullptr) const;
+
+    /** @brief Same as above, reading the frames from independent producers of the same clip */
+    std::vector<int> detect(const std::vector<std::shared_ptr<Mlt::Producer>> &producers, int length, const std::function<bool()> &canceled,
+                            const std::function<void(int)> &progress = nullptr) const;
+
+    /** @brief Computes the signature of a Width x Height luma frame */
+    static void signature(const uchar *luma, Signature &sig);
+
+    /** @brief Difference of two frames, between 0 (identical) and 1 */
+    static double difference(const Signature &a, const Signature &b);
+
+    /** @brief Extracts the luma of @param count packed yuv422 pixels */
+    static void lumaFromYuv422(const uchar *yuv, int count, uchar *luma);
+
+private:
+    /** @brief Scans [first, last), appending the found cuts */
+    void detectSegment(const Reader &reader, int first, int last, const std::function<bool()> &canceled, const std::function<void()> &frameRead,
+                       std::vector<int> &cuts) const;
+
+    double m_threshold;
+};
@@ -30,54 +30,67 @@
 #include "core.h"
 #include "jobmanager.h"
 #include "kdenlivesettings.h"
-#include "project/clipstabilize.h"
+#include "scenecutdetector.hpp"
 #include "ui_scenecutdialog_ui.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QScopedPointer>
+#include <klocalizedstring.h>
 
 #include <mlt++/Mlt.h>
 
 SceneSplitJob::SceneSplitJob(const QString &binId, bool subClips, int markersType, int minInterval)
-    : MeltJob(binId, STABILIZEJOB, true, -1, -1)
+    : AbstractClipJob(STABILIZEJOB, binId)
     , m_subClips(subClips)
     , m_markersType(markersType)
     , m_minInterval(minInterval)
 {
+    connect(this, &SceneSplitJob::jobCanceled, [&]() {
+        m_successful = false;
+        m_done = true;
+    });
 }
 
 const QString SceneSplitJob::getDescription() const
 {
     return i18n("Scene split");
 }
-void SceneSplitJob::configureConsumer()
-{
-    m_consumer = std::make_unique<Mlt::Consumer>(*m_profile.get(), "null");
-    m_consumer->set("all", 1);
-    m_consumer->set("terminate_on_pause", 1);
-    m_consumer->set("real_time", -KdenliveSettings::mltthreads());
-    // We just want to find scene change, set all methods to the fastests
-    m_consumer->set("rescale", "nearest");
-    m_consumer->set("deinterlace_method", "onefield");
-    m_consumer->set("top_field_first", -1);
-}
 
-void SceneSplitJob::configureFilter()
+bool SceneSplitJob::startJob()
 {
-    m_filter = std::make_unique<Mlt::Filter>(*m_profile.get(), "motion_est");
-    if ((m_filter == nullptr) || !m_filter->is_valid()) {
-        m_errorMessage.append(i18n("Cannot create filter motion_est. Cannot split scenes"));
-        return;
+    auto binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+    if (binClip == nullptr) {
+        m_errorMessage.append(i18n("Invalid clip"));
+        m_done = true;
+        return false;
     }
-
-    m_filter->set("shot_change_list", 0);
-    m_filter->set("denoise", 0);
-    m_filter->set_in_and_out(0, length - 1);
-}
-
-void SceneSplitJob::configureProfile()
-{
-    m_profile->set_height(160);
-    m_profile->set_width(m_profile->height() * m_profile->sar());
+    m_length = (int)binClip->frameDuration();
+    // Each worker reads its own segment of the clip, with a dedicated low resolution producer
+    int workers = maxClipWorkers();
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    for (int i = 0; i < workers; ++i) {
+        std::shared_ptr<Mlt::Producer> prod = binClip->createThumbProducer();
+        if (prod == nullptr || !prod->is_valid()) {
+            break;
+        }
+        producers.push_back(prod);
+    }
+    if (producers.empty() || m_length <= 0) {
+        m_errorMessage.append(i18n("No producer for this clip."));
+        m_done = true;
+        return false;
+    }
+    SceneCutDetector detector;
+    m_cuts = detector.detect(producers, m_length, [&]() { return m_done.load(); },
+                             [&](int frames) { emit jobProgress(100 * qMin(frames, m_length) / m_length); });
+    if (m_done) {
+        // Job aborted
+        return false;
+    }
+    m_successful = m_done = true;
+    return true;
 }
 
 // static
@@ -118,21 +131,18 @@ bool SceneSplitJob::commitResult(Fun &undo, Fun &redo)
     if (!m_successful) {
         return false;
     }
-    QString result = QString::fromLatin1(m_filter->get("shot_change_list"));
-    if (result.isEmpty()) {
-        m_errorMessage.append(i18n("No data returned from clip analysis"));
+    if (m_cuts.empty()) {
+        m_errorMessage.append(i18n("No scene change found in clip"));
         return false;
     }
 
     auto binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
-    QStringList markerData = result.split(QLatin1Char(';'));
     if (m_markersType >= 0) {
         // Build json data for markers
         QJsonArray list;
         int ix = 1;
         int lastCut = 0;
-        for (const QString &marker : markerData) {
-            int pos = marker.section(QLatin1Char('='), 0, 0).toInt();
+        for (int pos : m_cuts) {
             if (m_minInterval > 0 && ix > 1 && pos - lastCut < m_minInterval) {
                 continue;
             }
@@ -151,11 +161,11 @@ bool SceneSplitJob::commitResult(Fun &undo, Fun &redo)
         // Create zones
         int ix = 1;
         int lastCut = 0;
-        QMap<QString, QString> zoneData;
         QJsonArray list;
-        QJsonDocument json(list);
-        for (const QString &marker : markerData) {
-            int pos = marker.section(QLatin1Char('='), 0, 0).toInt();
+        std::vector<int> cuts = m_cuts;
+        // The last scene ends with the clip
+        cuts.push_back(m_length);
+        for (int pos : cuts) {
             if (pos <= lastCut + 1 || pos - lastCut < m_minInterval) {
                 continue;
             }
@@ -167,12 +177,12 @@ bool SceneSplitJob::commitResult(Fun &undo, Fun &redo)
             lastCut = pos;
             ix++;
         }
-        if (!json.isEmpty()) {
+        if (!list.isEmpty()) {
+            QJsonDocument json(list);
             pCore->projectItemModel()->loadSubClips(m_clipId, QString(json.toJson()), undo, redo);
         }
     }
-    qDebug() << "RESULT of the SCENESPLIT filter:" << result;
+    qDebug() << "RESULT of the SCENESPLIT detection:" << m_cuts.size() << "cuts";
 
-    // TODO refac: reimplement add markers and subclips
     return true;
 }
@@ -23,18 +23,18 @@
 
 #pragma once
 
-#include "meltjob.h"
-#include <unordered_map>
-#include <unordered_set>
+#include "abstractclipjob.h"
+#include <atomic>
+#include <vector>
 
 /**
  * @class SceneSplitJob
- * @brief Detects the scenes of a clip using a mlt filter
+ * @brief Detects the scenes of a clip with a SceneCutDetector
  *
  */
 
 class JobManager;
-class SceneSplitJob : public MeltJob
+class SceneSplitJob : public AbstractClipJob
 {
     Q_OBJECT
 
@@ -50,21 +50,18 @@ public:
     // Then the job is automatically put in queue. Its id is returned
     static int prepareJob(const std::shared_ptr<JobManager> &ptr, const std::vector<QString> &binIds, int parentId, QString undoString);
 
+    bool startJob() override;
     bool commitResult(Fun &undo, Fun &redo) override;
     const QString getDescription() const override;
 
 protected:
-    // @brief create and configure consumer
-    void configureConsumer() override;
-
-    // @brief create and configure filter
-    void configureFilter() override;
-
-    // @brief extra configuration of the profile (eg: resize the profile)
-    void configureProfile() override;
-
     bool m_subClips;
     int m_markersType;
     // @brief minimum scene duration.
     int m_minInterval;
+    // @brief first frame of each detected scene, except the first one
+    std::vector<int> m_cuts;
+    int m_length{0};
+    std::atomic<bool> m_done{false};
+    bool m_successful{false};
 };
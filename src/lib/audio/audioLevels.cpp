@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "audioLevels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+AudioLevelReducer::AudioLevelReducer(int channels, int frequency, double fps, int binsPerFrame)
+    : m_channels(qMax(1, channels))
+    , m_binsPerFrame(qMax(1, binsPerFrame))
+    , m_samplesPerBin((fps > 0 ? frequency / fps : frequency) / m_binsPerFrame)
+    , m_binMinimums((size_t)m_channels, 0)
+    , m_binMaximums((size_t)m_channels, 0)
+    , m_binSquares((size_t)m_channels, 0.)
+{
+    m_binEnd = qMax(qint64(1), qint64(std::llround(m_samplesPerBin)));
+}
+
+void AudioLevelReducer::accumulate(const qint16 *data, int sampleCount, int channels, qint16 *minimums, qint16 *maximums, double *squares)
+{
+    int i = 0;
+    const int total = sampleCount * channels;
+#ifdef __SSE2__
+    // With 1, 2 or 4 channels, lane n of a vector always holds channel n % channels
+    if (channels == 1 || channels == 2 || channels == 4) {
+        __m128i low = _mm_setzero_si128();
+        __m128i high = _mm_setzero_si128();
+        __m128 sqLow = _mm_setzero_ps();
+        __m128 sqHigh = _mm_setzero_ps();
+        for (; i + 8 <= total; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            low = _mm_min_epi16(low, v);
+            high = _mm_max_epi16(high, v);
+            __m128i lo = _mm_mullo_epi16(v, v);
+            __m128i hi = _mm_mulhi_epi16(v, v);
+            sqLow = _mm_add_ps(sqLow, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, hi)));
+            sqHigh = _mm_add_ps(sqHigh, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, hi)));
+        }
+        alignas(16) qint16 lowLanes[8];
+        alignas(16) qint16 highLanes[8];
+        alignas(16) float squareLanes[8];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lowLanes), low);
+        _mm_store_si128(reinterpret_cast<__m128i *>(highLanes), high);
+        _mm_store_ps(squareLanes, sqLow);
+        _mm_store_ps(squareLanes + 4, sqHigh);
+        for (int lane = 0; lane < 8; ++lane) {
+            int ch = lane % channels;
+            minimums[ch] = qMin(minimums[ch], lowLanes[lane]);
+            maximums[ch] = qMax(maximums[ch], highLanes[lane]);
+            squares[ch] += squareLanes[lane];
+        }
+    }
+#endif
+    for (; i < total; ++i) {
+        int ch = i % channels;
+        qint16 v = data[i];
+        minimums[ch] = qMin(minimums[ch], v);
+        maximums[ch] = qMax(maximums[ch], v);
+        squares[ch] += double(v) * v;
+    }
+}
+
+void AudioLevelReducer::process(const qint16 *data, int sampleCount)
+{
+    while (sampleCount > 0) {
+        int chunk = (int)qMin(qint64(sampleCount), m_binEnd - m_consumed);
+        accumulate(data, chunk, m_channels, m_binMinimums.data(), m_binMaximums.data(), m_binSquares.data());
+        data += chunk * m_channels;
+        sampleCount -= chunk;
+        m_consumed += chunk;
+        if (m_consumed == m_binEnd) {
+            closeBin();
+        }
+    }
+}
+
+void AudioLevelReducer::closeBin()
+{
+    qint64 count = m_consumed - m_binStart;
+    if (count <= 0) {
+        return;
+    }
+    for (int ch = 0; ch < m_channels; ++ch) {
+        m_minimums.push_back(m_binMinimums[(size_t)ch]);
+        m_maximums.push_back(m_binMaximums[(size_t)ch]);
+        m_rms.push_back((float)std::sqrt(m_binSquares[(size_t)ch] / count));
+    }
+    std::fill(m_binMinimums.begin(), m_binMinimums.end(), 0);
+    std::fill(m_binMaximums.begin(), m_binMaximums.end(), 0);
+    std::fill(m_binSquares.begin(), m_binSquares.end(), 0.);
+    m_binStart = m_consumed;
+    // Bin boundaries are computed from the bin index to avoid drifting with fractional sample counts
+    m_binEnd = qMax(m_consumed + 1, qint64(std::llround((binCount() + 1) * m_samplesPerBin)));
+}
+
+void AudioLevelReducer::finish()
+{
+    closeBin();
+}
+
+int AudioLevelReducer::channels() const
+{
+    return m_channels;
+}
+
+int AudioLevelReducer::binsPerFrame() const
+{
+    return m_binsPerFrame;
+}
+
+qint64 AudioLevelReducer::samplesConsumed() const
+{
+    return m_consumed;
+}
+
+int AudioLevelReducer::binCount() const
+{
+    return int(m_minimums.size() / (size_t)m_channels);
+}
+
+const std::vector<qint16> &AudioLevelReducer::minimums() const
+{
+    return m_minimums;
+}
+
+const std::vector<qint16> &AudioLevelReducer::maximums() const
+{
+    return m_maximums;
+}
+
+const std::vector<float> &AudioLevelReducer::rms() const
+{
+    return m_rms;
+}
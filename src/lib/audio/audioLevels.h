@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef AUDIOLEVELS_H
+#define AUDIOLEVELS_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+  Reduces a stream of interleaved signed 16 bit PCM samples to the
+  minimum, maximum and RMS values per channel, over bins of a fixed
+  fraction of a video frame.
+  Samples can be pushed in blocks of any size, only the reduced
+  levels are kept in memory.
+  */
+class AudioLevelReducer
+{
+public:
+    AudioLevelReducer(int channels, int frequency, double fps, int binsPerFrame = 1);
+
+    /** @brief Processes @param sampleCount samples per channel, interleaved in @param data */
+    void process(const qint16 *data, int sampleCount);
+    /** @brief Flushes the last, incomplete frame */
+    void finish();
+
+    int channels() const;
+    /** @brief Number of samples per channel consumed so far */
+    qint64 samplesConsumed() const;
+    int binsPerFrame() const;
+    /** @brief Number of bins reduced so far */
+    int binCount() const;
+    /** @brief Minimum sample values, bin by bin with one entry per channel */
+    const std::vector<qint16> &minimums() const;
+    /** @brief Maximum sample values, in the same layout as minimums() */
+    const std::vector<qint16> &maximums() const;
+    /** @brief RMS levels, in the same layout as minimums() */
+    const std::vector<float> &rms() const;
+
+    /** @brief Accumulates the extrema and the sum of squares of @param sampleCount interleaved samples, per channel */
+    static void accumulate(const qint16 *data, int sampleCount, int channels, qint16 *minimums, qint16 *maximums, double *squares);
+
+private:
+    int m_channels;
+    int m_binsPerFrame;
+    double m_samplesPerBin;
+    qint64 m_consumed{0};
+    qint64 m_binStart{0};
+    qint64 m_binEnd;
+    std::vector<qint16> m_binMinimums;
+    std::vector<qint16> m_binMaximums;
+    std::vector<double> m_binSquares;
+    std::vector<qint16> m_minimums;
+    std::vector<qint16> m_maximums;
+    std::vector<float> m_rms;
+
+    void closeBin();
+};
+
+#endif // AUDIOLEVELS_H
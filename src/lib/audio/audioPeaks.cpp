@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "audioPeaks.h"
+
+#include <QImage>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+static const char peakMagic[] = "KDENPKS1";
+static const int headerSize = 32;
+static const int levelEntrySize = 16;
+// Stop adding levels when they get smaller than this
+static const int minLevelBins = 64;
+
+std::shared_ptr<const AudioPeakFile> AudioPeakFile::open(const QString &path)
+{
+    std::shared_ptr<AudioPeakFile> peaks(new AudioPeakFile());
+    peaks->m_file.setFileName(path);
+    if (!peaks->m_file.open(QIODevice::ReadOnly) || peaks->m_file.size() < headerSize) {
+        return nullptr;
+    }
+    const qint64 size = peaks->m_file.size();
+    peaks->m_map = peaks->m_file.map(0, size);
+    if (peaks->m_map == nullptr || memcmp(peaks->m_map, peakMagic, 8) != 0) {
+        return nullptr;
+    }
+    const uchar *header = peaks->m_map + 8;
+    peaks->m_channels = (int)qFromLittleEndian<quint32>(header);
+    peaks->m_frameCount = (int)qFromLittleEndian<quint32>(header + 4);
+    int binsPerFrame = (int)qFromLittleEndian<quint32>(header + 8);
+    int levels = (int)qFromLittleEndian<quint32>(header + 12);
+    peaks->m_maxLevel = qMax(1, (int)qFromLittleEndian<quint32>(header + 16));
+    if (peaks->m_channels <= 0 || binsPerFrame <= 0 || levels <= 0 || size < headerSize + levels * levelEntrySize) {
+        return nullptr;
+    }
+    for (int i = 0; i < levels; ++i) {
+        const uchar *entry = peaks->m_map + headerSize + i * levelEntrySize;
+        quint64 offset = qFromLittleEndian<quint64>(entry);
+        quint64 bins = qFromLittleEndian<quint64>(entry + 8);
+        if (offset + bins * 2 * quint64(peaks->m_channels) > quint64(size)) {
+            // Truncated file
+            return nullptr;
+        }
+        Level level;
+        level.data = reinterpret_cast<const qint8 *>(peaks->m_map + offset);
+        level.binCount = int(bins);
+        level.framesPerBin = double(1 << i) / binsPerFrame;
+        peaks->m_levels.push_back(level);
+    }
+    return peaks;
+}
+
+AudioPeakFile::~AudioPeakFile()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+}
+
+bool AudioPeakFile::write(const QString &path, int channels, int binsPerFrame, const std::vector<qint16> &minimums, const std::vector<qint16> &maximums)
+{
+    if (channels <= 0 || binsPerFrame <= 0 || minimums.empty() || minimums.size() != maximums.size()) {
+        return false;
+    }
+    // Level 0, samples are stored on 8 bits
+    std::vector<std::vector<qint8>> levels(1);
+    levels[0].resize(minimums.size() * 2);
+    int maxLevel = 1;
+    for (size_t i = 0; i < minimums.size(); ++i) {
+        qint8 low = qint8(minimums[i] >> 8);
+        qint8 high = qint8(maximums[i] >> 8);
+        levels[0][2 * i] = low;
+        levels[0][2 * i + 1] = high;
+        maxLevel = qMax(maxLevel, qMax(-int(low), int(high)));
+    }
+    maxLevel = qMin(127, maxLevel);
+    // Each level merges pairs of bins of the previous one
+    const size_t stride = 2 * size_t(channels);
+    while (levels.back().size() / stride > minLevelBins && levels.size() < 16) {
+        const std::vector<qint8> &previous = levels.back();
+        size_t bins = previous.size() / stride;
+        std::vector<qint8> next(((bins + 1) / 2) * stride);
+        for (size_t b = 0; b < bins; b += 2) {
+            const qint8 *first = previous.data() + b * stride;
+            const qint8 *second = b + 1 < bins ? first + stride : first;
+            qint8 *target = next.data() + (b / 2) * stride;
+            for (size_t k = 0; k < stride; k += 2) {
+                target[k] = qMin(first[k], second[k]);
+                target[k + 1] = qMax(first[k + 1], second[k + 1]);
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+
+    QByteArray header(headerSize + int(levels.size()) * levelEntrySize, '\0');
+    uchar *h = reinterpret_cast<uchar *>(header.data());
+    memcpy(h, peakMagic, 8);
+    const int frames = int(std::ceil(double(minimums.size() / size_t(channels)) / binsPerFrame));
+    qToLittleEndian<quint32>(quint32(channels), h + 8);
+    qToLittleEndian<quint32>(quint32(frames), h + 12);
+    qToLittleEndian<quint32>(quint32(binsPerFrame), h + 16);
+    qToLittleEndian<quint32>(quint32(levels.size()), h + 20);
+    qToLittleEndian<quint32>(quint32(maxLevel), h + 24);
+    quint64 offset = quint64(header.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        uchar *entry = h + headerSize + i * levelEntrySize;
+        qToLittleEndian<quint64>(offset, entry);
+        qToLittleEndian<quint64>(quint64(levels[i].size() / stride), entry + 8);
+        offset += levels[i].size();
+    }
+
+    // Write to a temporary file so that readers never map a partial file
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(header);
+    for (const auto &level : levels) {
+        file.write(reinterpret_cast<const char *>(level.data()), qint64(level.size()));
+    }
+    return file.commit();
+}
+
+bool AudioPeakFile::convertLegacyImage(const QString &imagePath, int channels, const QString &path)
+{
+    QImage image(imagePath);
+    if (image.isNull() || channels <= 0) {
+        return false;
+    }
+    // Legacy thumbnails store one unsigned level (0-255) per frame and channel, packed 4 by 4 in the pixels
+    const int n = image.width() * image.height();
+    std::vector<qint16> minimums;
+    std::vector<qint16> maximums;
+    minimums.reserve(size_t(n) * 4);
+    maximums.reserve(size_t(n) * 4);
+    for (int i = 0; i < n; i++) {
+        QRgb p = image.pixel(i / channels, i % channels);
+        for (int value : {qRed(p), qGreen(p), qBlue(p), qAlpha(p)}) {
+            // map 0-255 to a symmetrical 0-32767 peak
+            qint16 peak = qint16(value * 32767 / 255);
+            minimums.push_back(qint16(-peak));
+            maximums.push_back(peak);
+        }
+    }
+    // Drop the padding of the last pixel
+    size_t count = minimums.size() - minimums.size() % size_t(channels);
+    minimums.resize(count);
+    maximums.resize(count);
+    return write(path, channels, 1, minimums, maximums);
+}
+
+int AudioPeakFile::channels() const
+{
+    return m_channels;
+}
+
+int AudioPeakFile::frameCount() const
+{
+    return m_frameCount;
+}
+
+int AudioPeakFile::levelCount() const
+{
+    return int(m_levels.size());
+}
+
+int AudioPeakFile::maxLevel() const
+{
+    return m_maxLevel;
+}
+
+AudioPeakFile::Level AudioPeakFile::level(int index) const
+{
+    return m_levels.at(size_t(index));
+}
+
+int AudioPeakFile::levelForZoom(double framesPerPixel) const
+{
+    int index = 0;
+    while (index + 1 < levelCount() && m_levels[size_t(index + 1)].framesPerBin <= framesPerPixel) {
+        index++;
+    }
+    return index;
+}
+
+std::pair<int, int> AudioPeakFile::range(int levelIndex, int channel, double start, double end) const
+{
+    const Level &level = m_levels.at(size_t(levelIndex));
+    if (end <= 0) {
+        return {0, 0};
+    }
+    int first = qMax(0, int(start / level.framesPerBin));
+    int last = qMin(level.binCount, qMax(first + 1, int(std::ceil(end / level.framesPerBin))));
+    int low = 0;
+    int high = 0;
+    for (int b = first; b < last; ++b) {
+        const qint8 *bin = level.data + (size_t(b) * size_t(m_channels) + size_t(channel)) * 2;
+        low = qMin(low, int(bin[0]));
+        high = qMax(high, int(bin[1]));
+    }
+    return {low, high};
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef AUDIOPEAKS_H
+#define AUDIOPEAKS_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+/**
+  Memory mapped, multi resolution audio peak file.
+
+  The finest level stores, for each channel, the minimum and maximum
+  sample of bins of a fraction of a video frame. Each following level
+  merges two consecutive bins of the previous one, so a waveform can
+  read the level matching its zoom and touch about one bin per pixel.
+
+  Layout (little endian): a 32 bytes header ("KDENPKS1", channels,
+  frame count, bins per frame at level 0, level count, max level),
+  one (offset, bin count) pair of 64 bit values per level, then the
+  levels themselves. A bin holds one (min, max) pair of signed bytes
+  per channel.
+  */
+class AudioPeakFile
+{
+public:
+    struct Level
+    {
+        const qint8 *data = nullptr; // (min, max) for each channel, bin after bin
+        int binCount = 0;
+        double framesPerBin = 1.;
+    };
+
+    /** @brief Maps an existing peak file, returns nullptr if it is missing or invalid */
+    static std::shared_ptr<const AudioPeakFile> open(const QString &path);
+
+    /** @brief Builds the levels from the finest extrema and writes the file.
+        @param minimums, maximums are the interleaved extrema of each bin, as computed by AudioLevelReducer */
+    static bool write(const QString &path, int channels, int binsPerFrame, const std::vector<qint16> &minimums, const std::vector<qint16> &maximums);
+
+    /** @brief Converts a legacy audio thumbnail (levels packed in the RGBA values of a png image) to a peak file */
+    static bool convertLegacyImage(const QString &imagePath, int channels, const QString &path);
+
+    int channels() const;
+    int frameCount() const;
+    int levelCount() const;
+    /** @brief The highest absolute value stored in the file, from 1 to 127 */
+    int maxLevel() const;
+    Level level(int index) const;
+    /** @brief Returns the coarsest level that still has at least one bin per pixel */
+    int levelForZoom(double framesPerPixel) const;
+
+    /** @brief Returns the min and max of @param channel between frames @param start (included) and @param end (excluded) */
+    std::pair<int, int> range(int levelIndex, int channel, double start, double end) const;
+
+    ~AudioPeakFile();
+
+private:
+    AudioPeakFile() = default;
+    QFile m_file;
+    uchar *m_map = nullptr;
+    int m_channels = 0;
+    int m_frameCount = 0;
+    int m_maxLevel = 1;
+    std::vector<Level> m_levels;
+};
+
+#endif // AUDIOPEAKS_H
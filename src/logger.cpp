@@ -25,6 +25,9 @@
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/model/timelinemodel.hpp"
 #include <QString>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -39,7 +42,11 @@
 #pragma GCC diagnostic pop
 
 thread_local bool Logger::is_executing = false;
+std::atomic<bool> Logger::enabled{true};
+std::atomic<size_t> Logger::next_record{0};
+size_t Logger::buffer_size = 4 * 1024 * 1024;
 std::mutex Logger::mut;
+std::vector<std::shared_ptr<Logger::TraceBuffer>> Logger::buffers;
 std::vector<rttr::variant> Logger::operations;
 std::vector<Logger::Invok> Logger::invoks;
 std::unordered_map<std::string, std::vector<Logger::Constr>> Logger::constr;
@@ -47,7 +54,397 @@ std::unordered_map<std::string, std::string> Logger::translation_table;
 std::unordered_map<std::string, std::string> Logger::back_translation_table;
 int Logger::dump_count = 0;
 
-thread_local size_t Logger::result_awaiting = INT_MAX;
+namespace {
+// Tags of the arguments in the binary records
+enum ArgTag : unsigned char { TagInvalid, TagInt, TagDouble, TagFloat, TagSize, TagBool, TagEnum, TagQString, TagString, TagIntSet, TagTimeline, TagTimelineItem, TagBin, TagPointer };
+
+// Size of the record header: total size, sequence number and type
+const size_t recordHeader = sizeof(quint32) + sizeof(quint64) + 1;
+
+// The record being written by the current thread
+thread_local std::string currentRecord;
+
+template <typename T> void put(T value)
+{
+    currentRecord.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void putString(const char *data, size_t size)
+{
+    put(quint32(size));
+    currentRecord.append(data, size);
+}
+
+class RecordReader
+{
+public:
+    RecordReader(const char *data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+    bool atEnd() const { return m_pos >= m_size; }
+    template <typename T> T get()
+    {
+        T value{};
+        if (m_pos + sizeof(T) <= m_size) {
+            memcpy(&value, m_data + m_pos, sizeof(T));
+        }
+        m_pos += sizeof(T);
+        return value;
+    }
+    std::string getString()
+    {
+        auto size = get<quint32>();
+        if (m_pos + size > m_size) {
+            m_pos = m_size;
+            return std::string();
+        }
+        std::string result(m_data + m_pos, size);
+        m_pos += size;
+        return result;
+    }
+
+private:
+    const char *m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+};
+
+rttr::variant readArg(RecordReader &reader)
+{
+    switch (reader.get<unsigned char>()) {
+    case TagInt:
+        return reader.get<int>();
+    case TagDouble:
+        return reader.get<double>();
+    case TagFloat:
+        return reader.get<float>();
+    case TagSize:
+        return size_t(reader.get<quint64>());
+    case TagBool:
+        return reader.get<unsigned char>() != 0;
+    case TagEnum: {
+        const std::string name = reader.getString();
+        int value = reader.get<int>();
+        rttr::type type = rttr::type::get_by_name(name);
+        if (type.is_enumeration()) {
+            for (const auto &v : type.get_enumeration().get_values()) {
+                if (v.convert<int>() == value) {
+                    return v;
+                }
+            }
+        }
+        std::cout << "Error: unknown enum value " << name << " " << value << std::endl;
+        return rttr::variant();
+    }
+    case TagQString:
+        return QString::fromStdString(reader.getString());
+    case TagString:
+        return reader.getString();
+    case TagIntSet: {
+        std::unordered_set<int> set;
+        auto count = reader.get<quint32>();
+        for (quint32 i = 0; i < count && !reader.atEnd(); ++i) {
+            set.insert(reader.get<int>());
+        }
+        return set;
+    }
+    case TagTimeline:
+        return reinterpret_cast<TimelineModel *>(quintptr(reader.get<quint64>()));
+    case TagTimelineItem:
+        return reinterpret_cast<TimelineItemModel *>(quintptr(reader.get<quint64>()));
+    case TagBin:
+        return reinterpret_cast<ProjectItemModel *>(quintptr(reader.get<quint64>()));
+    case TagPointer:
+        // Instances of other classes are not referred to by the test cases
+        reader.getString();
+        reader.get<quint64>();
+        return rttr::variant();
+    default:
+        std::cout << "Error: unhandled arg type " << reader.getString() << std::endl;
+        return rttr::variant();
+    }
+}
+} // namespace
+
+/** @brief A ring of binary records, written by a single thread.
+ * Positions are byte offsets since the last reset, the data index is the position modulo the buffer size.
+ */
+struct Logger::TraceBuffer
+{
+    std::vector<char> data;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<size_t> dropped{0};
+
+    void reset(size_t size)
+    {
+        data.assign(size, 0);
+        head = 0;
+        tail = 0;
+        dropped = 0;
+    }
+
+    void copyIn(size_t pos, const char *src, size_t size)
+    {
+        const size_t offset = pos % data.size();
+        const size_t first = std::min(size, data.size() - offset);
+        memcpy(data.data() + offset, src, first);
+        memcpy(data.data(), src + first, size - first);
+    }
+
+    void copyOut(size_t pos, char *dest, size_t size) const
+    {
+        const size_t offset = pos % data.size();
+        const size_t first = std::min(size, data.size() - offset);
+        memcpy(dest, data.data() + offset, first);
+        memcpy(dest + first, data.data(), size - first);
+    }
+
+    void push(const std::string &record)
+    {
+        if (record.size() > data.size()) {
+            dropped++;
+            return;
+        }
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_relaxed);
+        // Drop the oldest records to make room
+        while (h - t + record.size() > data.size()) {
+            quint32 size;
+            copyOut(t, reinterpret_cast<char *>(&size), sizeof(size));
+            t += size;
+            dropped++;
+        }
+        tail.store(t, std::memory_order_release);
+        copyIn(h, record.data(), record.size());
+        head.store(h + record.size(), std::memory_order_release);
+    }
+
+    std::string contents() const
+    {
+        const size_t t = tail.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        std::string result(h - t, '\0');
+        if (h > t) {
+            copyOut(t, &result[0], h - t);
+        }
+        return result;
+    }
+};
+
+Logger::Record::Record(RecordType type)
+{
+    currentRecord.clear();
+    put(quint32(0));
+    put(quint64(next_record.fetch_add(1, std::memory_order_relaxed)));
+    put(static_cast<unsigned char>(type));
+}
+
+void Logger::Record::add(int value)
+{
+    put(TagInt);
+    put(value);
+}
+
+void Logger::Record::add(double value)
+{
+    put(TagDouble);
+    put(value);
+}
+
+void Logger::Record::add(float value)
+{
+    put(TagFloat);
+    put(value);
+}
+
+void Logger::Record::add(size_t value)
+{
+    put(TagSize);
+    put(quint64(value));
+}
+
+void Logger::Record::add(bool value)
+{
+    put(TagBool);
+    put(static_cast<unsigned char>(value));
+}
+
+void Logger::Record::add(const QString &value)
+{
+    put(TagQString);
+    const QByteArray data = value.toUtf8();
+    putString(data.constData(), size_t(data.size()));
+}
+
+void Logger::Record::add(const std::string &value)
+{
+    put(TagString);
+    putString(value.data(), value.size());
+}
+
+void Logger::Record::add(const std::unordered_set<int> &value)
+{
+    put(TagIntSet);
+    put(quint32(value.size()));
+    for (int v : value) {
+        put(v);
+    }
+}
+
+void Logger::Record::add_enum(rttr::string_view type, int value)
+{
+    put(TagEnum);
+    putString(type.data(), type.size());
+    put(value);
+}
+
+void Logger::Record::add_name(rttr::string_view name)
+{
+    putString(name.data(), name.size());
+}
+
+void Logger::Record::add_variant(rttr::variant value)
+{
+    // this will rewove shared/weak/unique ptrs
+    if (value.get_type().is_wrapper()) {
+        value = value.extract_wrapped_value();
+    }
+    const rttr::type type = value.get_type();
+    if (type == rttr::type::get<int>()) {
+        add(value.convert<int>());
+    } else if (type == rttr::type::get<double>()) {
+        add(value.convert<double>());
+    } else if (type == rttr::type::get<float>()) {
+        add(value.convert<float>());
+    } else if (type == rttr::type::get<size_t>()) {
+        add(value.convert<size_t>());
+    } else if (type == rttr::type::get<bool>()) {
+        add(value.convert<bool>());
+    } else if (type.is_enumeration()) {
+        add_enum(type.get_enumeration().get_name(), value.convert<int>());
+    } else if (value.can_convert<QString>()) {
+        add(value.convert<QString>());
+    } else if (value.can_convert<std::string>()) {
+        add(value.convert<std::string>());
+    } else if (value.can_convert<std::unordered_set<int>>()) {
+        add(value.convert<std::unordered_set<int>>());
+    } else if (type == rttr::type::get<TimelineItemModel *>()) {
+        put(TagTimelineItem);
+        put(quint64(quintptr(value.convert<TimelineItemModel *>())));
+    } else if (value.can_convert<TimelineModel *>()) {
+        put(TagTimeline);
+        put(quint64(quintptr(value.convert<TimelineModel *>())));
+    } else if (value.can_convert<ProjectItemModel *>()) {
+        put(TagBin);
+        put(quint64(quintptr(value.convert<ProjectItemModel *>())));
+    } else if (type.is_pointer()) {
+        put(TagPointer);
+        add_name(type.get_name());
+        put(quint64(0));
+    } else {
+        put(TagInvalid);
+        add_name(type.get_name());
+    }
+}
+
+void Logger::Record::commit()
+{
+    const auto size = quint32(currentRecord.size());
+    memcpy(&currentRecord[0], &size, sizeof(size));
+    thread_buffer()->push(currentRecord);
+}
+
+Logger::TraceBuffer *Logger::thread_buffer()
+{
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<TraceBuffer>();
+        std::unique_lock<std::mutex> lk(mut);
+        buffer->reset(buffer_size);
+        buffers.push_back(buffer);
+    }
+    return buffer.get();
+}
+
+void Logger::decode_trace()
+{
+    struct Operation
+    {
+        quint64 seq;
+        RecordType type;
+        std::string name;
+        std::vector<rttr::variant> args;
+        rttr::variant res;
+    };
+    std::vector<Operation> decoded;
+    {
+        std::unique_lock<std::mutex> lk(mut);
+        for (const auto &buffer : buffers) {
+            const std::string data = buffer->contents();
+            size_t lastInvok = SIZE_MAX;
+            size_t pos = 0;
+            while (pos + recordHeader <= data.size()) {
+                RecordReader reader(data.data() + pos, data.size() - pos);
+                const auto size = reader.get<quint32>();
+                if (size < recordHeader || pos + size > data.size()) {
+                    std::cout << "Error: corrupted trace record" << std::endl;
+                    break;
+                }
+                reader = RecordReader(data.data() + pos + sizeof(quint32), size - sizeof(quint32));
+                pos += size;
+                Operation op;
+                op.seq = reader.get<quint64>();
+                op.type = static_cast<RecordType>(reader.get<unsigned char>());
+                if (op.type == RecordType::Constr || op.type == RecordType::Invok) {
+                    op.name = reader.getString();
+                }
+                while (!reader.atEnd()) {
+                    op.args.push_back(readArg(reader));
+                }
+                if (op.type == RecordType::Result) {
+                    // The result belongs to the last call of the same thread
+                    if (lastInvok < decoded.size() && !op.args.empty()) {
+                        decoded[lastInvok].res = op.args.front();
+                    }
+                    continue;
+                }
+                if (op.type == RecordType::Invok) {
+                    lastInvok = decoded.size();
+                }
+                decoded.push_back(std::move(op));
+            }
+        }
+    }
+    std::stable_sort(decoded.begin(), decoded.end(), [](const Operation &a, const Operation &b) { return a.seq < b.seq; });
+    operations.clear();
+    constr.clear();
+    invoks.clear();
+    for (auto &op : decoded) {
+        if (op.args.empty()) {
+            continue;
+        }
+        rttr::variant first = op.args.front();
+        op.args.erase(op.args.begin());
+        switch (op.type) {
+        case RecordType::Constr:
+            constr[op.name].push_back({first, std::move(op.args)});
+            operations.emplace_back(ConstrId{op.name, constr[op.name].size() - 1});
+            break;
+        case RecordType::Invok:
+            invoks.push_back({first, op.name, std::move(op.args), op.res});
+            operations.emplace_back(InvokId{invoks.size() - 1});
+            break;
+        case RecordType::Undo:
+            operations.emplace_back(Undo{first.convert<bool>()});
+            break;
+        default:
+            break;
+        }
+    }
+}
 
 void Logger::init()
 {
@@ -93,8 +490,7 @@ void Logger::init()
 
 bool Logger::start_logging()
 {
-    std::unique_lock<std::mutex> lk(mut);
-    if (is_executing) {
+    if (is_executing || !enabled.load(std::memory_order_relaxed)) {
         return false;
     }
     is_executing = true;
@@ -102,9 +498,37 @@ bool Logger::start_logging()
 }
 void Logger::stop_logging()
 {
-    std::unique_lock<std::mutex> lk(mut);
     is_executing = false;
 }
+
+void Logger::set_enabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool Logger::is_enabled()
+{
+    return enabled;
+}
+
+void Logger::set_buffer_size(size_t bytes)
+{
+    {
+        std::unique_lock<std::mutex> lk(mut);
+        buffer_size = std::max(bytes, size_t(256));
+    }
+    clear();
+}
+
+size_t Logger::dropped_records()
+{
+    std::unique_lock<std::mutex> lk(mut);
+    size_t dropped = 0;
+    for (const auto &buffer : buffers) {
+        dropped += buffer->dropped;
+    }
+    return dropped;
+}
 std::string Logger::get_ptr_name(const rttr::variant &ptr)
 {
     if (ptr.can_convert<TimelineModel *>()) {
@@ -119,25 +543,18 @@ std::string Logger::get_ptr_name(const rttr::variant &ptr)
     return "unknown";
 }
 
-void Logger::log_res(rttr::variant result)
-{
-    std::unique_lock<std::mutex> lk(mut);
-    Q_ASSERT(result_awaiting < invoks.size());
-    invoks[result_awaiting].res = std::move(result);
-}
-
 void Logger::log_create_producer(const std::string &type, std::vector<rttr::variant> args)
 {
-    std::unique_lock<std::mutex> lk(mut);
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Record record(RecordType::Constr);
+    record.add_name(type.c_str());
+    record.add(type);
     for (auto &a : args) {
-        // this will rewove shared/weak/unique ptrs
-        if (a.get_type().is_wrapper()) {
-            a = a.extract_wrapped_value();
-        }
-        const std::string class_name = a.get_type().get_name().to_string();
+        record.add_variant(std::move(a));
     }
-    constr[type].push_back({type, std::move(args)});
-    operations.emplace_back(ConstrId{type, constr[type].size() - 1});
+    record.commit();
 }
 
 namespace {
@@ -166,6 +583,11 @@ std::string quoted(const std::string &input)
 void Logger::print_trace()
 {
     dump_count++;
+    decode_trace();
+    size_t dropped = dropped_records();
+    if (dropped > 0) {
+        std::cout << "Warning: " << dropped << " operations were dropped from the trace, the test case may not be replayable" << std::endl;
+    }
     auto process_args = [&](const std::vector<rttr::variant> &args, const std::unordered_set<size_t> &refs = {}) {
         std::stringstream ss;
         bool deb = true;
@@ -418,6 +840,13 @@ void Logger::print_trace()
 void Logger::clear()
 {
     is_executing = false;
+    std::unique_lock<std::mutex> lk(mut);
+    // Forget the buffers of the threads that exited
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const std::shared_ptr<TraceBuffer> &buffer) { return buffer.use_count() == 1; }),
+                  buffers.end());
+    for (const auto &buffer : buffers) {
+        buffer->reset(buffer_size);
+    }
     invoks.clear();
     operations.clear();
     constr.clear();
@@ -440,7 +869,10 @@ bool LogGuard::hasGuard() const
 
 void Logger::log_undo(bool undo)
 {
-    Logger::Undo u;
-    u.undo = undo;
-    operations.push_back(u);
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Record record(RecordType::Undo);
+    record.add(undo);
+    record.commit();
 }
@@ -20,11 +20,17 @@
  ***************************************************************************/
 
 #pragma once
+#include <QString>
+#include <atomic>
 #include <climits>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -32,12 +38,16 @@
 #pragma GCC diagnostic ignored "-Wfloat-equal"
 #pragma GCC diagnostic ignored "-Wshadow"
 #pragma GCC diagnostic ignored "-Wpedantic"
+#include <rttr/type.h>
 #include <rttr/variant.h>
 #pragma GCC diagnostic pop
 
 /** @brief This class is meant to provide an easy way to reproduce bugs involving the model.
  * The idea is to log any modifier function involving a model class, and trace the parameters that were passed, to be able to generate a test-case producing the
  * same behaviour. Note that many modifier functions of the models are nested. We are only interested in the top-most call, and we must ignore bottom calls.
+ * Operations are serialized in a compact binary format into a ring buffer owned by the logging thread, so that logging takes no lock and the memory used
+ * is bounded: once a buffer is full, its oldest operations are dropped. They are only decoded when the trace is printed.
+ * Tracing can be disabled at runtime with set_enabled, or at compile time by defining KDENLIVE_NO_MODEL_TRACE (cmake option ENABLE_MODEL_TRACE).
  */
 class Logger
 {
@@ -52,27 +62,43 @@ public:
 
     /** @brief This logs the construction of an object of type T, whose new instance is passed. The instance will be kept around in case future calls refer to
      * it. The arguments should more or less match the constructor arguments. In general, it's better to call the corresponding macro TRACE_CONSTR */
-    template <typename T> static void log_constr(T *inst, std::vector<rttr::variant> args);
+    template <typename T, typename... Args> static void log_constr(T *inst, const Args &... args);
 
     /** @brief Logs the call to a member function on a given instance of class T. The string contains the method name, and then the vector contains all the
      * parameters. In general, the method should be registered in RTTR. It's better to call the corresponding macro TRACE() if appropriate */
-    template <typename T> static void log(T *inst, std::string str, std::vector<rttr::variant> args);
+    template <typename T, typename... Args> static void log(T *inst, const char *method, const Args &... args);
+
+    /** @brief Versions of log_constr and log taking their arguments as a tuple. They are used by the macros, so that an empty argument list doesn't leave
+     * a dangling comma (eliding it requires a GNU extension). For log_constr_tuple, the first element is the instance. For log_static_tuple, the first element
+     * is a smart pointer to the instance */
+    template <typename... Args> static void log_constr_tuple(const std::tuple<Args...> &args);
+    template <typename T, typename... Args> static void log_tuple(T *inst, const char *method, const std::tuple<Args...> &args);
+    template <typename... Args> static void log_static_tuple(const char *method, const std::tuple<Args...> &args);
     static void log_create_producer(const std::string &type, std::vector<rttr::variant> args);
 
     /** @brief When the last function logged has a return value, you can log it through this function, by passing the corresponding value. In general, it's
      * better to call the macro TRACE_RES */
-    static void log_res(rttr::variant result);
+    template <typename T> static void log_res(const T &result);
 
     // log whenever an undo/redo occurred
     static void log_undo(bool undo);
 
     /// @brief Notify that we are done with our function. Must not be called if start_logging returned false.
     static void stop_logging();
+    /** @brief Writes the trace as a test case and a fuzzer input. The threads that log must be idle while the trace is decoded */
     static void print_trace();
 
     /// @brief Resets the current log
     static void clear();
 
+    /// @brief Enables or disables the logging of operations at runtime
+    static void set_enabled(bool enabled);
+    static bool is_enabled();
+    /// @brief Sets the size in bytes of the trace buffer of each thread. This clears the current log
+    static void set_buffer_size(size_t bytes);
+    /// @brief Returns the number of operations dropped because a trace buffer was full
+    static size_t dropped_records();
+
     static std::unordered_map<std::string, std::string> translation_table;
     static std::unordered_map<std::string, std::string> back_translation_table;
 
@@ -80,6 +106,8 @@ protected:
     /** @brief Look amongst the known instances to get the name of a given pointer */
     static std::string get_ptr_name(const rttr::variant &ptr);
     template <typename T> static size_t get_id_from_ptr(T *ptr);
+    /** @brief Calls @param f with the elements of @param args */
+    template <typename F, typename Tuple, size_t... I> static void apply_tuple(const F &f, const Tuple &args, std::index_sequence<I...>);
     struct InvokId
     {
         size_t id;
@@ -102,9 +130,51 @@ protected:
         std::vector<rttr::variant> args;
         rttr::variant res;
     };
+
+    enum class RecordType : unsigned char { Constr, Invok, Result, Undo };
+    /** @brief Serializes one operation in the calling thread's trace buffer.
+     * Common argument types are written directly, the others go through rttr */
+    class Record
+    {
+    public:
+        explicit Record(RecordType type);
+        void add(int value);
+        void add(double value);
+        void add(float value);
+        void add(size_t value);
+        void add(bool value);
+        void add(const QString &value);
+        void add(const std::string &value);
+        void add(const std::unordered_set<int> &value);
+        template <typename A> typename std::enable_if<std::is_enum<A>::value>::type add(A value) { add_enum(rttr::type::get<A>().get_name(), int(value)); }
+        template <typename A> typename std::enable_if<!std::is_enum<A>::value>::type add(const A &value) { add_variant(rttr::variant(value)); }
+        void add_name(rttr::string_view name);
+        void add_variant(rttr::variant value);
+        /// @brief Writes the record to the trace buffer
+        void commit();
+
+        template <typename... Args> void add_all(const Args &... args)
+        {
+            // Evaluated in order
+            int unused[] = {0, (add(args), 0)...};
+            (void)unused;
+        }
+
+    private:
+        void add_enum(rttr::string_view type, int value);
+    };
+    struct TraceBuffer;
+
+    /** @brief Decodes the trace buffers of all threads into operations, constr and invoks */
+    static void decode_trace();
+    static TraceBuffer *thread_buffer();
+
     thread_local static bool is_executing;
-    thread_local static size_t result_awaiting;
+    static std::atomic<bool> enabled;
+    static std::atomic<size_t> next_record;
+    static size_t buffer_size;
     static std::mutex mut;
+    static std::vector<std::shared_ptr<TraceBuffer>> buffers;
     static std::vector<rttr::variant> operations;
     static std::unordered_map<std::string, std::vector<Constr>> constr;
     static std::vector<Invok> invoks;
@@ -124,25 +194,31 @@ protected:
     bool m_hasGuard = false;
 };
 
-/// See Logger::log_constr. Note that the macro fills in the ptr instance for you.
-#define TRACE_CONSTR(ptr, ...)                                                                                                                                 \
+#ifdef KDENLIVE_NO_MODEL_TRACE
+#define TRACE_CONSTR(...)
+#define TRACE(...)
+#define TRACE_STATIC(...)
+#define TRACE_RES(res)
+#else
+/// See Logger::log_constr. The first argument is the new instance, followed by the constructor arguments.
+#define TRACE_CONSTR(...)                                                                                                                                      \
     LogGuard __guard;                                                                                                                                          \
     if (__guard.hasGuard()) {                                                                                                                                  \
-        Logger::log_constr((ptr), {__VA_ARGS__});                                                                                                              \
+        Logger::log_constr_tuple(std::forward_as_tuple(__VA_ARGS__));                                                                                          \
     }
 
 /// See Logger::log. Note that the macro fills the ptr instance and the method name for you.
 #define TRACE(...)                                                                                                                                             \
     LogGuard __guard;                                                                                                                                          \
     if (__guard.hasGuard()) {                                                                                                                                  \
-        Logger::log(this, __FUNCTION__, {__VA_ARGS__});                                                                                                        \
+        Logger::log_tuple(this, __FUNCTION__, std::forward_as_tuple(__VA_ARGS__));                                                                             \
     }
 
-/// Same as TRACE, but called from a static function
-#define TRACE_STATIC(ptr, ...)                                                                                                                                 \
+/// Same as TRACE, but called from a static function. The first argument is a smart pointer to the instance.
+#define TRACE_STATIC(...)                                                                                                                                      \
     LogGuard __guard;                                                                                                                                          \
     if (__guard.hasGuard()) {                                                                                                                                  \
-        Logger::log(ptr.get(), __FUNCTION__, {__VA_ARGS__});                                                                                                   \
+        Logger::log_static_tuple(__FUNCTION__, std::forward_as_tuple(__VA_ARGS__));                                                                            \
     }
 
 /// See Logger::log_res
@@ -150,35 +226,50 @@ protected:
     if (__guard.hasGuard()) {                                                                                                                                  \
         Logger::log_res(res);                                                                                                                                  \
     }
+#endif
 
 /******* Implementations ***********/
-template <typename T> void Logger::log_constr(T *inst, std::vector<rttr::variant> args)
+template <typename T, typename... Args> void Logger::log_constr(T *inst, const Args &... args)
 {
-    std::unique_lock<std::mutex> lk(mut);
-    for (auto &a : args) {
-        // this will rewove shared/weak/unique ptrs
-        if (a.get_type().is_wrapper()) {
-            a = a.extract_wrapped_value();
-        }
-    }
-    std::string class_name = rttr::type::get<T>().get_name().to_string();
-    constr[class_name].push_back({inst, std::move(args)});
-    operations.emplace_back(ConstrId{class_name, constr[class_name].size() - 1});
+    Record record(RecordType::Constr);
+    record.add_name(rttr::type::get<T>().get_name());
+    record.add_all(inst, args...);
+    record.commit();
 }
 
-template <typename T> void Logger::log(T *inst, std::string fctName, std::vector<rttr::variant> args)
+template <typename T, typename... Args> void Logger::log(T *inst, const char *method, const Args &... args)
 {
-    std::unique_lock<std::mutex> lk(mut);
-    for (auto &a : args) {
-        // this will rewove shared/weak/unique ptrs
-        if (a.get_type().is_wrapper()) {
-            a = a.extract_wrapped_value();
-        }
-    }
-    std::string class_name = rttr::type::get<T>().get_name().to_string();
-    invoks.push_back({inst, std::move(fctName), std::move(args), rttr::variant()});
-    operations.emplace_back(InvokId{invoks.size() - 1});
-    result_awaiting = invoks.size() - 1;
+    Record record(RecordType::Invok);
+    record.add_name(method);
+    record.add_all(inst, args...);
+    record.commit();
+}
+
+template <typename... Args> void Logger::log_constr_tuple(const std::tuple<Args...> &args)
+{
+    apply_tuple([](const auto &inst, const auto &... rest) { Logger::log_constr(inst, rest...); }, args, std::index_sequence_for<Args...>());
+}
+
+template <typename T, typename... Args> void Logger::log_tuple(T *inst, const char *method, const std::tuple<Args...> &args)
+{
+    apply_tuple([inst, method](const auto &... rest) { Logger::log(inst, method, rest...); }, args, std::index_sequence_for<Args...>());
+}
+
+template <typename... Args> void Logger::log_static_tuple(const char *method, const std::tuple<Args...> &args)
+{
+    apply_tuple([method](const auto &ptr, const auto &... rest) { Logger::log(ptr.get(), method, rest...); }, args, std::index_sequence_for<Args...>());
+}
+
+template <typename F, typename Tuple, size_t... I> void Logger::apply_tuple(const F &f, const Tuple &args, std::index_sequence<I...>)
+{
+    f(std::get<I>(args)...);
+}
+
+template <typename T> void Logger::log_res(const T &result)
+{
+    Record record(RecordType::Result);
+    record.add(result);
+    record.commit();
 }
 
 template <typename T> size_t Logger::get_id_from_ptr(T *ptr)
@@ -2038,6 +2038,13 @@ void MainWindow::setRenderingFinished(const QString &url, int status, const QStr
     }
 }
 
+void MainWindow::setRenderingSegments(const QString &url, const QString &segments)
+{
+    if (m_renderWidget) {
+        m_renderWidget->setRenderSegments(url, segments.split(QLatin1Char(',')));
+    }
+}
+
 void MainWindow::addProjectClip(const QString &url)
 {
     if (pCore->currentDoc()) {
@@ -2116,6 +2123,7 @@ void MainWindow::connectDocument()
 {
     KdenliveDoc *project = pCore->currentDoc();
     connect(project, &KdenliveDoc::startAutoSave, pCore->projectManager(), &ProjectManager::slotStartAutoSave);
+    connect(project, &KdenliveDoc::autoSaved, pCore->projectManager(), &ProjectManager::slotAutoSaveDone);
     connect(project, &KdenliveDoc::reloadEffects, this, &MainWindow::slotReloadEffects);
     KdenliveSettings::setProject_fps(pCore->getCurrentFps());
     m_projectMonitor->slotLoadClipZone(project->zone());
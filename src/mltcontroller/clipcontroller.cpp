@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "clipcontroller.h"
 #include "bin/model/markerlistmodel.hpp"
+#include "bin/producerpool.h"
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
@@ -100,6 +101,7 @@ ClipController::~ClipController()
 {
     delete m_properties;
     m_masterProducer.reset();
+    ProducerPool::get()->invalidate(m_controllerBinId);
 }
 
 const QString ClipController::binId() const
@@ -116,6 +118,7 @@ void ClipController::addMasterProducer(const std::shared_ptr<Mlt::Producer> &pro
 {
     qDebug() << "################### ClipController::addmasterproducer";
     QString documentRoot = pCore->currentDoc()->documentRoot();
+    ProducerPool::get()->invalidate(m_controllerBinId);
     m_masterProducer = producer;
     m_properties = new Mlt::Properties(m_masterProducer->get_properties());
     m_producerLock.unlock();
@@ -345,6 +348,7 @@ void ClipController::updateProducer(const std::shared_ptr<Mlt::Producer> &produc
         // producer has not been initialized
         return addMasterProducer(producer);
     }
+    ProducerPool::get()->invalidate(m_controllerBinId);
     m_producerLock.lockForWrite();
     Mlt::Properties passProperties;
     // Keep track of necessary properties
@@ -590,6 +594,7 @@ void ClipController::setProducerProperty(const QString &name, int value)
         m_tempProps.insert(name, value);
         return;
     }
+    ProducerPool::get()->invalidate(m_controllerBinId);
     QWriteLocker lock(&m_producerLock);
     m_masterProducer->parent().set(name.toUtf8().constData(), value);
 }
@@ -600,6 +605,7 @@ void ClipController::setProducerProperty(const QString &name, double value)
         m_tempProps.insert(name, value);
         return;
     }
+    ProducerPool::get()->invalidate(m_controllerBinId);
     QWriteLocker lock(&m_producerLock);
     m_masterProducer->parent().set(name.toUtf8().constData(), value);
 }
@@ -611,6 +617,7 @@ void ClipController::setProducerProperty(const QString &name, const QString &val
         return;
     }
 
+    ProducerPool::get()->invalidate(m_controllerBinId);
     QWriteLocker lock(&m_producerLock);
     if (value.isEmpty()) {
         m_masterProducer->parent().set(name.toUtf8().constData(), (char *)nullptr);
@@ -626,6 +633,7 @@ void ClipController::resetProducerProperty(const QString &name)
         return;
     }
 
+    ProducerPool::get()->invalidate(m_controllerBinId);
     QWriteLocker lock(&m_producerLock);
     m_masterProducer->parent().set(name.toUtf8().constData(), (char *)nullptr);
 }
@@ -30,6 +30,7 @@
 #include <QFontDatabase>
 #include <kdeclarative_version.h>
 #include <klocalizedstring.h>
+#include <iterator>
 
 #include "core.h"
 #include "glwidget.h"
@@ -54,6 +55,9 @@
 #endif
 
 
+// Number of displayed frames kept to preview pending seeks
+static const int MaxCachedFrames = 10;
+
 #ifndef GL_TIMEOUT_IGNORED
 #define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
 #endif
@@ -84,6 +88,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_vertexLocation(0)
     , m_texCoordLocation(0)
     , m_colorspaceLocation(0)
+    , m_seekScheduler(250)
     , m_zoom(1.0f)
     , m_profileSize(1920, 1080)
     , m_colorSpace(601)
@@ -126,6 +131,9 @@ GLWidget::GLWidget(int id, QObject *parent)
     m_blackClip->set("kdenlive:id", "black");
     m_blackClip->set("out", 3);
     connect(&m_refreshTimer, &QTimer::timeout, this, &GLWidget::refresh);
+    m_seekTimer.setInterval(120);
+    m_seekClock.start();
+    connect(&m_seekTimer, &QTimer::timeout, this, &GLWidget::checkSeek);
     m_producer = m_blackClip;
     rootContext()->setContextProperty("markersModel", 0);
     if (!initGPUAccel()) {
@@ -215,7 +223,6 @@ void GLWidget::initializeGL()
     openglContext()->makeCurrent(this);
     connect(m_frameRenderer, &FrameRenderer::textureReady, this, &GLWidget::updateTexture, Qt::DirectConnection);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::onFrameDisplayed, Qt::QueuedConnection);
-    connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::frameDisplayed, Qt::QueuedConnection);
     m_initSem.release();
     m_isInitialized = true;
     reconfigure();
@@ -651,6 +658,22 @@ void GLWidget::wheelEvent(QWheelEvent *event)
 }
 
 void GLWidget::requestSeek(int position)
+{
+    if (!qFuzzyIsNull(m_producer->get_speed())) {
+        m_seekScheduler.cancel();
+        doSeek(position);
+        return;
+    }
+    if (m_seekScheduler.request(position, m_seekClock.elapsed())) {
+        doSeek(position);
+    } else {
+        // The consumer is still busy with the previous seek, show the closest frame we have
+        showCachedFrame(position);
+    }
+    m_seekTimer.start();
+}
+
+void GLWidget::doSeek(int position)
 {
     m_consumer->set("scrub_audio", 1);
     m_producer->seek(position);
@@ -663,6 +686,78 @@ void GLWidget::requestSeek(int position)
     m_consumer->set("refresh", 1);
 }
 
+void GLWidget::checkSeek()
+{
+    int position = m_seekScheduler.expire(m_seekClock.elapsed());
+    if (position >= 0) {
+        doSeek(position);
+    }
+    if (m_seekScheduler.settled()) {
+        m_seekTimer.stop();
+    }
+}
+
+void GLWidget::showCachedFrame(int position)
+{
+    if (m_recentFrames.isEmpty() || m_frameRenderer == nullptr || m_glslManager != nullptr) {
+        return;
+    }
+    auto it = m_recentFrames.lowerBound(position);
+    if (it == m_recentFrames.end() || (it != m_recentFrames.begin() && it.key() - position > position - std::prev(it).key())) {
+        --it;
+    }
+    m_contextSharedAccess.lock();
+    int displayed = m_sharedFrame.is_valid() ? m_sharedFrame.get_position() : -1;
+    m_contextSharedAccess.unlock();
+    if (displayed >= 0 && qAbs(displayed - position) <= qAbs(it.key() - position)) {
+        return;
+    }
+    if (!m_frameRenderer->semaphore()->tryAcquire(1, 0)) {
+        return;
+    }
+    Mlt::Frame frame = it.value().clone(false, true, false);
+    frame.set("kdenlive:preview", 1);
+    QMetaObject::invokeMethod(m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+}
+
+void GLWidget::cacheFrame(const SharedFrame &frame)
+{
+    if (m_glslManager != nullptr || !qFuzzyIsNull(m_producer->get_speed())) {
+        return;
+    }
+    int position = frame.get_position();
+    m_recentFrames.insert(position, frame);
+    while (m_recentFrames.size() > MaxCachedFrames) {
+        // Drop the frame farthest from the current one
+        if (position - m_recentFrames.firstKey() > m_recentFrames.lastKey() - position) {
+            m_recentFrames.erase(m_recentFrames.begin());
+        } else {
+            m_recentFrames.erase(std::prev(m_recentFrames.end()));
+        }
+    }
+}
+
+SeekScheduler::Stats GLWidget::seekStats() const
+{
+    return m_seekScheduler.stats();
+}
+
+void GLWidget::logSeekStats()
+{
+    const SeekScheduler::Stats stats = m_seekScheduler.stats();
+    if (stats.requests > 0) {
+        Mlt::Producer parent = m_producer->parent();
+        QString codec = QString::fromUtf8(parent.get(QStringLiteral("meta.media.%1.codec.name").arg(parent.get_int("video_index")).toUtf8().constData()));
+        if (codec.isEmpty()) {
+            codec = QString::fromUtf8(parent.get("mlt_service"));
+        }
+        qCDebug(KDENLIVE_LOG) << "Seek latency for" << codec << ":" << stats.requests << "requests," << stats.coalesced << "coalesced, first frame"
+                              << stats.responseAverage << "ms average," << stats.responseMax << "ms max, exact frame" << stats.exactAverage << "ms average,"
+                              << stats.exactPercentile95 << "ms 95th percentile," << stats.exactMax << "ms max";
+    }
+    m_seekScheduler.resetStats();
+}
+
 void GLWidget::requestRefresh()
 {
     if (m_producer && qFuzzyIsNull(m_producer->get_speed())) {
@@ -679,6 +774,7 @@ QString GLWidget::frameToTime(int frames) const
 void GLWidget::refresh()
 {
     m_refreshTimer.stop();
+    m_recentFrames.clear();
     QMutexLocker locker(&m_mltMutex);
     if (m_consumer->is_stopped()) {
         m_consumer->start();
@@ -881,8 +977,10 @@ static void onThreadStopped(mlt_properties owner, GLWidget *self)
 int GLWidget::setProducer(const QString &file)
 {
     if (m_producer) {
+        logSeekStats();
         m_producer.reset();
     }
+    m_recentFrames.clear();
     qDebug()<<"==== OPENING PROIDUCER FILE: "<<file;
     m_producer = std::make_shared<Mlt::Producer>(new Mlt::Producer(pCore->getCurrentProfile()->profile(), nullptr, file.toUtf8().constData()));
     if (m_consumer) {
@@ -909,6 +1007,7 @@ int GLWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, bool i
     if (m_consumer) {
         consumerPosition = m_consumer->position();
     }
+    logSeekStats();
     stop();
     if (producer) {
         m_producer = producer;
@@ -1275,6 +1374,18 @@ void GLWidget::onFrameDisplayed(const SharedFrame &frame)
     m_sendFrame = sendFrameForAnalysis;
     m_contextSharedAccess.unlock();
     update();
+    int next = m_seekScheduler.frameDisplayed(frame.get_position(), m_seekClock.elapsed());
+    if (next >= 0) {
+        doSeek(next);
+    } else if (m_seekScheduler.settled()) {
+        m_seekTimer.stop();
+    }
+    if (frame.get_int("kdenlive:preview") == 1) {
+        // Cached frame shown while seeking, the position is not the monitor's
+        return;
+    }
+    cacheFrame(frame);
+    emit frameDisplayed(frame);
 }
 
 void GLWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -1295,6 +1406,7 @@ void GLWidget::mouseReleaseEvent(QMouseEvent *event)
 
 void GLWidget::purgeCache()
 {
+    m_recentFrames.clear();
     if (m_consumer) {
         m_consumer->purge();
         m_producer->seek(m_proxy->getPosition() + 1);
@@ -1746,6 +1858,9 @@ void GLWidget::startConsumer()
 void GLWidget::stop()
 {
     m_refreshTimer.stop();
+    m_seekTimer.stop();
+    m_seekScheduler.cancel();
+    m_recentFrames.clear();
     // why this lock?
     QMutexLocker locker(&m_mltMutex);
     if (m_producer) {
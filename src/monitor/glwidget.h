@@ -19,7 +19,9 @@
 #ifndef GLWIDGET_H
 #define GLWIDGET_H
 
+#include <QElapsedTimer>
 #include <QFont>
+#include <QMap>
 #include <QMutex>
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
@@ -36,6 +38,7 @@
 #include "definitions.h"
 #include "kdenlivesettings.h"
 #include "scopes/sharedframe.h"
+#include "seekscheduler.h"
 
 #include <mlt++/MltProfile.h>
 
@@ -152,6 +155,8 @@ protected:
     int setProducer(const std::shared_ptr<Mlt::Producer> &producer, bool isActive, int position = -1);
     int setProducer(const QString &file);
     QString frameToTime(int frames) const;
+    /** @brief Seek to display latency statistics for the current producer */
+    SeekScheduler::Stats seekStats() const;
 
 public slots:
     void requestSeek(int position);
@@ -224,6 +229,12 @@ private:
     int m_colorspaceLocation;
     int m_textureLocation[3];
     QTimer m_refreshTimer;
+    /** @brief Coalesces the seeks requested while scrubbing */
+    SeekScheduler m_seekScheduler;
+    QElapsedTimer m_seekClock;
+    QTimer m_seekTimer;
+    /** @brief Last frames displayed while paused, used as preview when a seek has to wait */
+    QMap<int, SharedFrame> m_recentFrames;
     float m_zoom;
     QSize m_profileSize;
     int m_colorSpace;
@@ -241,6 +252,12 @@ private:
     QOpenGLFramebufferObject *m_fbo;
     void refreshSceneLayout();
     void resetZoneMode();
+    /** @brief Send a seek to the consumer */
+    void doSeek(int position);
+    /** @brief Display the cached frame nearest to @param position while the seek is pending */
+    void showCachedFrame(int position);
+    void cacheFrame(const SharedFrame &frame);
+    void logSeekStats();
 
     /* OpenGL context management. Interfaces to MLT according to the configured render pipeline.
      */
@@ -250,6 +267,7 @@ private slots:
     void paintGL();
     void onFrameDisplayed(const SharedFrame &frame);
     void refresh();
+    void checkSeek();
 
 protected:
     QMutex m_contextSharedAccess;
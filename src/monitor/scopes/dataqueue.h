@@ -19,10 +19,12 @@
 #ifndef DATAQUEUE_H
 #define DATAQUEUE_H
 
-#include <QList>
+#include "utils/paddedatomic.hpp"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QWaitCondition>
+#include <atomic>
+#include <memory>
 
 /*!
   \class DataQueue
@@ -32,15 +34,19 @@
   \threadsafe
 
   DataQueue provides a limited size container for passing data between objects.
-  One object can add data to the queue by calling push() while another object
-  can remove items from the queue by calling pop().
+  One or several objects can add data to the queue by calling push() while another
+  object can remove items from the queue by calling pop().
 
   DataQueue provides configurable behavior for handling overflows. It can
   discard the oldest, discard the newest or block the object calling push()
   until room has been freed in the queue by another object calling pop().
+  Discarded items are counted, see dropped().
 
-  DataQueue is threadsafe and is therefore most appropriate when passing data
-  between objects operating in different thread contexts.
+  DataQueue is lock-free: it is a fixed size ring where each slot carries a
+  sequence number telling whether it is ready to be written or read, so that
+  producers and consumers only synchronize through atomic operations. Blocking
+  calls sleep on a wait condition, the other side only takes the lock to wake
+  them when a thread is actually waiting.
 */
 
 template <class T> class DataQueue
@@ -76,80 +82,193 @@ public:
       Pops an item from the queue.
 
       If the queue is empty then this  function will block. If blocking is
-      undesired, then check the return of count() before calling pop().
+      undesired, then use tryPop() or check the return of count() before calling pop().
     */
     T pop();
 
+    /*!
+      Pops an item from the queue into \a item if there is one.
+      Returns false if the queue was empty.
+    */
+    bool tryPop(T &item);
+
     //! Returns the number of items in the queue.
     int count() const;
 
+    //! Returns the number of items discarded on overflow.
+    int dropped() const;
+
 private:
-    QList<T> m_queue;
+    struct Slot
+    {
+        std::atomic<quint64> sequence;
+        T item;
+    };
+    bool tryPush(const T &item);
+    bool tryPopSlot(T &item);
+    //! Wakes the threads sleeping on \a condition, if there are any.
+    void wake(const std::atomic<int> &waiters, QWaitCondition &condition);
+    std::unique_ptr<Slot[]> m_slots;
     int m_maxSize;
     OverflowMode m_mode;
-    mutable QMutex m_mutex;
+    // Producers and consumer indexes are kept on separate cache lines
+    PaddedAtomic<quint64> m_pushPosition;
+    PaddedAtomic<quint64> m_popPosition;
+    std::atomic<int> m_dropped;
+    // Only used by blocking calls
+    QMutex m_waitMutex;
     QWaitCondition m_notEmptyCondition;
     QWaitCondition m_notFullCondition;
+    std::atomic<int> m_popWaiters;
+    std::atomic<int> m_pushWaiters;
 };
 
 template <class T>
 DataQueue<T>::DataQueue(int maxSize, OverflowMode mode)
-    : m_queue()
-    , m_maxSize(maxSize)
+    : m_slots(new Slot[size_t(qMax(1, maxSize))])
+    , m_maxSize(qMax(1, maxSize))
     , m_mode(mode)
-    , m_mutex(QMutex::NonRecursive)
-    , m_notEmptyCondition()
-    , m_notFullCondition()
+    , m_dropped(0)
+    , m_popWaiters(0)
+    , m_pushWaiters(0)
 {
+    for (int i = 0; i < m_maxSize; ++i) {
+        m_slots[size_t(i)].sequence.store(quint64(i), std::memory_order_relaxed);
+    }
 }
 
 template <class T> DataQueue<T>::~DataQueue() = default;
 
+template <class T> bool DataQueue<T>::tryPush(const T &item)
+{
+    quint64 position = m_pushPosition.value.load(std::memory_order_relaxed);
+    while (true) {
+        Slot &slot = m_slots[size_t(position % quint64(m_maxSize))];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            // The slot is free, try to claim it
+            if (m_pushPosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.item = item;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (sequence < position) {
+            // The slot still holds the item pushed one lap before: the queue is full
+            return false;
+        } else {
+            position = m_pushPosition.value.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T> void DataQueue<T>::wake(const std::atomic<int> &waiters, QWaitCondition &condition)
+{
+    // Pairs with the fence of the waiting thread: either it sees our change, or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        QMutexLocker locker(&m_waitMutex);
+        condition.wakeAll();
+    }
+}
+
+template <class T> bool DataQueue<T>::tryPop(T &item)
+{
+    if (!tryPopSlot(item)) {
+        return false;
+    }
+    wake(m_pushWaiters, m_notFullCondition);
+    return true;
+}
+
+template <class T> bool DataQueue<T>::tryPopSlot(T &item)
+{
+    quint64 position = m_popPosition.value.load(std::memory_order_relaxed);
+    while (true) {
+        Slot &slot = m_slots[size_t(position % quint64(m_maxSize))];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position + 1) {
+            if (m_popPosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                item = slot.item;
+                // Release our reference to the item right away
+                slot.item = T();
+                slot.sequence.store(position + quint64(m_maxSize), std::memory_order_release);
+                return true;
+            }
+        } else if (sequence < position + 1) {
+            // Nothing was pushed in this slot yet: the queue is empty
+            return false;
+        } else {
+            position = m_popPosition.value.load(std::memory_order_relaxed);
+        }
+    }
+}
+
 template <class T> void DataQueue<T>::push(const T &item)
 {
-    m_mutex.lock();
-    if (m_queue.size() == m_maxSize) {
+    while (!tryPush(item)) {
         switch (m_mode) {
-        case OverflowModeDiscardOldest:
-            m_queue.removeFirst();
-            m_queue.append(item);
+        case OverflowModeDiscardOldest: {
+            T oldest;
+            if (tryPopSlot(oldest)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
             break;
+        }
         case OverflowModeDiscardNewest:
             // This item is the newest so discard it and exit
-            break;
-        case OverflowModeWait:
-            m_notFullCondition.wait(&m_mutex);
-            m_queue.append(item);
-            break;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        case OverflowModeWait: {
+            QMutexLocker locker(&m_waitMutex);
+            m_pushWaiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Check again now that consumers can see us waiting
+            if (!tryPush(item)) {
+                m_notFullCondition.wait(&m_waitMutex);
+                m_pushWaiters.fetch_sub(1);
+                continue;
+            }
+            m_pushWaiters.fetch_sub(1);
+            locker.unlock();
+            wake(m_popWaiters, m_notEmptyCondition);
+            return;
         }
-    } else {
-        m_queue.append(item);
-        if (m_queue.size() == 1) {
-            m_notEmptyCondition.wakeOne();
         }
     }
-    m_mutex.unlock();
+    wake(m_popWaiters, m_notEmptyCondition);
 }
 
 template <class T> T DataQueue<T>::pop()
 {
     T retVal;
-    m_mutex.lock();
-    if (m_queue.size() == 0) {
-        m_notEmptyCondition.wait(&m_mutex);
-    }
-    retVal = m_queue.takeFirst();
-    if (m_mode == OverflowModeWait && m_queue.size() == m_maxSize - 1) {
-        m_notFullCondition.wakeOne();
+    while (!tryPop(retVal)) {
+        QMutexLocker locker(&m_waitMutex);
+        m_popWaiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // Check again now that producers can see us waiting
+        if (tryPopSlot(retVal)) {
+            m_popWaiters.fetch_sub(1);
+            locker.unlock();
+            wake(m_pushWaiters, m_notFullCondition);
+            break;
+        }
+        m_notEmptyCondition.wait(&m_waitMutex);
+        m_popWaiters.fetch_sub(1);
     }
-    m_mutex.unlock();
     return retVal;
 }
 
 template <class T> int DataQueue<T>::count() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_queue.size();
+    const quint64 popped = m_popPosition.value.load(std::memory_order_acquire);
+    const quint64 pushed = m_pushPosition.value.load(std::memory_order_acquire);
+    // Positions are claimed before the slot is filled or emptied, so this is only an estimate
+    return pushed > popped ? qMin(m_maxSize, int(pushed - popped)) : 0;
+}
+
+template <class T> int DataQueue<T>::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
 }
 
 #endif // DATAQUEUE_H
@@ -0,0 +1,168 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "seekscheduler.h"
+
+#include <algorithm>
+
+namespace {
+// Number of exact latencies kept for the percentile
+const int LatencyWindow = 100;
+} // namespace
+
+SeekScheduler::SeekScheduler(qint64 timeout)
+    : m_timeout(timeout)
+    , m_target(-1)
+    , m_sent(-1)
+    , m_pending(-1)
+    , m_sentTime(0)
+    , m_targetTime(-1)
+    , m_unansweredTime(-1)
+    , m_responses(0)
+    , m_responseTotal(0)
+    , m_exactCount(0)
+    , m_exactTotal(0)
+{
+    m_exactLatencies.reserve(LatencyWindow);
+}
+
+bool SeekScheduler::request(int position, qint64 now)
+{
+    m_stats.requests++;
+    m_target = position;
+    m_targetTime = now;
+    if (m_unansweredTime < 0) {
+        m_unansweredTime = now;
+    }
+    if (m_sent >= 0 && now - m_sentTime <= m_timeout) {
+        // A seek is in progress, keep this one until its frame is displayed
+        if (m_pending >= 0) {
+            m_stats.coalesced++;
+        }
+        m_pending = position;
+        return false;
+    }
+    if (m_pending >= 0) {
+        m_stats.coalesced++;
+        m_pending = -1;
+    }
+    m_sent = position;
+    m_sentTime = now;
+    m_stats.sent++;
+    return true;
+}
+
+int SeekScheduler::frameDisplayed(int position, qint64 now)
+{
+    if (m_unansweredTime >= 0) {
+        qint64 latency = now - m_unansweredTime;
+        m_responses++;
+        m_responseTotal += latency;
+        m_stats.responseMax = qMax(m_stats.responseMax, latency);
+        m_unansweredTime = -1;
+    }
+    if (position == m_target && m_targetTime >= 0) {
+        qint64 latency = now - m_targetTime;
+        m_exactCount++;
+        m_exactTotal += latency;
+        m_stats.exactMax = qMax(m_stats.exactMax, latency);
+        if (m_exactLatencies.size() < LatencyWindow) {
+            m_exactLatencies.append(latency);
+        } else {
+            m_exactLatencies[m_exactCount % LatencyWindow] = latency;
+        }
+        m_targetTime = -1;
+    }
+    if (position != m_sent) {
+        // Frame from an earlier seek or a preview, the sent seek is still in progress
+        return -1;
+    }
+    m_sent = -1;
+    if (m_pending < 0) {
+        return -1;
+    }
+    m_sent = m_pending;
+    m_sentTime = now;
+    m_pending = -1;
+    m_stats.sent++;
+    return m_sent;
+}
+
+int SeekScheduler::expire(qint64 now)
+{
+    if (m_sent < 0 || now - m_sentTime <= m_timeout) {
+        return -1;
+    }
+    m_sent = -1;
+    if (m_pending < 0) {
+        // The consumer displayed another frame than the one requested (out of range), don't wait for it
+        m_targetTime = -1;
+        return -1;
+    }
+    m_sent = m_pending;
+    m_sentTime = now;
+    m_pending = -1;
+    m_stats.sent++;
+    return m_sent;
+}
+
+void SeekScheduler::cancel()
+{
+    m_sent = -1;
+    m_pending = -1;
+    m_targetTime = -1;
+    m_unansweredTime = -1;
+}
+
+bool SeekScheduler::settled() const
+{
+    return m_targetTime < 0;
+}
+
+int SeekScheduler::target() const
+{
+    return m_target;
+}
+
+SeekScheduler::Stats SeekScheduler::stats() const
+{
+    Stats result = m_stats;
+    if (m_responses > 0) {
+        result.responseAverage = double(m_responseTotal) / m_responses;
+    }
+    if (m_exactCount > 0) {
+        result.exactAverage = double(m_exactTotal) / m_exactCount;
+        QVector<qint64> sorted = m_exactLatencies;
+        std::sort(sorted.begin(), sorted.end());
+        result.exactPercentile95 = sorted.at(qMin(sorted.size() - 1, sorted.size() * 95 / 100));
+    }
+    return result;
+}
+
+void SeekScheduler::resetStats()
+{
+    m_stats = Stats();
+    m_responses = 0;
+    m_responseTotal = 0;
+    m_exactLatencies.clear();
+    m_exactCount = 0;
+    m_exactTotal = 0;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SEEKSCHEDULER_H
+#define SEEKSCHEDULER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/** @class SeekScheduler
+    @brief Coalesces the seek requests sent to a monitor consumer.
+    Only one seek is sent to the consumer at a time. Requests arriving before its frame is
+    displayed replace each other, and the last one is sent once the frame shows up, so that
+    scrubbing never queues decodes the user will not see.
+    The scheduler also measures the seek to display latency. Times are given by the caller,
+    in milliseconds.
+ */
+class SeekScheduler
+{
+public:
+    struct Stats
+    {
+        /** @brief Seek requests received */
+        int requests = 0;
+        /** @brief Requests replaced by a later one before being sent */
+        int coalesced = 0;
+        /** @brief Seeks sent to the consumer */
+        int sent = 0;
+        /** @brief Average and worst time between a request and the display of any new frame */
+        double responseAverage = 0;
+        qint64 responseMax = 0;
+        /** @brief Average, 95th percentile and worst time between the last request and the display of its exact frame */
+        double exactAverage = 0;
+        qint64 exactPercentile95 = 0;
+        qint64 exactMax = 0;
+    };
+
+    /** @brief @param timeout the delay after which a seek whose frame was not displayed is considered lost */
+    explicit SeekScheduler(qint64 timeout = 500);
+
+    /** @brief A seek to @param position was requested, returns true if it should be sent to the consumer now */
+    bool request(int position, qint64 now);
+    /** @brief A frame was displayed, returns the position of the seek to send next, -1 if none */
+    int frameDisplayed(int position, qint64 now);
+    /** @brief Returns the pending seek if the frame of the one sent was not displayed in time, -1 if there is nothing to send */
+    int expire(qint64 now);
+    /** @brief Forget the seeks in progress */
+    void cancel();
+    /** @brief Returns true if the last requested frame was displayed */
+    bool settled() const;
+    /** @brief The last requested position, -1 if none */
+    int target() const;
+    Stats stats() const;
+    void resetStats();
+
+private:
+    qint64 m_timeout;
+    int m_target;
+    int m_sent;
+    int m_pending;
+    qint64 m_sentTime;
+    qint64 m_targetTime;
+    /** @brief Time of the oldest request not answered by a displayed frame, -1 if none */
+    qint64 m_unansweredTime;
+    Stats m_stats;
+    int m_responses;
+    qint64 m_responseTotal;
+    /** @brief Last exact latencies, for the percentile */
+    QVector<qint64> m_exactLatencies;
+    int m_exactCount;
+    qint64 m_exactTotal;
+};
+
+#endif
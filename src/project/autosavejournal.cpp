@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "autosavejournal.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+const quint32 journalMagic = 0x4b4a524e;
+const quint8 journalVersion = 1;
+} // namespace
+
+QString AutoSaveJournal::journalFile(const QString &autosaveFile)
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    dir.mkpath(QStringLiteral("autosave"));
+    const QString id = QCryptographicHash::hash(autosaveFile.toUtf8(), QCryptographicHash::Md5).toHex();
+    return dir.absoluteFilePath(QStringLiteral("autosave/%1.journal").arg(id));
+}
+
+QByteArray AutoSaveJournal::createEntry(const QByteArray &base, const QByteArray &scene)
+{
+    // Edits are usually local, so the common head and tail of both documents cover most of the scene
+    const int maxCommon = qMin(base.size(), scene.size());
+    int prefix = 0;
+    while (prefix < maxCommon && base.at(prefix) == scene.at(prefix)) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < maxCommon - prefix && base.at(base.size() - 1 - suffix) == scene.at(scene.size() - 1 - suffix)) {
+        suffix++;
+    }
+    QByteArray entry;
+    QDataStream stream(&entry, QIODevice::WriteOnly);
+    stream << journalMagic << journalVersion << QCryptographicHash::hash(base, QCryptographicHash::Md5) << quint32(prefix) << quint32(suffix)
+           << qCompress(scene.mid(prefix, scene.size() - prefix - suffix)) << QCryptographicHash::hash(scene, QCryptographicHash::Md5);
+    return entry;
+}
+
+bool AutoSaveJournal::applyEntry(const QByteArray &base, const QByteArray &entry, QByteArray &scene)
+{
+    QDataStream stream(entry);
+    quint32 magic;
+    quint8 version;
+    QByteArray baseHash, middle, sceneHash;
+    quint32 prefix, suffix;
+    stream >> magic >> version >> baseHash >> prefix >> suffix >> middle >> sceneHash;
+    if (stream.status() != QDataStream::Ok || magic != journalMagic || version != journalVersion) {
+        return false;
+    }
+    if (prefix + suffix > quint32(base.size()) || baseHash != QCryptographicHash::hash(base, QCryptographicHash::Md5)) {
+        return false;
+    }
+    QByteArray result = base.left(int(prefix));
+    result.append(qUncompress(middle));
+    result.append(base.right(int(suffix)));
+    if (QCryptographicHash::hash(result, QCryptographicHash::Md5) != sceneHash) {
+        return false;
+    }
+    scene = result;
+    return true;
+}
+
+bool AutoSaveJournal::write(const QString &autosaveFile, const QByteArray &entry)
+{
+    QSaveFile file(journalFile(autosaveFile));
+    if (!file.open(QIODevice::WriteOnly) || file.write(entry) < 0) {
+        return false;
+    }
+    return file.commit();
+}
+
+bool AutoSaveJournal::replay(const QString &autosaveFile)
+{
+    QFile journal(journalFile(autosaveFile));
+    if (!journal.exists()) {
+        return true;
+    }
+    bool result = false;
+    QFile file(autosaveFile);
+    if (journal.open(QIODevice::ReadOnly) && file.open(QIODevice::ReadOnly)) {
+        QByteArray scene;
+        if (applyEntry(file.readAll(), journal.readAll(), scene)) {
+            file.close();
+            QSaveFile output(autosaveFile);
+            result = output.open(QIODevice::WriteOnly) && output.write(scene) >= 0 && output.commit();
+        }
+    }
+    journal.close();
+    if (result) {
+        journal.remove();
+    }
+    return result;
+}
+
+void AutoSaveJournal::discard(const QString &autosaveFile)
+{
+    QFile::remove(journalFile(autosaveFile));
+}
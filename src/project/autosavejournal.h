@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef AUTOSAVEJOURNAL_H
+#define AUTOSAVEJOURNAL_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @namespace AutoSaveJournal
+ * @brief Incremental autosave support.
+ * The autosave file holds a full scene list, written from time to time. In between, only the difference
+ * between that base and the current scene is written, compressed, to a journal file. On crash recovery,
+ * the journal is replayed on the autosave file before opening it.
+ */
+
+namespace AutoSaveJournal {
+
+/** @brief Returns the path of the journal belonging to an autosave file */
+QString journalFile(const QString &autosaveFile);
+
+/** @brief Returns a journal entry turning @param base into @param scene */
+QByteArray createEntry(const QByteArray &base, const QByteArray &scene);
+
+/** @brief Applies a journal entry to the base it was created against
+ * @return false if the entry is corrupted or was created against another base */
+bool applyEntry(const QByteArray &base, const QByteArray &entry, QByteArray &scene);
+
+/** @brief Atomically replaces the journal of @param autosaveFile with @param entry */
+bool write(const QString &autosaveFile, const QByteArray &entry);
+
+/** @brief Applies the pending journal of @param autosaveFile, if any, and removes the journal
+ * @return false if a journal existed but could not be replayed */
+bool replay(const QString &autosaveFile);
+
+/** @brief Removes the journal of @param autosaveFile */
+void discard(const QString &autosaveFile);
+
+} // namespace AutoSaveJournal
+
+#endif
@@ -22,6 +22,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "project/dialogs/backupwidget.h"
 #include "project/dialogs/noteswidget.h"
 #include "project/dialogs/projectsettings.h"
+#include "project/autosavejournal.h"
 #include "utils/thumbnailcache.hpp"
 #include "xml/xml.hpp"
 
@@ -311,8 +312,7 @@ bool ProjectManager::saveFileAs(const QString &outputFileName)
     }
     QUrl url = QUrl::fromLocalFile(outputFileName);
     // Save timeline thumbnails
-    QStringList thumbKeys = pCore->window()->getMainTimeline()->controller()->getThumbKeys();
-    ThumbnailCache::get()->saveCachedThumbs(thumbKeys);
+    ThumbnailCache::get()->saveCachedThumbs(pCore->window()->getMainTimeline()->controller()->getThumbKeys());
     m_project->setUrl(url);
     // setting up autosave file in ~/.kde/data/stalefiles/kdenlive/
     // saved under file name
@@ -325,6 +325,7 @@ bool ProjectManager::saveFileAs(const QString &outputFileName)
         // The file filename does not have to exist for KAutoSaveFile to be constructed (if it exists, it will not be touched).
         m_project->m_autosave = new KAutoSaveFile(autosaveUrl, m_project);
     } else {
+        m_project->clearAutoSave();
         m_project->m_autosave->setManagedFile(autosaveUrl);
     }
 
@@ -382,7 +383,7 @@ bool ProjectManager::saveFile()
         return saveFileAs();
     }
     bool result = saveFileAs(m_project->url().toLocalFile());
-    m_project->m_autosave->resize(0);
+    m_project->clearAutoSave();
     return result;
 }
 
@@ -450,6 +451,7 @@ bool ProjectManager::checkForBackupFile(const QUrl &url, bool newFile)
     }
     // remove the stale files
     for (KAutoSaveFile *stale : staleFiles) {
+        AutoSaveJournal::discard(stale->fileName());
         stale->open(QIODevice::ReadWrite);
         delete stale;
     }
@@ -516,6 +518,9 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale)
     m_progressDialog->show();
     bool openBackup;
     m_notesPlugin->clear();
+    if (stale && !AutoSaveJournal::replay(stale->fileName())) {
+        qCDebug(KDENLIVE_LOG) << "Cannot replay autosave journal for" << stale->fileName();
+    }
     KdenliveDoc *doc = new KdenliveDoc(stale ? QUrl::fromLocalFile(stale->fileName()) : url, QString(), pCore->window()->m_commandStack,
                                        KdenliveSettings::default_profile().isEmpty() ? pCore->getCurrentProfile()->path() : KdenliveSettings::default_profile(),
                                        QMap<QString, QString>(), QMap<QString, QString>(),
@@ -641,20 +646,28 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
+    if (m_project->isAutoSaving()) {
+        // Previous autosave is still being written
+        m_autoSaveTimer.start(3000);
+        return;
+    }
+    m_autoSaveLatency.start();
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
     QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    m_project->slotAutoSave(scene);
+    // Replacements and writing happen in a worker thread
+    m_project->slotAutoSave(scene, m_replacementPattern);
+    m_autoSaveBlocking = m_autoSaveLatency.elapsed();
     m_lastSave.start();
 }
 
+void ProjectManager::slotAutoSaveDone(KdenliveDoc::AutoSaveResult result)
+{
+    if (result == KdenliveDoc::AutoSaveFull || result == KdenliveDoc::AutoSaveIncremental) {
+        pCore->displayMessage(i18n("Project autosaved in %1ms (%2ms blocking)", m_autoSaveLatency.elapsed(), m_autoSaveBlocking), InformationMessage, 500);
+    }
+}
+
 QString ProjectManager::projectSceneList(const QString &outputFolder)
 {
     // Disable multitrack view and overlay
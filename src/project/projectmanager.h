@@ -20,6 +20,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QUrl>
 #include <QElapsedTimer>
 
+#include "doc/kdenlivedoc.h"
 #include "timeline2/model/timelineitemmodel.hpp"
 
 #include <memory>
@@ -28,7 +29,6 @@ the Free Software Foundation, either version 3 of the License, or
 
 class KAutoSaveFile;
 class KJob;
-class KdenliveDoc;
 class MarkerListModel;
 class NotesPlugin;
 class Project;
@@ -123,6 +123,8 @@ public slots:
 
     /** @brief Start autosave timer */
     void slotStartAutoSave();
+    /** @brief Background autosave finished, report its latency */
+    void slotAutoSaveDone(KdenliveDoc::AutoSaveResult result);
 
     /** @brief Update project and monitors profiles */
     void slotResetProfiles(bool reloadThumbs);
@@ -182,6 +184,10 @@ private:
     std::shared_ptr<TimelineItemModel> m_mainTimelineModel;
     QElapsedTimer m_lastSave;
     QTimer m_autoSaveTimer;
+    /** @brief Time since the last autosave started */
+    QElapsedTimer m_autoSaveLatency;
+    /** @brief Time the last autosave blocked the interface, in ms */
+    qint64 m_autoSaveBlocking{0};
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
     QMap<QString, QString> m_replacementPattern;
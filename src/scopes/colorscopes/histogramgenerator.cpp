@@ -10,6 +10,7 @@
 
 #include "histogramgenerator.h"
 #include "colorconstants.h"
+#include "scopekernels.h"
 
 #include "klocalizedstring.h"
 #include <QImage>
@@ -33,44 +34,21 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
     bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
 
+    std::array<uint, 1024> bins;
+    ScopeKernels::histogram(image, rec, drawY, accelFactor, bins);
     int r[256], g[256], b[256], y[256], s[766];
-    // Initialize the values to zero
-    std::fill(r, r + 256, 0);
-    std::fill(g, g + 256, 0);
-    std::fill(b, b + 256, 0);
-    std::fill(y, y + 256, 0);
-    std::fill(s, s + 766, 0);
+    std::fill(s + 256, s + 766, 0);
+    for (int i = 0; i < 256; ++i) {
+        r[i] = int(bins[size_t(i)]);
+        g[i] = int(bins[size_t(i) + 256]);
+        b[i] = int(bins[size_t(i) + 512]);
+        y[i] = int(bins[size_t(i) + 768]);
+        s[i] = r[i] + g[i] + b[i];
+    }
 
     const uint ww = (uint)paradeSize.width();
     const uint wh = (uint)paradeSize.height();
 
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += (int)accelFactor) {
-
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
-
-            if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == ITURec::Rec_601) {
-                    y[(int)floor(REC_601_R * (float) qRed(col) + REC_601_G * (float) qGreen(col) + REC_601_B * (float) qBlue(col))]++;
-                } else {
-                    y[(int)floor(REC_709_R * (float) qRed(col) + REC_709_G * (float) qGreen(col) + REC_709_B * (float) qBlue(col))]++;
-                }
-            }
-
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
-            }
-        }
-    }
-
     const int nParts = (drawY ? 1 : 0) + (drawR ? 1 : 0) + (drawG ? 1 : 0) + (drawB ? 1 : 0) + (drawSum ? 1 : 0);
     if (nParts == 0) {
         // Nothing to draw
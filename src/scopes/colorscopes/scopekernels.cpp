@@ -0,0 +1,282 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "scopekernels.h"
+
+#include <QThread>
+#include <QtConcurrent>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#define SCOPEKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Luma weights in 1.15 fixed point, in memory order of a QRgb (blue, green, red)
+struct LumaWeights
+{
+    int b, g, r;
+};
+
+LumaWeights lumaWeights(ITURec rec)
+{
+    if (rec == ITURec::Rec_601) {
+        return {int(REC_601_B * 32768 + .5), int(REC_601_G * 32768 + .5), int(REC_601_R * 32768 + .5)};
+    }
+    return {int(REC_709_B * 32768 + .5), int(REC_709_G * 32768 + .5), int(REC_709_R * 32768 + .5)};
+}
+
+// Minimum number of rows handled by a thread, smaller images are not worth splitting
+const int minBandRows = 64;
+
+/* Runs process(firstRow, lastRow, partial) on horizontal bands of the image, each with its own partial result,
+   then calls merge(partial) for each band, in band order. */
+template <typename Partial, typename Process, typename Merge>
+void runBands(int height, const Partial &initial, Process process, Merge merge)
+{
+    const int bands = qBound(1, height / minBandRows, QThread::idealThreadCount());
+    std::vector<Partial> partials((size_t)bands, initial);
+    if (bands == 1) {
+        process(0, height, partials[0]);
+    } else {
+        std::vector<int> indexes((size_t)bands);
+        std::iota(indexes.begin(), indexes.end(), 0);
+        QtConcurrent::blockingMap(indexes, [&](int &band) {
+            process(band * height / bands, (band + 1) * height / bands, partials[(size_t)band]);
+        });
+    }
+    for (const Partial &p : partials) {
+        merge(p);
+    }
+}
+
+// Returns the first row of [from, to) that is read with the given row step
+int firstRow(int from, uint rowStep)
+{
+    int step = int(rowStep);
+    return (from + step - 1) / step * step;
+}
+
+std::vector<int> columnLut(int width, int columns)
+{
+    std::vector<int> lut((size_t)width);
+    for (int x = 0; x < width; ++x) {
+        lut[(size_t)x] = width > 1 ? int((qint64)x * (columns - 1) / (width - 1)) : 0;
+    }
+    return lut;
+}
+
+} // namespace
+
+void ScopeKernels::luma(const QRgb *pixels, int count, ITURec rec, uchar *out)
+{
+    const LumaWeights w = lumaWeights(rec);
+    int i = 0;
+#ifdef SCOPEKERNELS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(short(w.b), short(w.g), short(w.r), 0, short(w.b), short(w.g), short(w.r), 0);
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        // (b*wb + g*wg, r*wr) for each pixel
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+        lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+        hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+        __m128i sums = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 2, 0)));
+        sums = _mm_srli_epi32(sums, 15);
+        sums = _mm_packs_epi32(sums, sums);
+        sums = _mm_packus_epi16(sums, sums);
+        int packed = _mm_cvtsi128_si32(sums);
+        memcpy(out + i, &packed, 4);
+    }
+#endif
+    for (; i < count; ++i) {
+        QRgb c = pixels[i];
+        out[i] = uchar(qMin(255, (qBlue(c) * w.b + qGreen(c) * w.g + qRed(c) * w.r) >> 15));
+    }
+}
+
+QImage ScopeKernels::normalized(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return image;
+    default:
+        return image.convertToFormat(QImage::Format_RGB32);
+    }
+}
+
+void ScopeKernels::waveform(const QImage &source, int columns, ITURec rec, uint rowStep, std::vector<uint> &bins)
+{
+    const QImage image = normalized(source);
+    const int width = image.width();
+    const std::vector<int> lut = columnLut(width, columns);
+    bins.assign(size_t(columns) * 256, 0);
+    runBands(
+        image.height(), std::vector<uint>(bins.size(), 0),
+        [&](int from, int to, std::vector<uint> &partial) {
+            std::vector<uchar> lumaRow((size_t)width);
+            for (int y = firstRow(from, rowStep); y < to; y += int(rowStep)) {
+                luma(reinterpret_cast<const QRgb *>(image.constScanLine(y)), width, rec, lumaRow.data());
+                for (int x = 0; x < width; ++x) {
+                    partial[size_t(lut[(size_t)x]) * 256 + lumaRow[(size_t)x]]++;
+                }
+            }
+        },
+        [&](const std::vector<uint> &partial) {
+            for (size_t i = 0; i < bins.size(); ++i) {
+                bins[i] += partial[i];
+            }
+        });
+}
+
+void ScopeKernels::parade(const QImage &source, int columns, uint rowStep, std::vector<uint> &bins, ParadeStats &stats)
+{
+    const QImage image = normalized(source);
+    const int width = image.width();
+    const std::vector<int> lut = columnLut(width, columns);
+    const size_t plane = size_t(columns) * 256;
+    bins.assign(plane * 3, 0);
+    stats = ParadeStats();
+    using Partial = std::pair<std::vector<uint>, ParadeStats>;
+    runBands(
+        image.height(), Partial(bins, ParadeStats()),
+        [&](int from, int to, Partial &partial) {
+            uint *r = partial.first.data();
+            uint *g = r + plane;
+            uint *b = g + plane;
+            ParadeStats &s = partial.second;
+            for (int y = firstRow(from, rowStep); y < to; y += int(rowStep)) {
+                const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+                for (int x = 0; x < width; ++x) {
+                    const QRgb c = line[x];
+                    const uchar cr = uchar(qRed(c));
+                    const uchar cg = uchar(qGreen(c));
+                    const uchar cb = uchar(qBlue(c));
+                    const size_t column = size_t(lut[(size_t)x]) * 256;
+                    r[column + cr]++;
+                    g[column + cg]++;
+                    b[column + cb]++;
+                    s.min[0] = qMin(s.min[0], cr);
+                    s.min[1] = qMin(s.min[1], cg);
+                    s.min[2] = qMin(s.min[2], cb);
+                    s.max[0] = qMax(s.max[0], cr);
+                    s.max[1] = qMax(s.max[1], cg);
+                    s.max[2] = qMax(s.max[2], cb);
+                }
+            }
+        },
+        [&](const Partial &partial) {
+            for (size_t i = 0; i < bins.size(); ++i) {
+                bins[i] += partial.first[i];
+            }
+            for (int k = 0; k < 3; ++k) {
+                stats.min[(size_t)k] = qMin(stats.min[(size_t)k], partial.second.min[(size_t)k]);
+                stats.max[(size_t)k] = qMax(stats.max[(size_t)k], partial.second.max[(size_t)k]);
+            }
+        });
+}
+
+void ScopeKernels::histogram(const QImage &source, ITURec rec, bool withLuma, uint rowStep, std::array<uint, 1024> &bins)
+{
+    const QImage image = normalized(source);
+    const int width = image.width();
+    bins.fill(0);
+    std::array<uint, 1024> empty;
+    empty.fill(0);
+    runBands(
+        image.height(), empty,
+        [&](int from, int to, std::array<uint, 1024> &partial) {
+            uint *r = partial.data();
+            uint *g = r + 256;
+            uint *b = g + 256;
+            uint *l = b + 256;
+            std::vector<uchar> lumaRow((size_t)width);
+            for (int y = firstRow(from, rowStep); y < to; y += int(rowStep)) {
+                const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+                for (int x = 0; x < width; ++x) {
+                    const QRgb c = line[x];
+                    r[qRed(c)]++;
+                    g[qGreen(c)]++;
+                    b[qBlue(c)]++;
+                }
+                if (withLuma) {
+                    luma(line, width, rec, lumaRow.data());
+                    for (uchar v : lumaRow) {
+                        l[v]++;
+                    }
+                }
+            }
+        },
+        [&](const std::array<uint, 1024> &partial) {
+            for (size_t i = 0; i < bins.size(); ++i) {
+                bins[i] += partial[i];
+            }
+        });
+}
+
+void ScopeKernels::vectorscope(const QImage &source, const QSize &mapSize, int size, const ChromaMatrix &m, float scale, uint rowStep, std::vector<uint> &hits,
+                               std::vector<QRgb> *lastColors)
+{
+    const QImage image = normalized(source);
+    const int width = image.width();
+    const size_t points = size_t(size) * size_t(size);
+    hits.assign(points, 0);
+    if (lastColors) {
+        lastColors->assign(points, 0);
+    }
+    // Fold the mapping from [-1, 1] to the scope coordinates into the matrix
+    const float sx = scale * (mapSize.width() - 1) / 2.f;
+    const float sy = scale * (mapSize.height() - 1) / 2.f;
+    const float ox = (mapSize.width() - 1) / 2.f;
+    const float oy = (mapSize.height() - 1) / 2.f;
+    using Partial = std::pair<std::vector<uint>, std::vector<QRgb>>;
+    runBands(
+        image.height(), Partial(hits, lastColors ? *lastColors : std::vector<QRgb>()),
+        [&](int from, int to, Partial &partial) {
+            uint *h = partial.first.data();
+            QRgb *colors = lastColors ? partial.second.data() : nullptr;
+            for (int y = firstRow(from, rowStep); y < to; y += int(rowStep)) {
+                const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+                for (int x = 0; x < width; ++x) {
+                    const QRgb c = line[x];
+                    const float r = qRed(c);
+                    const float g = qGreen(c);
+                    const float b = qBlue(c);
+                    const int px = int(ox + sx * (m.uR * r + m.uG * g + m.uB * b));
+                    const int py = int(oy - sy * (m.vR * r + m.vG * g + m.vB * b));
+                    if (px < 0 || py < 0 || px >= size || py >= size) {
+                        continue;
+                    }
+                    const size_t ix = size_t(py) * size_t(size) + size_t(px);
+                    h[ix]++;
+                    if (colors) {
+                        colors[ix] = c;
+                    }
+                }
+            }
+        },
+        [&](const Partial &partial) {
+            for (size_t i = 0; i < points; ++i) {
+                if (partial.first[i] > 0) {
+                    hits[i] += partial.first[i];
+                    // bands are merged in scan order, so the last band that hit a point has the last color
+                    if (lastColors) {
+                        (*lastColors)[i] = partial.second[i];
+                    }
+                }
+            }
+        });
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef SCOPEKERNELS_H
+#define SCOPEKERNELS_H
+
+#include "colorconstants.h"
+
+#include <QImage>
+#include <array>
+#include <vector>
+
+/**
+  Counting kernels shared by the color scope generators.
+
+  All the kernels read 32 bit images scanline by scanline and count into
+  flat, contiguous bins. The image is split in horizontal bands that are
+  processed on the global thread pool, each band with its own partial
+  bins, which are summed at the end.
+
+  The rowStep parameter replaces the former acceleration factor: only one
+  row out of rowStep is read.
+  */
+namespace ScopeKernels {
+
+/** @brief Computes the 8 bit luma of @param count pixels, using fixed point weights (SSE2 when available) */
+void luma(const QRgb *pixels, int count, ITURec rec, uchar *out);
+
+/** @brief Returns a 32 bit version of the image, without copying when possible */
+QImage normalized(const QImage &image);
+
+/** @brief Luma waveform: bins[column * 256 + luma], columns spread over the image width */
+void waveform(const QImage &image, int columns, ITURec rec, uint rowStep, std::vector<uint> &bins);
+
+struct ParadeStats
+{
+    std::array<uchar, 3> min{{255, 255, 255}};
+    std::array<uchar, 3> max{{0, 0, 0}};
+};
+
+/** @brief RGB parade: bins[(component * columns + column) * 256 + value], components are R, G, B */
+void parade(const QImage &image, int columns, uint rowStep, std::vector<uint> &bins, ParadeStats &stats);
+
+/** @brief Histograms of the R, G, B and luma components: bins[component * 256 + value] */
+void histogram(const QImage &image, ITURec rec, bool withLuma, uint rowStep, std::array<uint, 1024> &bins);
+
+/** @brief Chroma coefficients for the vectorscope, applied to 0-255 RGB values: u = uR*r + uG*g + uB*b, same for v */
+struct ChromaMatrix
+{
+    float uR, uG, uB, vR, vG, vB;
+};
+
+/** @brief Vectorscope: number of hits of each point of a size x size scope, and optionally the last color that fell on each point.
+    @param mapSize is the size on which [-1, 1]² is mapped, points outside of the size x size square are dropped
+    @param scale maps u and v to [-1, 1]
+*/
+void vectorscope(const QImage &image, const QSize &mapSize, int size, const ChromaMatrix &matrix, float scale, uint rowStep, std::vector<uint> &hits,
+                 std::vector<QRgb> *lastColors);
+
+} // namespace ScopeKernels
+
+#endif // SCOPEKERNELS_H
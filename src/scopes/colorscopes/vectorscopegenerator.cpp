@@ -64,6 +64,7 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "scopekernels.h"
 #include <QImage>
 #include <cmath>
 
@@ -108,6 +109,37 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
     return {int((targetSize.width() - 1) * (point.x() + 1) / 2), int((targetSize.height() - 1) * (1 - (point.y() + 1) / 2))};
 }
 
+/**
+  The green and black paint modes brighten a point a bit more with each pixel falling on it.
+  Replays this for the number of hits of a point, stopping as soon as the color doesn't change anymore.
+ */
+static QRgb accumulate(VectorscopeGenerator::PaintMode paintMode, uint count, double avgPxPerPx)
+{
+    QRgb px = qRgba(0, 0, 0, 0);
+    for (uint i = 0; i < count; ++i) {
+        QRgb next;
+        switch (paintMode) {
+        case VectorscopeGenerator::PaintMode_Green:
+            next = qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
+                         qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx));
+            break;
+        case VectorscopeGenerator::PaintMode_Green2:
+            next = qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255, qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)),
+                         qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx)));
+            break;
+        case VectorscopeGenerator::PaintMode_Black:
+        default:
+            next = qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+            break;
+        }
+        if (next == px) {
+            break;
+        }
+        px = next;
+    }
+    return px;
+}
+
 QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
                                                   const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool,
                                                   uint accelFactor) const
@@ -122,55 +154,45 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    const uchar *bits = image.bits();
-
     double dy, dr, dg, db, dmax;
     double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
 
-    const int stepsize = int(uint(image.depth() / 8) * accelFactor);
+    ScopeKernels::ChromaMatrix matrix;
+    switch (colorSpace) {
+    case VectorscopeGenerator::ColorSpace_YUV:
+        matrix = {-0.0005781f, -0.001135f, 0.001713f, 0.002411f, -0.002019f, -0.0003921f};
+        break;
+    case VectorscopeGenerator::ColorSpace_YPbPr:
+    default:
+        matrix = {-0.0006671f, -0.001299f, 0.0019608f, 0.001961f, -0.001642f, -0.0003189f};
+        break;
+    }
+
+    // Count the pixels falling on each point of the scope, the color of each point is computed afterwards
+    std::vector<uint> hits;
+    std::vector<QRgb> lastColors;
+    ScopeKernels::vectorscope(image, vectorscopeSize, cw, matrix, SCALING * gain, accelFactor, hits, paintMode == PaintMode_Original ? &lastColors : nullptr);
 
     // Just an average for the number of image pixels per scope pixel.
-    // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
-    // https://doc.qt.io/qt-5/qimage.html#bytesPerLine
     double avgPxPerPx = (double)image.depth() / 8 * (image.bytesPerLine() * image.height()) / scope.size().width() / scope.size().height() / accelFactor;
+    const double halfWidth = (vectorscopeSize.width() - 1) / 2.;
+    const double halfHeight = (vectorscopeSize.height() - 1) / 2.;
+
+    for (int py = 0; py < cw; ++py) {
+        auto *line = reinterpret_cast<QRgb *>(scope.scanLine(py));
+        for (int px = 0; px < cw; ++px) {
+            const uint count = hits[size_t(py) * size_t(cw) + size_t(px)];
+            if (count == 0) {
+                continue;
+            }
+            // u and v at the center of this point
+            u = (px / halfWidth - 1) / (SCALING * gain);
+            v = (1 - py / halfHeight) / (SCALING * gain);
 
-    for (int i = 0; i < (image.bytesPerLine() * image.height()); i += stepsize) {
-        auto *col = (const QRgb *)(bits);
-
-        int r = qRed(*col);
-        int g = qGreen(*col);
-        int b = qBlue(*col);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = (double)0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = (double)0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * gain * u, SCALING * gain * v));
-
-        if (pt.x() >= scope.width() || pt.x() < 0 || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
-
-        } else {
-
-            // Draw the pixel using the chosen draw mode.
             switch (paintMode) {
             case PaintMode_YUV:
-                // see yuvColorWheel
                 dy = 128; // Default Y value. Lower = darker.
 
-                // Calculate the RGB values from YUV/YPbPr
                 switch (colorSpace) {
                 case VectorscopeGenerator::ColorSpace_YUV:
                     dr = dy + 290.8 * v;
@@ -185,26 +207,7 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                     break;
                 }
 
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
-                }
-                if (dg > 255) {
-                    dg = 255;
-                }
-                if (db > 255) {
-                    db = 255;
-                }
-
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+                line[px] = qRgba(qBound(0., dr, 255.), qBound(0., dg, 255.), qBound(0., db, 255.), 255);
                 break;
 
             case PaintMode_Chroma:
@@ -239,30 +242,16 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 dg *= dmax;
                 db *= dmax;
 
-                scope.setPixel(pt, qRgba(dr, dg, db, 255));
+                line[px] = qRgba(dr, dg, db, 255);
                 break;
             case PaintMode_Original:
-                scope.setPixel(pt, *col);
-                break;
-            case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
-                                         qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx)));
+                line[px] = lastColors[size_t(py) * size_t(cw) + size_t(px)];
                 break;
-            case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt,
-                               qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255,
-                                     qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)), qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Black:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
+            default:
+                line[px] = accumulate(paintMode, count, avgPxPerPx);
                 break;
             }
         }
-
-        bits += stepsize;
     }
     return scope;
 }
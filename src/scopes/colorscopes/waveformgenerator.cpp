@@ -10,6 +10,7 @@
 
 #include "waveformgenerator.h"
 #include "colorconstants.h"
+#include "scopekernels.h"
 
 #include <cmath>
 
@@ -44,84 +45,56 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
     const uint ww = (uint)waveformSize.width();
     const uint wh = (uint)waveformSize.height();
-    const uint iw = (uint)image.bytesPerLine();
-    const uint ih = (uint)image.height();
-    const uint byteCount = iw * ih;
 
-    std::vector<std::vector<uint>> waveValues((size_t)waveformSize.width(), std::vector<uint>((size_t)waveformSize.height(), 0));
+    // Luma counts, one block of 256 values per scope column
+    std::vector<uint> lumaBins;
+    ScopeKernels::waveform(image, (int)ww, rec, accelFactor, lumaBins);
 
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / float(ww * wh);
+    const float pixelDepth = (float)(uint(image.width() * image.height()) / accelFactor) / float(ww * wh);
     const float gain = 255. / (8. * pixelDepth);
     // qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     // Subtract 1 from sizes because we start counting from 0.
     // Not doing it would result in attempts to paint outside of the image.
     const float hPrediv = (float)(wh - 1) / 255.;
-    const float wPrediv = (float)(ww - 1) / float(iw - 1);
-
-    const uchar *bits = image.bits();
-    const int bpp = image.depth() / 8;
-
-    for (uint i = 0, x = 0; i < byteCount; i += (uint)bpp) {
-
-        Q_ASSERT(bits < image.bits() + byteCount);
-
-        double dY, dx, dy;
-        auto *col = (const QRgb *)bits;
-
-        if (rec == ITURec::Rec_601) {
-            // CIE 601 Luminance
-            dY = REC_601_R * float(qRed(*col)) + REC_601_G * float(qGreen(*col)) + REC_601_B * float(qBlue(*col));
-        } else {
-            // CIE 709 Luminance
-            dY = REC_709_R * float(qRed(*col)) + REC_709_G * float(qGreen(*col)) + REC_709_B * float(qBlue(*col));
-        }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = (float)x * wPrediv;
-        waveValues[(size_t)dx][(size_t)dy]++;
-
-        bits += bpp;
-        x += (uint)bpp;
-        if (x > iw) {
-            x -= iw;
-            if (accelFactor > 1) {
-                bits += bpp * (int)iw * ((int)accelFactor - 1);
-                i += (uint)bpp * iw * (accelFactor - 1);
-            }
-        }
+    uint rowOfLuma[256];
+    for (int y = 0; y < 256; ++y) {
+        rowOfLuma[y] = uint(y * hPrediv);
     }
 
-    switch (paintMode) {
-    case PaintMode_Green:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                wave.setPixel(i, waveformSize.height() - j - 1,
-                              qRgba(CHOP255(52 * log(0.1 * gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(52 * std::log(gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(52 * log(.25 * gain * (float)waveValues[(size_t)i][(size_t)j])),
-                                    CHOP255(64 * std::log(gain * (float)waveValues[(size_t)i][(size_t)j]))));
-            }
+    std::vector<QRgb *> lines(wh);
+    for (uint j = 0; j < wh; ++j) {
+        lines[j] = reinterpret_cast<QRgb *>(wave.scanLine(int(wh - j - 1)));
+    }
+    std::vector<uint> waveValues(wh);
+    for (uint i = 0; i < ww; ++i) {
+        std::fill(waveValues.begin(), waveValues.end(), 0);
+        const uint *column = lumaBins.data() + size_t(i) * 256;
+        for (int y = 0; y < 256; ++y) {
+            waveValues[rowOfLuma[y]] += column[y];
         }
-        break;
-    case PaintMode_Yellow:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * (float)waveValues[(size_t)i][(size_t)j])));
+        for (uint j = 0; j < wh; ++j) {
+            const float value = (float)waveValues[j];
+            if (value == 0) {
+                // Stays transparent
+                continue;
             }
-        }
-        break;
-    default:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2. * gain * (float)waveValues[(size_t)i][(size_t)j])));
+            switch (paintMode) {
+            case PaintMode_Green:
+                // Logarithmic scale. Needs fine tuning by hand, but looks great.
+                lines[j][i] = qRgba(CHOP255(52 * log(0.1 * gain * value)), CHOP255(52 * std::log(gain * value)), CHOP255(52 * log(.25 * gain * value)),
+                                    CHOP255(64 * std::log(gain * value)));
+                break;
+            case PaintMode_Yellow:
+                lines[j][i] = qRgba(255, 242, 0, CHOP255(gain * value));
+                break;
+            default:
+                lines[j][i] = qRgba(255, 255, 255, CHOP255(2. * gain * value));
+                break;
             }
         }
-        break;
     }
 
     if (drawAxis) {
@@ -20,6 +20,7 @@
  ***************************************************************************/
 #include "snapmodel.hpp"
 #include <QDebug>
+#include <algorithm>
 #include <climits>
 #include <cstdlib>
 
@@ -31,6 +32,10 @@ SnapModel::SnapModel() = default;
 
 void SnapModel::addPoint(int position)
 {
+    if (m_batching) {
+        m_pending.push_back(position);
+        return;
+    }
     if (m_snaps.count(position) == 0) {
         m_snaps[position] = 1;
     } else {
@@ -40,6 +45,7 @@ void SnapModel::addPoint(int position)
 
 void SnapModel::removePoint(int position)
 {
+    flushPending();
     Q_ASSERT(m_snaps.count(position) > 0);
     if (m_snaps[position] == 1) {
         m_snaps.erase(position);
@@ -50,6 +56,7 @@ void SnapModel::removePoint(int position)
 
 int SnapModel::getClosestPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return -1;
     }
@@ -70,6 +77,7 @@ int SnapModel::getClosestPoint(int position)
 
 int SnapModel::getNextPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return position;
     }
@@ -83,6 +91,7 @@ int SnapModel::getNextPoint(int position)
 
 int SnapModel::getPreviousPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return 0;
     }
@@ -95,6 +104,30 @@ int SnapModel::getPreviousPoint(int position)
     return (int)prev;
 }
 
+void SnapModel::setBatching(bool batching)
+{
+    m_batching = batching;
+    if (!batching) {
+        flushPending();
+    }
+}
+
+void SnapModel::flushPending()
+{
+    if (m_pending.empty()) {
+        return;
+    }
+    std::sort(m_pending.begin(), m_pending.end());
+    // Points are sorted, so each one belongs right after the previous one
+    auto hint = m_snaps.begin();
+    for (int position : m_pending) {
+        auto it = m_snaps.emplace_hint(hint, position, 0);
+        it->second++;
+        hint = std::next(it);
+    }
+    m_pending.clear();
+}
+
 void SnapModel::ignore(const std::vector<int> &pts)
 {
     for (int pt : pts) {
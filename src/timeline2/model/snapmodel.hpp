@@ -88,14 +88,29 @@ public:
     int proposeSize(int in, int out, int size, bool right, int maxSnapDist);
     int proposeSize(int in, int out, const std::vector<int> boundaries, int size, bool right, int maxSnapDist);
 
+    /* @brief While batching, added points are only queued. They are registered all at once, in position order, when batching stops
+       or before any other access to the snap points.
+     */
+    void setBatching(bool batching);
+
     // For testing only
-    std::map<int, int> _snaps() { return m_snaps; }
+    std::map<int, int> _snaps()
+    {
+        flushPending();
+        return m_snaps;
+    }
 
 private:
+    /* @brief Registers the queued points */
+    void flushPending();
+
     std::map<int, int> m_snaps; // This represents the snappoints internally. The keys are the positions and the values are the number of elements at this
                                 // position. Note that it is important that the datastructure is ordered. QMap is NOT ordered, and therefore not suitable.
 
     std::vector<int> m_ignore;
+
+    bool m_batching = false;
+    std::vector<int> m_pending;
 };
 
 #endif
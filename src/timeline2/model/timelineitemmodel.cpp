@@ -590,6 +590,9 @@ bool TimelineItemModel::loadGroups(const QString &groupsData)
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, bool start, bool duration, bool updateThumb)
 {
+    if (m_bulkLoading) {
+        return;
+    }
     QVector<int> roles;
     if (start) {
         roles.push_back(TimelineModel::StartRole);
@@ -608,6 +611,9 @@ void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelInd
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
 {
+    if (m_bulkLoading) {
+        return;
+    }
     emit dataChanged(topleft, bottomright, roles);
 }
 
@@ -673,26 +679,45 @@ void TimelineItemModel::buildTrackCompositing(bool rebuild)
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, int role)
 {
+    if (m_bulkLoading) {
+        return;
+    }
     emit dataChanged(topleft, bottomright, {role});
 }
 
 void TimelineItemModel::_beginRemoveRows(const QModelIndex &i, int j, int k)
 {
+    if (m_bulkLoading) {
+        // Inside the model reset started by bulk loading
+        return;
+    }
     // qDebug()<<"FORWARDING beginRemoveRows"<<i<<j<<k;
     beginRemoveRows(i, j, k);
 }
 void TimelineItemModel::_beginInsertRows(const QModelIndex &i, int j, int k)
 {
+    if (m_bulkLoading) {
+        // Inside the model reset started by bulk loading
+        return;
+    }
     // qDebug()<<"FORWARDING beginInsertRows"<<i<<j<<k;
     beginInsertRows(i, j, k);
 }
 void TimelineItemModel::_endRemoveRows()
 {
+    if (m_bulkLoading) {
+        // Inside the model reset started by bulk loading
+        return;
+    }
     // qDebug()<<"FORWARDING endRemoveRows";
     endRemoveRows();
 }
 void TimelineItemModel::_endInsertRows()
 {
+    if (m_bulkLoading) {
+        // Inside the model reset started by bulk loading
+        return;
+    }
     // qDebug()<<"FORWARDING endinsertRows";
     endInsertRows();
 }
@@ -702,3 +727,13 @@ void TimelineItemModel::_resetView()
     beginResetModel();
     endResetModel();
 }
+
+void TimelineItemModel::_beginResetView()
+{
+    beginResetModel();
+}
+
+void TimelineItemModel::_endResetView()
+{
+    endResetModel();
+}
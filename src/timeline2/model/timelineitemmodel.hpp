@@ -111,6 +111,8 @@ public:
     void _endRemoveRows() override;
     void _endInsertRows() override;
     void _resetView() override;
+    void _beginResetView() override;
+    void _endResetView() override;
 
 protected:
     // This is an helper function that finishes a construction of a freshly created TimelineItemModel
@@ -106,6 +106,7 @@ int TimelineModel::seekDuration = 30000;
 TimelineModel::TimelineModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack> undo_stack)
     : QAbstractItemModel_shared_from_this()
     , m_blockRefresh(false)
+    , m_bulkLoading(false)
     , m_tractor(new Mlt::Tractor(*profile))
     , m_masterStack(nullptr)
     , m_snaps(new SnapModel())
@@ -2719,7 +2720,7 @@ bool TimelineModel::isGroup(int id) const
 
 void TimelineModel::updateDuration()
 {
-    if (m_closing) {
+    if (m_closing || m_bulkLoading) {
         return;
     }
     int current = m_blackClip->get_playtime() - TimelineModel::seekDuration;
@@ -2764,6 +2765,28 @@ bool TimelineModel::requestReset(Fun &undo, Fun &redo)
     return ok;
 }
 
+void TimelineModel::setBulkLoading(bool loading)
+{
+    if (m_bulkLoading == loading) {
+        return;
+    }
+    if (loading) {
+        // Rows are inserted silently, the view must not query the model until loading is done
+        _beginResetView();
+    }
+    m_bulkLoading = loading;
+    m_snaps->setBatching(loading);
+    if (!loading) {
+        updateDuration();
+        _endResetView();
+    }
+}
+
+bool TimelineModel::isBulkLoading() const
+{
+    return m_bulkLoading;
+}
+
 void TimelineModel::setUndoStack(std::weak_ptr<DocUndoStack> undo_stack)
 {
     m_undoStack = std::move(undo_stack);
@@ -3449,7 +3472,7 @@ std::shared_ptr<Mlt::Producer> TimelineModel::producer()
 
 void TimelineModel::checkRefresh(int start, int end)
 {
-    if (m_blockRefresh) {
+    if (m_blockRefresh || m_bulkLoading) {
         return;
     }
     int currentPos = tractor()->position();
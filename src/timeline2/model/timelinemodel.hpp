@@ -535,6 +535,13 @@ public:
     /* @brief Removes all the elements on the timeline (tracks and clips)
      */
     bool requestReset(Fun &undo, Fun &redo);
+    /* @brief Enters or leaves bulk loading, used when building the timeline from a project file.
+       Loading happens inside a model reset: the view is not notified of individual changes and must not query the model until it is left.
+       Monitor refreshes and duration updates are skipped, and snap points are queued.
+       Leaving it registers the queued snap points, updates the duration and ends the reset.
+     */
+    void setBulkLoading(bool loading);
+    bool isBulkLoading() const;
     /* @brief Updates the current the pointer to the current undo_stack
        Must be called for example when the doc change
     */
@@ -761,6 +768,7 @@ protected:
     void clearAssetView(int itemId);
 
     bool m_blockRefresh;
+    bool m_bulkLoading;
 
 signals:
     /* @brief signal triggered by clearAssetView */
@@ -843,5 +851,8 @@ protected:
     virtual QModelIndex makeCompositionIndexFromID(int) const = 0;
     virtual QModelIndex makeTrackIndexFromID(int) const = 0;
     virtual void _resetView() = 0;
+    /** @brief Start and finish a model reset, used to wrap bulk loading */
+    virtual void _beginResetView() = 0;
+    virtual void _endResetView() = 0;
 };
 #endif
@@ -144,8 +144,8 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
             std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
             m_allClips[clip->getId()] = clip; // store clip
             // update clip position and track
-            clip->setPosition(position);
             clip->setSubPlaylistIndex(subPlaylist);
+            setClipPosition(clipId, position);
             int new_in = clip->getPosition();
             int new_out = new_in + clip->getPlaytime();
             ptr->m_snaps->addPoint(new_in);
@@ -323,6 +323,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
         auto prod = m_playlists[target_track].replace_with_blank(target_clip);
         if (prod != nullptr) {
             m_playlists[target_track].consolidate_blanks();
+            removeClipPosition(clipId);
             m_allClips[clipId]->setCurrentTrackId(-1);
             m_allClips[clipId]->setSubPlaylistIndex(-1);
             m_allClips.erase(clipId);
@@ -565,7 +566,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             // The second is parameter is delta - 1 because this function expects an out time, which is basically size - 1
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
-                m_allClips[clipId]->setPosition(clip_position + delta);
+                setClipPosition(clipId, clip_position + delta);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -648,7 +649,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     err = m_playlists[target_track].resize_clip(target_clip_mutable, in, out);
                 }
                 if (!right && err == 0) {
-                    m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    setClipPosition(clipId, m_playlists[target_track].clip_start(target_clip_mutable));
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -727,19 +728,44 @@ std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
     std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    for (const auto &index : m_clipsPos) {
+        auto it = index.lower_bound({position, INT_MIN});
+        // Clips of a sub playlist never overlap, so only the ones right before position can still cover it
+        auto prev = it;
+        while (prev != index.begin()) {
+            --prev;
+            if (prev->first + m_allClips.at(prev->second)->getPlaytime() - 1 < position) {
+                break;
+            }
+            if (end == -1 || prev->first < end) {
+                ids.insert(prev->second);
+            }
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
+        for (; it != index.end() && (end == -1 || it->first < end); ++it) {
+            ids.insert(it->second);
         }
     }
     return ids;
 }
 
+void TrackModel::setClipPosition(int clipId, int position)
+{
+    removeClipPosition(clipId);
+    const auto &clip = m_allClips.at(clipId);
+    clip->setPosition(position);
+    int subPlaylist = clip->getSubPlaylistIndex();
+    if (subPlaylist == 0 || subPlaylist == 1) {
+        m_clipsPos[subPlaylist].emplace(position, clipId);
+    }
+}
+
+void TrackModel::removeClipPosition(int clipId)
+{
+    int position = m_allClips.at(clipId)->getPosition();
+    m_clipsPos[0].erase({position, clipId});
+    m_clipsPos[1].erase({position, clipId});
+}
+
 int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
@@ -752,17 +778,21 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    // Compositions of a track never overlap, so only the ones right before position can still cover it
+    auto it = m_compoPos.lower_bound(position);
+    auto prev = it;
+    while (prev != m_compoPos.begin()) {
+        --prev;
+        if (prev->first + m_allCompositions.at(prev->second)->getPlaytime() - 1 < position) {
+            break;
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            
-            ids.insert(compo.first);
+        if (end == -1 || prev->first < end) {
+            ids.insert(prev->second);
         }
     }
+    for (; it != m_compoPos.end() && (end == -1 || it->first < end); ++it) {
+        ids.insert(it->second);
+    }
     return ids;
 }
 
@@ -821,6 +851,10 @@ bool TrackModel::checkConsistency()
         clips.emplace_back(c.second->getPosition(), c.first);
     }
     std::sort(clips.begin(), clips.end());
+    if (m_clipsPos[0].size() + m_clipsPos[1].size() != clips.size()) {
+        qDebug() << "Error: the number of indexed clip positions doesn't match number of clips";
+        return false;
+    }
     int last_out = 0;
     for (size_t i = 0; i < clips.size(); ++i) {
         auto cur_clip = m_allClips[clips[i].second];
@@ -834,6 +868,10 @@ bool TrackModel::checkConsistency()
             }
         }
         int cur_playlist = cur_clip->getSubPlaylistIndex();
+        if (m_clipsPos[cur_playlist].count(clips[i]) == 0) {
+            qDebug() << "ERROR: the position of clip " << clips[i].second << " is not properly indexed";
+            return false;
+        }
         int clip_index = m_playlists[cur_playlist].get_clip_index_at(clips[i].first);
         if (m_playlists[cur_playlist].is_blank(clip_index)) {
             qDebug() << "ERROR: Found blank when clip was required at position " << clips[i].first;
@@ -29,6 +29,7 @@
 #include <memory>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltTractor.h>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -269,6 +270,12 @@ protected:
     /* @brief Returns true if we have a blank at position for duration */
     bool isAvailable(int position, int duration);
 
+private:
+    /* @brief Moves the given clip to position, keeping the position index up to date */
+    void setClipPosition(int clipId, int position);
+    /* @brief Removes the given clip from the position index */
+    void removeClipPosition(int clipId);
+
 public slots:
     /*Delete the current track and all its associated clips */
     void slotDelete();
@@ -288,6 +295,8 @@ private:
         m_allCompositions; /*this is important to keep an
                                    ordered structure to store the clips, since we use their ids order as row order*/
 
+    std::set<std::pair<int, int>> m_clipsPos[2]; // (position, clipId) of the clips of each sub playlist, ordered by position. Used for range queries
+
     std::map<int, int> m_compoPos; // We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
                                    // those positions here to check for moves and resize
 
@@ -30,6 +30,7 @@
 #include <QProcess>
 #include <QStandardPaths>
 #include <QCollator>
+#include <QThread>
 
 PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tractor)
     : QObject()
@@ -39,12 +40,11 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
     , m_previewTrack(nullptr)
     , m_overlayTrack(nullptr)
     , m_previewTrackIndex(-1)
+    , m_maxWorkers(qBound(1, QThread::idealThreadCount() / 2, 8))
     , m_initialized(false)
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
-    QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
-
 
     // Find path for Kdenlive renderer
 #ifdef Q_OS_WIN
@@ -58,8 +58,6 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
             m_renderer = QStringLiteral("kdenlive_render");
         }
     }
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
-    connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
 }
 
 PreviewManager::~PreviewManager()
@@ -468,12 +466,12 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     if (add) {
         qDebug() << "CHUNKS CHANGED: " << m_dirtyChunks;
         m_controller->dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (m_workers.isEmpty() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
         // Remove processed chunks
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool isRendering = !m_workers.isEmpty();
         m_previewGatherTimer.stop();
         abortRendering();
         m_tractor->lock();
@@ -503,16 +501,16 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
 
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    if (m_workers.isEmpty()) {
         return;
     }
     qDebug() << "/// ABORTING RENDEIGN 1\nRRRRRRRRRR";
-    emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
-        m_previewProcess.kill();
-        m_previewProcess.waitForFinished();
+    while (!m_workers.isEmpty()) {
+        stopWorker(0);
     }
+    QFile::remove(m_sceneList);
+    m_sceneList.clear();
+    updateWorkingPreview();
     // Re-init time estimation
     emit previewRender(-1, QString(), 1000);
 }
@@ -524,8 +522,8 @@ void PreviewManager::startPreviewRender()
         m_controller->addPreviewRange(true);
     }
     if (!m_dirtyChunks.isEmpty()) {
-        // Abort any rendering
-        abortRendering();
+        // Running workers keep their current chunk, new chunks go to workers using the new scene
+        retireWorkers();
         m_waitingThumbs.clear();
         // clear log
         m_errorLog.clear();
@@ -537,22 +535,31 @@ void PreviewManager::startPreviewRender()
     }
 }
 
-void PreviewManager::receivedStderr()
+void PreviewManager::receivedStderr(QProcess *process)
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'));
+    QStringList resultList = QString::fromLocal8Bit(process->readAllStandardError()).split(QLatin1Char('\n'));
     for (auto &result : resultList) {
         qDebug() << "GOT PROCESS RESULT: " << result;
         if (result.startsWith(QLatin1String("START:"))) {
-            workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
-            qDebug() << "// GOT START INFO: " << workingPreview;
-            m_controller->workingPreviewChanged();
+            continue;
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
+            int ix = workerIndex(process);
+            if (ix < 0) {
+                return;
+            }
+            m_workers[ix].chunk = -1;
             m_processedChunks++;
             QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             qDebug() << "---------------\nJOB PROGRRESS: " << m_chunksToRender << ", " << m_processedChunks << " = "
-                     << (100 * m_processedChunks / m_chunksToRender);
-            emit previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
+                     << (100 * m_processedChunks / qMax(1, m_chunksToRender));
+            emit previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), qMin(1000, 1000 * m_processedChunks / qMax(1, m_chunksToRender)));
+            if (workerIndex(process) < 0) {
+                // Rendering was aborted on a corrupted chunk
+                return;
+            }
+            updateWorkingPreview();
+            dispatchChunks();
         } else {
             m_errorLog.append(result);
         }
@@ -566,51 +573,211 @@ void PreviewManager::doPreviewRender(const QString &scene)
     if (m_dirtyChunks.isEmpty()) {
         return;
     }
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
-
-    QStringList chunks;
-    for (QVariant &frame : m_dirtyChunks) {
-        chunks << frame.toString();
-    }
+    m_sceneList = scene;
     m_chunksToRender = m_dirtyChunks.count();
     m_processedChunks = 0;
+    pCore->currentDoc()->previewProgress(0);
+    dispatchChunks();
+}
+
+void PreviewManager::dispatchChunks()
+{
+    if (m_sceneList.isEmpty()) {
+        return;
+    }
+    QList<int> inFlight;
+    int liveWorkers = 0;
+    for (const PreviewWorker &worker : m_workers) {
+        if (worker.chunk >= 0) {
+            inFlight << worker.chunk;
+        }
+        if (!worker.retired) {
+            liveWorkers++;
+        }
+    }
+    const int position = pCore->getTimelinePosition();
+    while (true) {
+        // Chunks next to the playhead first
+        int chunk = -1;
+        for (const QVariant &frame : m_dirtyChunks) {
+            int f = frame.toInt();
+            if (!inFlight.contains(f) && (chunk < 0 || qAbs(f - position) < qAbs(chunk - position))) {
+                chunk = f;
+            }
+        }
+        if (chunk < 0) {
+            break;
+        }
+        int ix = -1;
+        for (int i = 0; i < m_workers.count(); ++i) {
+            if (!m_workers.at(i).retired && m_workers.at(i).chunk < 0) {
+                ix = i;
+                break;
+            }
+        }
+        if (ix < 0) {
+            if (liveWorkers >= m_maxWorkers) {
+                break;
+            }
+            if (!startWorker()) {
+                break;
+            }
+            liveWorkers++;
+            ix = m_workers.count() - 1;
+        }
+        m_workers[ix].chunk = chunk;
+        m_workers[ix].process->write(QByteArray::number(chunk) + '\n');
+        inFlight << chunk;
+    }
+    // Idle workers exit once their input is closed
+    for (PreviewWorker &worker : m_workers) {
+        if (worker.chunk < 0 && !worker.retired) {
+            worker.retired = true;
+            worker.process->closeWriteChannel();
+        }
+    }
+    updateWorkingPreview();
+}
+
+bool PreviewManager::startWorker()
+{
+    auto *process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardError, this, [this, process]() { receivedStderr(process); });
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process](int, QProcess::ExitStatus status) { processEnded(process, status); });
+    // finished is not emitted when the renderer cannot be started
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            workerFailed(process);
+        }
+    });
     int chunkSize = KdenliveSettings::timelinechunks();
+    // Chunks are sent through stdin, so that the scene is only loaded once per process
     QStringList args{KdenliveSettings::rendererpath(),
-                     scene,
+                     m_sceneList,
                      m_cacheDir.absolutePath(),
                      QStringLiteral("-split"),
-                     chunks.join(QLatin1Char(',')),
+                     QStringLiteral("-"),
                      QString::number(chunkSize - 1),
                      pCore->getCurrentProfilePath(),
                      m_extension,
                      m_consumerParams.join(QLatin1Char(' '))};
     qDebug() << " -  - -STARTING PREVIEW JOBS: " << args;
-    pCore->currentDoc()->previewProgress(0);
-    m_previewProcess.start(m_renderer, args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
+    m_workers << PreviewWorker{process, -1, false, m_sceneList};
+    process->start(m_renderer, args);
+    // The failure might already have been handled
+    return workerIndex(process) >= 0;
+}
+
+void PreviewManager::workerFailed(QProcess *process)
+{
+    int ix = workerIndex(process);
+    if (ix < 0) {
+        return;
     }
+    const QString error = process->errorString();
+    qDebug() << "// PREVIEW PROCESS FAILED TO START: " << error;
+    stopWorker(ix);
+    // Other workers would fail the same way, don't start new ones
+    retireWorkers();
+    const QString scene = m_sceneList;
+    m_sceneList.clear();
+    releaseSceneList(scene);
+    updateWorkingPreview();
+    emit previewRender(0, error, -1);
 }
 
-void PreviewManager::processEnded(int, QProcess::ExitStatus status)
+int PreviewManager::workerIndex(QProcess *process) const
 {
-    qDebug() << "// PROCESS IS FINISHED!!!";
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+    for (int i = 0; i < m_workers.count(); ++i) {
+        if (m_workers.at(i).process == process) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PreviewManager::stopWorker(int ix)
+{
+    PreviewWorker worker = m_workers.takeAt(ix);
+    worker.process->disconnect(this);
+    worker.process->kill();
+    worker.process->waitForFinished();
+    if (worker.chunk >= 0) {
+        // The renderer does not overwrite existing chunks, remove the partial one
+        m_cacheDir.remove(QStringLiteral("%1.%2").arg(worker.chunk).arg(m_extension));
+    }
+    worker.process->deleteLater();
+    releaseSceneList(worker.sceneList);
+}
+
+void PreviewManager::retireWorkers()
+{
+    for (PreviewWorker &worker : m_workers) {
+        if (!worker.retired) {
+            worker.retired = true;
+            worker.process->closeWriteChannel();
+        }
+    }
+}
+
+void PreviewManager::releaseSceneList(const QString &sceneList)
+{
+    if (sceneList.isEmpty() || sceneList == m_sceneList) {
+        return;
+    }
+    for (const PreviewWorker &worker : m_workers) {
+        if (worker.sceneList == sceneList) {
+            return;
+        }
+    }
     QFile::remove(sceneList);
-    if (status == QProcess::QProcess::CrashExit) {
+}
+
+void PreviewManager::updateWorkingPreview()
+{
+    int working = -1;
+    for (const PreviewWorker &worker : m_workers) {
+        if (worker.chunk >= 0 && (working < 0 || worker.chunk < working)) {
+            working = worker.chunk;
+        }
+    }
+    if (working != workingPreview) {
+        workingPreview = working;
+        m_controller->workingPreviewChanged();
+    }
+}
+
+void PreviewManager::processEnded(QProcess *process, QProcess::ExitStatus status)
+{
+    qDebug() << "// PROCESS IS FINISHED!!!";
+    int ix = workerIndex(process);
+    if (ix < 0) {
+        return;
+    }
+    PreviewWorker worker = m_workers.takeAt(ix);
+    process->deleteLater();
+    // The scene of a retired worker is not the current one
+    releaseSceneList(worker.sceneList);
+    if (status == QProcess::CrashExit) {
         qDebug() << "// PROCESS CRASHED!!!!!!";
         pCore->currentDoc()->previewProgress(-1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
+        if (worker.chunk >= 0) {
+            const QString fileName = QStringLiteral("%1.%2").arg(worker.chunk).arg(m_extension);
             if (m_cacheDir.exists(fileName)) {
                 m_cacheDir.remove(fileName);
             }
         }
-    } else {
+    } else if (m_workers.isEmpty()) {
         pCore->currentDoc()->previewProgress(1000);
     }
-    workingPreview = -1;
-    m_controller->workingPreviewChanged();
+    if (m_workers.isEmpty()) {
+        QFile::remove(m_sceneList);
+        m_sceneList.clear();
+        updateWorkingPreview();
+    } else {
+        dispatchChunks();
+    }
 }
 
 void PreviewManager::slotProcessDirtyChunks()
@@ -651,7 +818,19 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
 
     std::sort(m_renderedChunks.begin(), m_renderedChunks.end());
     m_previewGatherTimer.stop();
-    abortRendering();
+    // Only cancel the workers rendering an invalidated chunk, the others can finish their current chunk
+    for (int i = m_workers.count() - 1; i >= 0; --i) {
+        int chunk = m_workers.at(i).chunk;
+        if (chunk >= start && chunk <= end) {
+            stopWorker(i);
+        }
+    }
+    retireWorkers();
+    // The scene is outdated, new workers will only be started on the next one. Its file is deleted when its last worker exits
+    const QString scene = m_sceneList;
+    m_sceneList.clear();
+    releaseSceneList(scene);
+    updateWorkingPreview();
     m_tractor->lock();
     bool hasPreview = m_previewTrack != nullptr;
     bool chunksChanged = false;
@@ -748,12 +927,12 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
-    emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (workingPreview >= 0) {
-        workingPreview = -1;
-        m_controller->workingPreviewChanged();
+    while (!m_workers.isEmpty()) {
+        stopWorker(0);
     }
+    QFile::remove(m_sceneList);
+    m_sceneList.clear();
+    updateWorkingPreview();
     emit previewRender(0, m_errorLog, -1);
     m_cacheDir.remove(fileName);
     if (!m_dirtyChunks.contains(frame)) {
@@ -84,7 +84,7 @@ public:
     int setOverlayTrack(Mlt::Playlist *overlay);
     /** @brief Remove the effect compare overlay track */
     void removeOverlayTrack();
-    /** @brief The current preview chunk being processed, -1 if none */
+    /** @brief The first preview chunk being processed, -1 if none */
     int workingPreview;
     /** @brief Returns the list of existing chunks */
     QPair<QStringList, QStringList> previewChunks() const;
@@ -100,8 +100,23 @@ private:
     int m_previewTrackIndex;
     /** @brief: The kdenlive renderer app. */
     QString m_renderer;
-    /** @brief: The kdenlive timeline preview process. */
-    QProcess m_previewProcess;
+    /** @brief: A timeline preview process, rendering the chunks it is given one at a time. */
+    struct PreviewWorker
+    {
+        QProcess *process;
+        /** @brief: The chunk being rendered, -1 if idle. */
+        int chunk;
+        /** @brief: The scene of the worker is outdated, it does not get new chunks. */
+        bool retired;
+        /** @brief: The scene file loaded by the worker, deleted when its last worker exits. */
+        QString sceneList;
+    };
+    /** @brief: The timeline preview processes. */
+    QList<PreviewWorker> m_workers;
+    /** @brief: The maximum number of concurrent preview processes. */
+    int m_maxWorkers;
+    /** @brief: The scene loaded by new preview processes. */
+    QString m_sceneList;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -126,6 +141,23 @@ private:
     void reloadChunks(const QVariantList chunks);
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
+    /** @brief: Give the dirty chunks closest to the playhead to idle workers, starting workers as needed. */
+    void dispatchChunks();
+    /** @brief: Start a preview process on the current scene. Returns false if it failed to start. */
+    bool startWorker();
+    /** @brief: A preview process could not be started, stop it and report the error. */
+    void workerFailed(QProcess *process);
+    int workerIndex(QProcess *process) const;
+    /** @brief: Kill a preview process, deleting its unfinished chunk. */
+    void stopWorker(int ix);
+    /** @brief: Current workers finish their chunk but do not get new ones. */
+    void retireWorkers();
+    /** @brief: Delete a scene file if it is neither the current scene nor used by a worker. */
+    void releaseSceneList(const QString &sceneList);
+    /** @brief: Process preview rendering output. */
+    void receivedStderr(QProcess *process);
+    void processEnded(QProcess *process, QProcess::ExitStatus status);
+    void updateWorkingPreview();
     /** @brief: Re-enable timeline preview track. */
     void enable();
     /** @brief: Temporarily disable timeline preview track. */
@@ -140,9 +172,6 @@ private slots:
     void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
-    /** @brief: Process preview rendering output. */
-    void receivedStderr();
-    void processEnded(int, QProcess::ExitStatus status);
 
 public slots:
     /** @brief: Prepare and start rendering. */
@@ -155,7 +184,6 @@ protected:
     QVariantList m_dirtyChunks;
 
 signals:
-    void abortPreview();
     void cleanupOldPreviews();
     void previewRender(int frame, const QString &file, int progress);
 };
@@ -46,13 +46,14 @@ Row {
             channels: clipRoot.audioChannels
             binId: clipRoot.binId
             audioStream: Math.abs(clipRoot.audioStream)
+            framesPerPixel: Math.abs(clipRoot.speed) / clipRoot.timeScale
             isFirstChunk: index == 0
             showItem: waveform.visible && (index * waveform.maxWidth < (clipRoot.scrollStart + scrollView.width)) && ((index * waveform.maxWidth + width) > clipRoot.scrollStart)
             format: timeline.audioThumbFormat
             drawInPoint: Math.max(0, clipRoot.scrollStart - (index * waveform.maxWidth))
             drawOutPoint: (clipRoot.scrollStart + scrollView.width - (index * waveform.maxWidth))
-            waveInPoint: clipRoot.speed < 0 ? (Math.round(clipRoot.outPoint - (index * waveform.maxWidth / clipRoot.timeScale) * Math.abs(clipRoot.speed)) * channels) : (Math.round((clipRoot.inPoint + (index * waveform.maxWidth / clipRoot.timeScale)) * clipRoot.speed) * channels)
-            waveOutPoint: clipRoot.speed < 0 ? (waveInPoint - Math.ceil(width / clipRoot.timeScale * Math.abs(clipRoot.speed)) * channels) : (waveInPoint + Math.round(width / clipRoot.timeScale * clipRoot.speed) * channels)
+            waveInPoint: clipRoot.speed < 0 ? Math.round(clipRoot.outPoint - (index * waveform.maxWidth / clipRoot.timeScale) * Math.abs(clipRoot.speed)) : Math.round((clipRoot.inPoint + (index * waveform.maxWidth / clipRoot.timeScale)) * clipRoot.speed)
+            waveOutPoint: clipRoot.speed < 0 ? (waveInPoint - Math.ceil(width / clipRoot.timeScale * Math.abs(clipRoot.speed))) : (waveInPoint + Math.round(width / clipRoot.timeScale * clipRoot.speed))
             fillColor: activePalette.text
         }
     }
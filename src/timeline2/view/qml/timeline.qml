@@ -305,6 +305,10 @@ Rectangle {
         playhead.opacity = seekingFinished ? 1 : 0.5
     }
 
+    // Only the clips around the visible area get a delegate
+    onScrollMinChanged: multitrack.setVisibleRange(scrollMin, scrollMax)
+    onScrollMaxChanged: multitrack.setVisibleRange(scrollMin, scrollMax)
+
     //onCurrentTrackChanged: timeline.selection = []
     onTimeScaleChanged: {
         if (root.zoomOnMouse >= 0) {
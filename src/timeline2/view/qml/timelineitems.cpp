@@ -22,12 +22,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "kdenlivesettings.h"
 #include "core.h"
+#include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
+#include "utils/thumbnailatlas.hpp"
+#include "utils/waveformtilecache.hpp"
+#include <QMutex>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #include <QPainter>
 #include <QPainterPath>
 #include <QQuickPaintedItem>
+#include <QQuickWindow>
+#include <QSGDynamicTexture>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
 #include <QElapsedTimer>
 #include <cmath>
+#include <map>
+#include <unordered_map>
 
 const QStringList chanelNames{"L", "R", "C", "LFE", "BL", "BR"};
 
@@ -86,6 +98,7 @@ class TimelineWaveform : public QQuickPaintedItem
     Q_PROPERTY(QString binId MEMBER m_binId NOTIFY levelsChanged)
     Q_PROPERTY(int waveOutPoint MEMBER m_outPoint)
     Q_PROPERTY(int audioStream MEMBER m_stream)
+    Q_PROPERTY(double framesPerPixel MEMBER m_framesPerPixel NOTIFY propertyChanged)
     Q_PROPERTY(bool format MEMBER m_format NOTIFY propertyChanged)
     Q_PROPERTY(bool showItem READ showItem  WRITE setShowItem NOTIFY showItemChanged)
     Q_PROPERTY(bool isFirstChunk MEMBER m_firstChunk)
@@ -97,18 +110,24 @@ public:
         // setClip(true);
         setEnabled(false);
         m_showItem = false;
-        m_precisionFactor = 1;
         //setRenderTarget(QQuickPaintedItem::FramebufferObject);
         //setMipmap(true);
         setTextureSize(QSize(1, 1));
         connect(this, &TimelineWaveform::levelsChanged, [&]() {
-            if (!m_binId.isEmpty() && m_audioLevels.isEmpty() && m_stream >= 0) {
+            if (!m_binId.isEmpty() && m_stream >= 0) {
+                // Clip changed or its audio was reloaded, fetch the peaks again
+                m_peaks.reset();
                 update();
             }
         });
         connect(this, &TimelineWaveform::propertyChanged, [&]() {
             update();
         });
+        connect(WaveformTileCache::get().get(), &WaveformTileCache::tileReady, this, [this](const QString &clipHash) {
+            if (m_showItem && clipHash == m_clipHash) {
+                update();
+            }
+        });
     }
     bool showItem() const
     {
@@ -131,121 +150,63 @@ public:
         if (!m_showItem || m_binId.isEmpty()) {
             return;
         }
-        if (m_audioLevels.isEmpty() && m_stream >= 0) {
-            m_audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
-            if (m_audioLevels.isEmpty()) {
-                return;
+        if (!m_peaks && m_stream >= 0) {
+            std::shared_ptr<ProjectClip> clip = pCore->projectItemModel()->getClipByBinID(m_binId);
+            if (clip) {
+                m_peaks = clip->audioPeaks(m_stream);
+                m_clipHash = clip->hash();
             }
         }
-        qreal indicesPrPixel = qreal(m_outPoint - m_inPoint) / width() * m_precisionFactor;
-        //qDebug()<<"== GOT DIMENSIONS FOR WAVE: "<<(m_outPoint - m_inPoint)<<", WID: "<<width();
-        QPen pen = painter->pen();
-        pen.setColor(m_color);
-        painter->setBrush(m_color);
-        pen.setCapStyle(Qt::FlatCap);
-        double increment = qMax(1., 1. / qAbs(indicesPrPixel));
-        int h = height();
-        double offset = 0;
-        bool pathDraw = increment > 1.2;
-        if (increment > 1. && !pathDraw) {
-            pen.setWidth(ceil(increment));
-            offset = pen.width() / 2.;
-        } else if (pathDraw) {
-            pen.setWidthF(0);
+        if (!m_peaks) {
+            return;
         }
-        painter->setPen(pen);
-        QPainterPath path;
-        if (!KdenliveSettings::displayallchannels()) {
-            // Draw merged channels
-            double i = 0;
-            double level;
-            int j = 0;
-            if (m_drawInPoint > 0) {
-                j = m_drawInPoint / increment;
-            }
-            if (pathDraw) {
-                path.moveTo(j - 1, height());
-            }
-            for (; i <= width() && i < m_drawOutPoint; j++) {
-                i = j * increment;
-                int idx = m_precisionFactor * m_inPoint + int(i * indicesPrPixel);
-                idx += idx % m_channels;
-                i -= offset;
-                if (idx + m_channels >= m_audioLevels.length() || idx < 0) {
-                    break;
-                }
-                level = m_audioLevels.at(idx) / 255.;
-                for (int k = 1; k < m_channels; k++) {
-                    level = qMax(level, m_audioLevels.at(idx + k) / 255.);
-                }
-                if (pathDraw) {
-                    path.lineTo(i, height() - level * height());
-                } else {
-                    painter->drawLine(i, h, i, h - (h * level));
-                }
+        // In and out points are frames, out is before in for reversed clips
+        const bool reversed = m_outPoint < m_inPoint;
+        double framesPerPixel = m_framesPerPixel > 0 ? m_framesPerPixel : qAbs(qreal(m_outPoint - m_inPoint) / width());
+        WaveformTileCache::TileKey key;
+        key.clipHash = m_clipHash;
+        key.stream = m_stream;
+        key.zoom = WaveformTileCache::zoomKey(framesPerPixel);
+        key.height = int(height());
+        key.channels = m_channels;
+        key.separateChannels = KdenliveSettings::displayallchannels();
+        key.color = m_color.rgba();
+        if (key.zoom <= 0 || key.height <= 0) {
+            return;
+        }
+        // Tiles are aligned on the source frames, use the rounded scale so that they match exactly
+        framesPerPixel = key.zoom / 1000000.;
+        const double origin = m_inPoint / framesPerPixel;
+        const int first = qMax(0, m_drawInPoint);
+        const int last = qMin(int(ceil(width())), m_drawOutPoint);
+        if (last <= first) {
+            return;
+        }
+        const double from = reversed ? origin - last : origin + first;
+        const double to = reversed ? origin - first : origin + last;
+        const int tileWidth = WaveformTileCache::TileWidth;
+        for (int t = int(floor(from / tileWidth)); t <= int(floor(to / tileWidth)); t++) {
+            key.tile = t;
+            // Missing tiles are rendered in the background, we will be updated when they are ready
+            QImage img = WaveformTileCache::get()->tile(key, m_peaks);
+            if (img.isNull()) {
+                continue;
             }
-            if (pathDraw) {
-                path.lineTo(i, height());
-                painter->drawPath(path);
+            if (reversed) {
+                painter->save();
+                painter->translate(origin - t * tileWidth, 0);
+                painter->scale(-1, 1);
+                painter->drawImage(QPointF(0, 0), img);
+                painter->restore();
+            } else {
+                painter->drawImage(QPointF(t * tileWidth - origin, 0), img);
             }
-        } else {
+        }
+        if (key.separateChannels && m_firstChunk && m_channels > 1 && m_channels < 7) {
+            painter->setPen(m_color);
             double channelHeight = (double)height() / m_channels;
-            // Draw separate channels
-            double i = 0;
-            double level;
-            QRectF bgRect(0, 0, width(), channelHeight);
-            // Path for vector drawing
-            //qDebug()<<"==== DRAWING FROM: "<<m_drawInPoint<<" - "<<m_drawOutPoint<<", FIRST: "<<m_firstChunk;
             for (int channel = 0; channel < m_channels; channel++) {
-                // y is channel median pos
-                double y = (channel * channelHeight) + channelHeight / 2;
-                path.moveTo(-1, y);
-                painter->setOpacity(0.2);
-                if (channel % 2 == 0) {
-                    // Add dark background on odd channels
-                    bgRect.moveTo(0, channel * channelHeight);
-                    painter->fillRect(bgRect, Qt::black);
-                }
-                // Draw channel median line
-                painter->setOpacity(0.5);
-                pen.setWidthF(0);
-                painter->setPen(pen);
-                painter->drawLine(QLineF(0., y, width(), y));
-                pen.setWidth(ceil(increment));
-                painter->setPen(pathDraw ? Qt::NoPen : pen);
-                painter->setOpacity(1);
-                i = 0;
-                int j = 0;
-                if (m_drawInPoint > 0) {
-                    j = m_drawInPoint / increment;
-                }
-                if (pathDraw) {
-                    path.moveTo(m_drawInPoint - 1, y);
-                }
-                for (; i <= width() && i < m_drawOutPoint; j++) {
-                    i = j * increment;
-                    int idx = m_precisionFactor * m_inPoint + ceil(i * indicesPrPixel);
-                    idx += idx % m_channels;
-                    i -= offset;
-                    idx += channel;
-                    if (idx >= m_audioLevels.length() || idx < 0) break;
-                    if (pathDraw) {
-                        level = m_audioLevels.at(idx) * channelHeight / 510.;
-                        path.lineTo(i, y - level);
-                    } else {
-                        level = m_audioLevels.at(idx) * channelHeight / 510.; // divide height by 510 (2*255) to get height
-                        painter->drawLine(i, y - level, i, y + level);
-                    }
-                }
-                if (pathDraw) {
-                    path.lineTo(i, y);
-                    painter->drawPath(path);
-                    QTransform tr(1, 0, 0, -1, 0, 2 * y);
-                    painter->drawPath(tr.map(path));
-                }
-                if (m_firstChunk && m_channels > 1 && m_channels < 7) {
-                    painter->drawText(2, y + channelHeight / 2, chanelNames[channel]);
-                }
+                painter->drawText(2, (channel + 1) * channelHeight, chanelNames[channel]);
             }
         }
     }
@@ -258,7 +219,9 @@ signals:
     void audioChannelsChanged();
 
 private:
-    QVector<uint8_t> m_audioLevels;
+    std::shared_ptr<const AudioPeakFile> m_peaks;
+    QString m_clipHash;
+    double m_framesPerPixel{0.};
     int m_inPoint;
     int m_outPoint;
     // Pixels outside the view, can be dropped
@@ -269,16 +232,247 @@ private:
     bool m_format;
     bool m_showItem;
     int m_channels;
-    int m_precisionFactor;
     int m_stream;
     bool m_firstChunk;
 };
 
+/* @brief Texture of a thumbnail atlas page, only the thumbnails stored since the previous upload are transferred */
+class AtlasPageTexture : public QSGDynamicTexture
+{
+public:
+    explicit AtlasPageTexture(int page)
+        : m_page(page)
+    {
+    }
+    ~AtlasPageTexture() override
+    {
+        if (m_id != 0 && QOpenGLContext::currentContext()) {
+            QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_id);
+        }
+    }
+    int textureId() const override { return int(m_id); }
+    QSize textureSize() const override { return QSize(ThumbnailAtlas::PageSize, ThumbnailAtlas::PageSize); }
+    bool hasAlphaChannel() const override { return true; }
+    bool hasMipmaps() const override { return false; }
+    void bind() override
+    {
+        QOpenGLContext::currentContext()->functions()->glBindTexture(GL_TEXTURE_2D, m_id);
+        updateBindOptions(m_newTexture);
+        m_newTexture = false;
+    }
+    bool updateTexture() override
+    {
+        QOpenGLContext *context = QOpenGLContext::currentContext();
+        if (context == nullptr) {
+            return false;
+        }
+        QOpenGLFunctions *f = context->functions();
+        if (m_id == 0) {
+            f->glGenTextures(1, &m_id);
+            f->glBindTexture(GL_TEXTURE_2D, m_id);
+            f->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ThumbnailAtlas::PageSize, ThumbnailAtlas::PageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            m_revision = 0;
+            m_newTexture = true;
+        } else if (ThumbnailAtlas::get()->pageRevision(m_page) <= m_revision) {
+            return false;
+        } else {
+            f->glBindTexture(GL_TEXTURE_2D, m_id);
+        }
+        m_revision = ThumbnailAtlas::get()->updatedSlots(m_page, m_revision, [f](const QImage &image, const QRect &rect) {
+            // Atlas pages are stored as RGBA, so a slot can be uploaded as is
+            const QImage part = image.copy(rect);
+            f->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, part.constBits());
+        });
+        return true;
+    }
+
+private:
+    int m_page;
+    GLuint m_id{0};
+    quint64 m_revision{0};
+    bool m_newTexture{false};
+};
+
+// Atlas textures are shared by all the thumbnail items of a window
+static QMutex atlasTexturesMutex;
+static std::unordered_map<QQuickWindow *, std::vector<std::unique_ptr<AtlasPageTexture>>> atlasTextures;
+
+/* @brief Returns the up to date texture of an atlas page for a window, to be called from the render thread */
+static AtlasPageTexture *atlasTexture(QQuickWindow *window, int page)
+{
+    QMutexLocker locker(&atlasTexturesMutex);
+    auto it = atlasTextures.find(window);
+    if (it == atlasTextures.end()) {
+        it = atlasTextures.emplace(window, std::vector<std::unique_ptr<AtlasPageTexture>>()).first;
+        QObject::connect(window, &QQuickWindow::sceneGraphInvalidated, window, [window]() {
+            QMutexLocker lock(&atlasTexturesMutex);
+            atlasTextures.erase(window);
+        }, Qt::DirectConnection);
+    }
+    auto &textures = it->second;
+    while ((int)textures.size() <= page) {
+        textures.emplace_back(new AtlasPageTexture((int)textures.size()));
+    }
+    textures[page]->updateTexture();
+    return textures[page].get();
+}
+
+/* @brief Draws the thumbnails stored in an atlas page */
+class AtlasPageNode : public QSGGeometryNode
+{
+public:
+    AtlasPageNode(int atlasPage, int vertexCount)
+        : page(atlasPage)
+        , m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), vertexCount)
+    {
+        m_geometry.setDrawingMode(QSGGeometry::DrawTriangles);
+        material.setFiltering(QSGTexture::Linear);
+        setGeometry(&m_geometry);
+        setMaterial(&material);
+    }
+    const int page;
+    QSGTextureMaterial material;
+
+private:
+    QSGGeometry m_geometry;
+};
+
+class TimelineThumbnails : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QString binId MEMBER m_binId NOTIFY propertyChanged)
+    // 0: in and out thumbnails, 1: all frames, 2: first frame only
+    Q_PROPERTY(int format MEMBER m_format NOTIFY propertyChanged)
+    Q_PROPERTY(int inPoint MEMBER m_inPoint NOTIFY propertyChanged)
+    Q_PROPERTY(int startFrame MEMBER m_startFrame NOTIFY propertyChanged)
+    Q_PROPERTY(int endFrame MEMBER m_endFrame NOTIFY propertyChanged)
+    Q_PROPERTY(double speed MEMBER m_speed NOTIFY propertyChanged)
+    Q_PROPERTY(double timeScale MEMBER m_timeScale NOTIFY propertyChanged)
+    Q_PROPERTY(double thumbWidth MEMBER m_thumbWidth NOTIFY propertyChanged)
+    Q_PROPERTY(bool fixedThumbs MEMBER m_fixedThumbs NOTIFY propertyChanged)
+    Q_PROPERTY(int drawInPoint MEMBER m_drawInPoint NOTIFY propertyChanged)
+    Q_PROPERTY(int drawOutPoint MEMBER m_drawOutPoint NOTIFY propertyChanged)
+
+public:
+    TimelineThumbnails()
+    {
+        setFlag(QQuickItem::ItemHasContents);
+        setEnabled(false);
+        connect(this, &TimelineThumbnails::propertyChanged, this, &QQuickItem::update);
+        connect(ThumbnailAtlas::get().get(), &ThumbnailAtlas::thumbnailReady, this, [this](const QString &binId) {
+            if (binId == m_binId) {
+                update();
+            }
+        });
+        connect(ThumbnailAtlas::get().get(), &ThumbnailAtlas::slotsRecycled, this, &QQuickItem::update);
+    }
+
+protected:
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override
+    {
+        QQuickItem::geometryChanged(newGeometry, oldGeometry);
+        update();
+    }
+
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
+    {
+        // Quads of the displayed thumbnails, grouped by atlas page
+        std::map<int, QVector<QSGGeometry::TexturedPoint2D>> quads;
+        const bool hasThumbs = !m_binId.isEmpty() && m_thumbWidth > 0 && m_timeScale > 0 && height() > 0;
+        const int count = !hasThumbs ? 0 : m_format == 0 ? 2 : m_format == 1 ? int(ceil(width() / m_thumbWidth)) : m_format == 2 ? 1 : 0;
+        const double imageWidth = count > 0 ? qMax(m_thumbWidth, width() / count) : 0.;
+        for (int i = 0; i < count; i++) {
+            const double x = i * imageWidth;
+            if (count > 2 && (x < m_drawInPoint - imageWidth || x > m_drawOutPoint)) {
+                // Out of view, don't even request it
+                continue;
+            }
+            int frame = 0;
+            if (!m_fixedThumbs) {
+                frame = count < 3 ? (i == 0 ? m_startFrame : m_endFrame) : int(floor(m_inPoint + qRound(x / m_timeScale) * m_speed));
+            }
+            ThumbnailAtlas::Slot slot = ThumbnailAtlas::get()->slot(m_binId, frame);
+            if (slot.page < 0) {
+                // We will be updated when it is ready
+                continue;
+            }
+            // Fit the thumbnail in its cell, aligned left except for the out thumbnail
+            const double scale = qMin(imageWidth / slot.rect.width(), height() / slot.rect.height());
+            const double w = slot.rect.width() * scale;
+            const double h = slot.rect.height() * scale;
+            const double left = (count < 3 && i > 0) ? x + imageWidth - w : x;
+            const double top = (height() - h) / 2;
+            const QRectF source = QRectF(slot.rect).adjusted(0.5, 0.5, -0.5, -0.5);
+            const double tl = source.left() / ThumbnailAtlas::PageSize;
+            const double tr = source.right() / ThumbnailAtlas::PageSize;
+            const double tt = source.top() / ThumbnailAtlas::PageSize;
+            const double tb = source.bottom() / ThumbnailAtlas::PageSize;
+            QVector<QSGGeometry::TexturedPoint2D> &vertices = quads[slot.page];
+            QSGGeometry::TexturedPoint2D corners[4];
+            corners[0].set(left, top, tl, tt);
+            corners[1].set(left + w, top, tr, tt);
+            corners[2].set(left, top + h, tl, tb);
+            corners[3].set(left + w, top + h, tr, tb);
+            for (int k : {0, 1, 2, 1, 3, 2}) {
+                vertices << corners[k];
+            }
+        }
+        // Keep the node of each page still displayed, only its vertices change
+        auto *root = oldNode ? oldNode : new QSGNode;
+        std::map<int, AtlasPageNode *> nodes;
+        QSGNode *child = root->firstChild();
+        while (child != nullptr) {
+            auto *node = static_cast<AtlasPageNode *>(child);
+            child = child->nextSibling();
+            if (quads.count(node->page) == 0) {
+                root->removeChildNode(node);
+                delete node;
+            } else {
+                nodes[node->page] = node;
+            }
+        }
+        for (const auto &page : quads) {
+            AtlasPageNode *node;
+            auto it = nodes.find(page.first);
+            if (it == nodes.end()) {
+                node = new AtlasPageNode(page.first, page.second.size());
+                root->appendChildNode(node);
+            } else {
+                node = it->second;
+                node->geometry()->allocate(page.second.size());
+            }
+            memcpy(node->geometry()->vertexDataAsTexturedPoint2D(), page.second.constData(), page.second.size() * sizeof(QSGGeometry::TexturedPoint2D));
+            // Uploads the thumbnails stored since the last frame
+            node->material.setTexture(atlasTexture(window(), page.first));
+            node->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+        }
+        return root;
+    }
+
+signals:
+    void propertyChanged();
+
+private:
+    QString m_binId;
+    int m_format{0};
+    int m_inPoint{0};
+    int m_startFrame{0};
+    int m_endFrame{0};
+    double m_speed{1.};
+    double m_timeScale{1.};
+    double m_thumbWidth{0.};
+    bool m_fixedThumbs{false};
+    // Pixels outside the view, thumbnails there are not requested
+    int m_drawInPoint{0};
+    int m_drawOutPoint{0};
+};
+
 void registerTimelineItems()
 {
     qmlRegisterType<TimelineTriangle>("Kdenlive.Controls", 1, 0, "TimelineTriangle");
     qmlRegisterType<TimelinePlayhead>("Kdenlive.Controls", 1, 0, "TimelinePlayhead");
     qmlRegisterType<TimelineWaveform>("Kdenlive.Controls", 1, 0, "TimelineWaveform");
+    qmlRegisterType<TimelineThumbnails>("Kdenlive.Controls", 1, 0, "TimelineThumbnails");
 }
 
 #include "timelineitems.moc"
@@ -2971,16 +2971,15 @@ bool TimelineController::endFakeGroupMove(int clipId, int groupId, int delta_tra
     return true;
 }
 
-QStringList TimelineController::getThumbKeys()
+std::unordered_map<QString, std::vector<int>> TimelineController::getThumbKeys()
 {
-    QStringList result;
+    std::unordered_map<QString, std::vector<int>> result;
     for (const auto &clp : m_model->m_allClips) {
         const QString binId = getClipBinId(clp.first);
-        std::shared_ptr<ProjectClip> binClip = pCore->bin()->getBinClip(binId);
-        result << binClip->hash() + QLatin1Char('#') + QString::number(clp.second->getIn()) + QStringLiteral(".png");
-        result << binClip->hash() + QLatin1Char('#') + QString::number(clp.second->getOut()) + QStringLiteral(".png");
+        std::vector<int> &frames = result[binId];
+        frames.push_back(clp.second->getIn());
+        frames.push_back(clp.second->getOut());
     }
-    result.removeDuplicates();
     return result;
 }
 
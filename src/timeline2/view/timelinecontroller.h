@@ -513,8 +513,8 @@ public:
     Q_INVOKABLE const QString getAssetName(const QString &assetId, bool isTransition);
     /** @brief Set keyboard grabbing on current selection */
     Q_INVOKABLE void grabCurrent();
-    /** @brief Returns keys for all used thumbnails */
-    QStringList getThumbKeys();
+    /** @brief Returns the frames of all used thumbnails, by bin id */
+    std::unordered_map<QString, std::vector<int>> getThumbKeys();
     /** @brief Returns true if a drag operation is currently running in timeline */
     bool dragOperationRunning();
     /** @brief Disconnect some stuff before closing project */
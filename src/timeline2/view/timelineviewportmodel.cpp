@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "timelineviewportmodel.h"
+#include "core.h"
+#include "timeline2/model/timelineitemmodel.hpp"
+
+TimelineViewportModel::TimelineViewportModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_timeline(nullptr)
+    , m_coverStart(0)
+    , m_coverEnd(-1)
+    , m_filterPasses(0)
+{
+}
+
+void TimelineViewportModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (m_timeline) {
+        disconnect(m_timeline, &TimelineModel::selectionChanged, this, nullptr);
+    }
+    m_timeline = qobject_cast<TimelineItemModel *>(sourceModel);
+    m_accepted.clear();
+    m_pinned.clear();
+    if (m_timeline) {
+        connect(m_timeline, &TimelineModel::selectionChanged, this, [this]() {
+            // The newly selected items already have a delegate, make sure it is kept while they are dragged
+            std::unordered_set<int> selection = m_timeline->getCurrentSelection();
+            m_pinned.insert(selection.begin(), selection.end());
+        });
+    }
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void TimelineViewportModel::setVisibleRange(int start, int end)
+{
+    pCore->setVisibleTimelineRange(start, end);
+    int span = qMax(1, end - start);
+    if (m_coverEnd > -1 && qMax(0, start - span / 2) >= m_coverStart && end + span / 2 <= m_coverEnd && m_coverEnd - m_coverStart <= 4 * span) {
+        // Still well inside the covered range, and not zoomed in too much
+        return;
+    }
+    m_coverStart = qMax(0, start - span);
+    m_coverEnd = end + span;
+    if (m_timeline == nullptr) {
+        return;
+    }
+    m_pinned = m_timeline->getCurrentSelection();
+    if (coverageChanged()) {
+        m_filterPasses++;
+        invalidateFilter();
+    }
+}
+
+bool TimelineViewportModel::coverageChanged()
+{
+    std::unordered_set<int> wanted = m_pinned;
+    for (int trackId : m_timeline->getAllTracksIds()) {
+        std::unordered_set<int> items = m_timeline->getItemsInRange(trackId, m_coverStart, m_coverEnd, true);
+        wanted.insert(items.begin(), items.end());
+    }
+    bool changed = false;
+    for (auto it = m_accepted.begin(); it != m_accepted.end();) {
+        if (!m_timeline->isClip(*it) && !m_timeline->isComposition(*it)) {
+            // Deleted item
+            it = m_accepted.erase(it);
+            continue;
+        }
+        if (wanted.count(*it) == 0) {
+            changed = true;
+        }
+        ++it;
+    }
+    if (changed) {
+        return true;
+    }
+    for (int id : wanted) {
+        if (m_accepted.count(id) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TimelineViewportModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!sourceParent.isValid() || m_timeline == nullptr) {
+        // Tracks are always displayed
+        return true;
+    }
+    const int id = (int)sourceModel()->index(sourceRow, 0, sourceParent).internalId();
+    bool accepted = m_coverEnd == -1 || m_pinned.count(id) > 0;
+    if (!accepted) {
+        int position = m_timeline->getItemPosition(id);
+        accepted = position < m_coverEnd && position + m_timeline->getItemPlaytime(id) > m_coverStart;
+    }
+    if (accepted) {
+        m_accepted.insert(id);
+    } else {
+        m_accepted.erase(id);
+    }
+    return accepted;
+}
+
+int TimelineViewportModel::coveredStart() const
+{
+    return m_coverStart;
+}
+
+int TimelineViewportModel::coveredEnd() const
+{
+    return m_coverEnd;
+}
+
+int TimelineViewportModel::filterPasses() const
+{
+    return m_filterPasses;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TIMELINEVIEWPORTMODEL_H
+#define TIMELINEVIEWPORTMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <unordered_set>
+
+class TimelineItemModel;
+
+/** @class TimelineViewportModel
+    @brief Sorted proxy of the timeline model that only exposes the clips and compositions intersecting the visible part of the timeline.
+    Tracks are always accepted. Items are accepted when they intersect a covered range made of the visible range plus one screen on
+    each side, so that the qml delegates are only created for what can be seen. The covered range is only moved when the view gets
+    close to its borders, and the track range index is used to skip the filter pass when the set of covered items does not change.
+ */
+class TimelineViewportModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit TimelineViewportModel(QObject *parent = nullptr);
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    /** @brief Set the range of frames currently displayed by the timeline view */
+    Q_INVOKABLE void setVisibleRange(int start, int end);
+    /** @brief Returns the first frame of the covered range */
+    int coveredStart() const;
+    /** @brief Returns the frame following the covered range, -1 when all items are accepted */
+    int coveredEnd() const;
+    /** @brief Returns the number of times the filter had to be re-evaluated */
+    int filterPasses() const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    TimelineItemModel *m_timeline;
+    int m_coverStart;
+    int m_coverEnd;
+    int m_filterPasses;
+    /** @brief Selected items keep their delegate even out of the covered range, they might be dragged */
+    std::unordered_set<int> m_pinned;
+    /** @brief Items currently accepted by the filter */
+    mutable std::unordered_set<int> m_accepted;
+
+    /** @brief Returns true if the accepted items differ from the ones intersecting the covered range */
+    bool coverageChanged();
+};
+
+#endif
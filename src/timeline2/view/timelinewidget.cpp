@@ -33,8 +33,8 @@
 #include "project/projectmanager.h"
 #include "monitor/monitorproxy.h"
 #include "qml/timelineitems.h"
-#include "qmltypes/thumbnailprovider.h"
 #include "timelinecontroller.h"
+#include "timelineviewportmodel.h"
 #include "utils/clipboardproxy.hpp"
 #include "effects/effectsrepository.hpp"
 
@@ -45,10 +45,8 @@
 #include <QQmlEngine>
 #include <QQuickItem>
 #include <QActionGroup>
-#include <QUuid>
 #include <QMenu>
 #include <QFontDatabase>
-#include <QSortFilterProxyModel>
 
 const int TimelineWidget::comboScale[] = {1, 2, 4, 8, 15, 30, 50, 75, 100, 150, 200, 300, 500, 800, 1000, 1500, 2000, 3000, 6000, 15000, 30000};
 
@@ -62,12 +60,11 @@ TimelineWidget::TimelineWidget(QWidget *parent)
     kdeclarative.setupContext();
     setClearColor(palette().window().color());
     registerTimelineItems();
-    m_sortModel = std::make_unique<QSortFilterProxyModel>(this);
+    m_sortModel = std::make_unique<TimelineViewportModel>(this);
     m_proxy = new TimelineController(this);
     connect(m_proxy, &TimelineController::zoneMoved, this, &TimelineWidget::zoneMoved);
     connect(m_proxy, &TimelineController::ungrabHack, this, &TimelineWidget::slotUngrabHack);
     setResizeMode(QQuickWidget::SizeRootObjectToView);
-    engine()->addImageProvider(QStringLiteral("thumbnail"), new ThumbnailProvider);
     setVisible(false);
     setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
     setFocusPolicy(Qt::StrongFocus);
@@ -158,13 +155,14 @@ void TimelineWidget::setModel(const std::shared_ptr<TimelineItemModel> &model, M
     m_sortModel->setSortRole(TimelineItemModel::SortRole);
     m_sortModel->sort(0, Qt::DescendingOrder);
     m_proxy->setModel(model);
+    if (m_proxy->scaleFactor() > 0) {
+        // Only create the clip delegates of the first screen, the qml view updates the range as soon as it is scrolled
+        m_sortModel->setVisibleRange(0, int(width() / m_proxy->scaleFactor()));
+    }
     rootContext()->setContextProperty("multitrack", m_sortModel.get());
     rootContext()->setContextProperty("controller", model.get());
     rootContext()->setContextProperty("timeline", m_proxy);
     rootContext()->setContextProperty("proxy", proxy);
-    // Create a unique id for this timeline to prevent thumbnails 
-    // leaking from one project to another because of qml's image caching
-    rootContext()->setContextProperty("documentId", QUuid::createUuid());
     rootContext()->setContextProperty("audiorec", pCore->getAudioDevice());
     rootContext()->setContextProperty("guidesModel", pCore->projectManager()->current()->getGuideModel().get());
     rootContext()->setContextProperty("clipboard", new ClipboardProxy(this));
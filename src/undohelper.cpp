@@ -23,6 +23,70 @@
 #include "logger.hpp"
 #include <QDebug>
 #include <utility>
+
+FunTransaction::FunTransaction(bool reverse)
+    : m_reverse(reverse)
+{
+}
+
+bool FunTransaction::operator()() const
+{
+    bool result = true;
+    auto run = [&result](const Entry &entry) {
+        switch (entry.mode) {
+        case Mode::IfSucceeded:
+            result = result && entry.operation();
+            return true;
+        case Mode::StopOnFailure:
+            if (!entry.operation()) {
+                result = false;
+                return false;
+            }
+            return true;
+        case Mode::Always:
+        default: {
+            bool v = entry.operation();
+            result = result && v;
+            return true;
+        }
+        }
+    };
+    if (m_reverse) {
+        for (auto it = m_entries.crbegin(); it != m_entries.crend(); ++it) {
+            if (!run(*it)) {
+                break;
+            }
+        }
+    } else {
+        for (const Entry &entry : m_entries) {
+            if (!run(entry)) {
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+void FunTransaction::append(Fun &lambda, Fun operation, bool reverse, Mode mode)
+{
+    auto *transaction = lambda.target<FunTransaction>();
+    if (transaction == nullptr || transaction->m_reverse != reverse) {
+        FunTransaction wrapper(reverse);
+        if (lambda) {
+            wrapper.m_entries.push_back({std::move(lambda), Mode::Always});
+        }
+        lambda = std::move(wrapper);
+        transaction = lambda.target<FunTransaction>();
+    }
+    transaction->m_entries.push_back({std::move(operation), mode});
+}
+
+size_t FunTransaction::count(const Fun &lambda)
+{
+    const auto *transaction = lambda.target<FunTransaction>();
+    return transaction ? transaction->m_entries.size() : 1;
+}
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
@@ -22,24 +22,52 @@
 #ifndef UNDOHELPER_H
 #define UNDOHELPER_H
 #include <functional>
+#include <vector>
 
 using Fun = std::function<bool(void)>;
 
-/* @brief this macro executes an operation after a given lambda
+/*@brief This is a flat list of operations, stored in a Fun, that are executed one after the other.
+  Accumulating operations by wrapping the previous Fun inside a new lambda copies the whole chain on each step, and executing the
+  result recurses as deep as the number of operations. Instead, append() detects that a Fun already holds a transaction going in
+  the same direction and adds the operation at the end of its vector.
+  A forward transaction executes its operations in insertion order (redo), a reverse one executes the last inserted first (undo).
  */
-#define PUSH_LAMBDA(operation, lambda)                                                                                                                         \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = lambda();                                                                                                                                     \
-        return v && operation();                                                                                                                               \
+class FunTransaction
+{
+public:
+    enum class Mode {
+        Always,       // the operation is always executed
+        IfSucceeded,  // the operation is only executed if everything executed before it succeeded
+        StopOnFailure // if the operation fails, the operations executed after it are skipped
     };
 
+    explicit FunTransaction(bool reverse);
+    bool operator()() const;
+
+    /* @brief Adds an operation to the given lambda, turning it into a transaction first if needed
+       @param reverse if false, the operation is executed after the current content of lambda, otherwise before it
+     */
+    static void append(Fun &lambda, Fun operation, bool reverse, Mode mode = Mode::Always);
+    /* @brief Returns the number of operations stored in the lambda, or 1 if it is not a transaction */
+    static size_t count(const Fun &lambda);
+
+private:
+    struct Entry
+    {
+        Fun operation;
+        Mode mode;
+    };
+    std::vector<Entry> m_entries;
+    bool m_reverse;
+};
+
+/* @brief this macro executes an operation after a given lambda
+ */
+#define PUSH_LAMBDA(operation, lambda) FunTransaction::append(lambda, operation, false, FunTransaction::Mode::IfSucceeded);
+
 /* @brief this macro executes an operation before a given lambda
  */
-#define PUSH_FRONT_LAMBDA(operation, lambda)                                                                                                                   \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = operation();                                                                                                                                  \
-        return v && lambda();                                                                                                                                  \
-    };
+#define PUSH_FRONT_LAMBDA(operation, lambda) FunTransaction::append(lambda, operation, true, FunTransaction::Mode::StopOnFailure);
 
 #include <QUndoCommand>
 
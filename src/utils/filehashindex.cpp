@@ -0,0 +1,300 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "filehashindex.hpp"
+#include "kdenlivesettings.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <functional>
+
+std::unique_ptr<FileHashIndex> FileHashIndex::instance;
+std::once_flag FileHashIndex::m_onceFlag;
+
+namespace {
+const quint32 indexMagic = 0x4b444849; // KDHI
+const quint32 indexVersion = 1;
+// Entries not used for that long are dropped, in seconds
+const qint64 entryLifetime = 90 * 24 * 3600;
+
+const quint64 Prime1 = 11400714785074694791ULL;
+const quint64 Prime2 = 14029467366897019727ULL;
+const quint64 Prime3 = 1609587929392839161ULL;
+const quint64 Prime4 = 9650029242287828579ULL;
+const quint64 Prime5 = 2870177450012600261ULL;
+
+inline quint64 rotateLeft(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 round64(quint64 acc, quint64 input)
+{
+    acc += input * Prime2;
+    return rotateLeft(acc, 31) * Prime1;
+}
+
+inline quint64 merge64(quint64 acc, quint64 value)
+{
+    acc ^= round64(0, value);
+    return acc * Prime1 + Prime4;
+}
+
+/** @brief XXH64 with a null seed, processes 32 bytes per step */
+quint64 fastHash(const QByteArray &data)
+{
+    const auto *p = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = p + data.size();
+    quint64 h;
+    if (data.size() >= 32) {
+        quint64 v1 = Prime1 + Prime2;
+        quint64 v2 = Prime2;
+        quint64 v3 = 0;
+        quint64 v4 = 0 - Prime1;
+        const uchar *limit = end - 32;
+        do {
+            v1 = round64(v1, qFromLittleEndian<quint64>(p));
+            v2 = round64(v2, qFromLittleEndian<quint64>(p + 8));
+            v3 = round64(v3, qFromLittleEndian<quint64>(p + 16));
+            v4 = round64(v4, qFromLittleEndian<quint64>(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        h = merge64(h, v1);
+        h = merge64(h, v2);
+        h = merge64(h, v3);
+        h = merge64(h, v4);
+    } else {
+        h = Prime5;
+    }
+    h += quint64(data.size());
+    for (; p + 8 <= end; p += 8) {
+        h ^= round64(0, qFromLittleEndian<quint64>(p));
+        h = rotateLeft(h, 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= quint64(qFromLittleEndian<quint32>(p)) * Prime1;
+        h = rotateLeft(h, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= quint64(*p) * Prime5;
+        h = rotateLeft(h, 11) * Prime1;
+    }
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+} // namespace
+
+FileHashIndex::FileHashIndex(const QString &indexFile)
+    : m_indexFile(indexFile)
+    , m_modified(false)
+    , m_filesRead(0)
+{
+    load();
+}
+
+FileHashIndex::~FileHashIndex()
+{
+    save();
+}
+
+std::unique_ptr<FileHashIndex> &FileHashIndex::get()
+{
+    std::call_once(m_onceFlag, [] {
+        QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+        instance.reset(new FileHashIndex(cacheDir.absoluteFilePath(QStringLiteral("filehash.index"))));
+    });
+    return instance;
+}
+
+// static
+FileHashIndex::Algorithm FileHashIndex::algorithmFor(const QString &hash)
+{
+    if (hash.isEmpty()) {
+        return KdenliveSettings::fastfilehash() ? Algorithm::Fast : Algorithm::Md5;
+    }
+    return hash.size() == 16 ? Algorithm::Fast : Algorithm::Md5;
+}
+
+// static
+QString FileHashIndex::hashData(const QByteArray &data, Algorithm algorithm)
+{
+    if (algorithm == Algorithm::Fast) {
+        return QStringLiteral("%1").arg(fastHash(data), 16, 16, QLatin1Char('0'));
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+}
+
+// static
+QByteArray FileHashIndex::readHashedData(QFile &file)
+{
+    /*
+     * 1 MB = 1 second per 450 files (or faster)
+     * 10 MB = 9 seconds per 450 files (or faster)
+     */
+    QByteArray fileData;
+    if (file.size() > 2000000) {
+        fileData = file.read(1000000);
+        if (file.seek(file.size() - 1000000)) {
+            fileData.append(file.readAll());
+        }
+    } else {
+        fileData = file.readAll();
+    }
+    return fileData;
+}
+
+QString FileHashIndex::fileHash(const QString &path, Algorithm algorithm)
+{
+    QFileInfo info(path);
+    if (!info.isFile()) {
+        return QString();
+    }
+    const qint64 size = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_entries.find(path);
+        if (it != m_entries.end() && it->size == size && it->modified == modified) {
+            const QString &hash = algorithm == Algorithm::Fast ? it->fast : it->md5;
+            if (!hash.isEmpty()) {
+                if (now - it->used > 24 * 3600) {
+                    it->used = now;
+                    m_modified = true;
+                }
+                return hash;
+            }
+        }
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    const QString hash = hashData(readHashedData(file), algorithm);
+    file.close();
+    QMutexLocker lock(&m_mutex);
+    Entry &entry = m_entries[path];
+    if (entry.size != size || entry.modified != modified) {
+        entry = Entry{size, modified, now, QString(), QString()};
+    }
+    entry.used = now;
+    (algorithm == Algorithm::Fast ? entry.fast : entry.md5) = hash;
+    m_modified = true;
+    m_filesRead++;
+    return hash;
+}
+
+QStringList FileHashIndex::fileHashes(const QStringList &paths, Algorithm algorithm)
+{
+    QStringList result;
+    if (paths.size() < 2) {
+        for (const QString &path : paths) {
+            result << fileHash(path, algorithm);
+        }
+    } else {
+        std::function<QString(const QString &)> hashFile = [this, algorithm](const QString &path) { return fileHash(path, algorithm); };
+        result = QtConcurrent::blockingMapped<QStringList>(paths, hashFile);
+    }
+    save();
+    return result;
+}
+
+QString FileHashIndex::findFile(const QStringList &paths, const QString &hash)
+{
+    if (paths.isEmpty() || hash.isEmpty()) {
+        return QString();
+    }
+    const QStringList hashes = fileHashes(paths, algorithmFor(hash));
+    int ix = hashes.indexOf(hash);
+    return ix < 0 ? QString() : paths.at(ix);
+}
+
+int FileHashIndex::filesRead() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_filesRead;
+}
+
+void FileHashIndex::load()
+{
+    QFile file(m_indexFile);
+    if (m_indexFile.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    stream >> magic >> version >> count;
+    if (magic != indexMagic || version != indexVersion) {
+        return;
+    }
+    const qint64 limit = QDateTime::currentSecsSinceEpoch() - entryLifetime;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        stream >> path >> entry.size >> entry.modified >> entry.used >> entry.md5 >> entry.fast;
+        if (stream.status() != QDataStream::Ok) {
+            break;
+        }
+        if (entry.used < limit) {
+            m_modified = true;
+            continue;
+        }
+        m_entries.insert(path, entry);
+    }
+}
+
+void FileHashIndex::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_modified || m_indexFile.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(m_indexFile).absolutePath());
+    QSaveFile file(m_indexFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << indexMagic << indexVersion << quint32(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        stream << it.key() << it->size << it->modified << it->used << it->md5 << it->fast;
+    }
+    if (file.commit()) {
+        m_modified = false;
+    }
+}
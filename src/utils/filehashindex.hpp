@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <mutex>
+
+class QFile;
+
+/** @brief This class computes the content hashes identifying clip files, and remembers them across sessions.
+    A file hash is computed from the first and last MB of the file. Hashes are stored in the cache directory together with the size and
+    modification time of the file, so that a file is only read again when it changed. Several files can be hashed in parallel, which
+    matters when relinking clips on slow network storage.
+    Clips are identified either with a MD5 hash, the historical format, or with a faster non cryptographic 64 bit hash. The format of
+    an existing hash can be recognized from its length.
+ * Note that this class is a Singleton
+ */
+class FileHashIndex
+{
+public:
+    enum class Algorithm { Md5, Fast };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<FileHashIndex> &get();
+    /** @brief Creates an index stored in @param indexFile, or only kept in memory if it is empty */
+    explicit FileHashIndex(const QString &indexFile);
+    ~FileHashIndex();
+
+    /** @brief Returns the algorithm that produced @param hash, or the one selected in the settings if it is empty */
+    static Algorithm algorithmFor(const QString &hash = QString());
+    /** @brief Returns the hex encoded hash of some data */
+    static QString hashData(const QByteArray &data, Algorithm algorithm);
+    /** @brief Reads the part of an opened file that is used for the file hash */
+    static QByteArray readHashedData(QFile &file);
+
+    /** @brief Returns the hash of a file, reading it only if it is not indexed, or empty if it cannot be read. This method is thread safe */
+    QString fileHash(const QString &path, Algorithm algorithm);
+    /** @brief Hashes several files in parallel, the result is in the same order as @param paths */
+    QStringList fileHashes(const QStringList &paths, Algorithm algorithm);
+    /** @brief Returns the first of @param paths whose content matches @param hash, or an empty string */
+    QString findFile(const QStringList &paths, const QString &hash);
+
+    /** @brief Writes the index to disk if it changed */
+    void save();
+    /** @brief Number of files read since the index was created */
+    int filesRead() const;
+
+protected:
+    static std::unique_ptr<FileHashIndex> instance;
+    static std::once_flag m_onceFlag; // flag to create the index only once;
+
+private:
+    struct Entry
+    {
+        qint64 size{-1};
+        qint64 modified{0};
+        // Last time the entry was used, in seconds since epoch
+        qint64 used{0};
+        QString md5;
+        QString fast;
+    };
+
+    void load();
+
+    QString m_indexFile;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    bool m_modified;
+    int m_filesRead;
+};
@@ -0,0 +1,38 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef PADDEDATOMIC_H
+#define PADDEDATOMIC_H
+
+#include <atomic>
+
+/** @struct PaddedAtomic
+    @brief An atomic value preceded by a cache line of padding, so that values written by different threads
+    don't share a cache line. The lock-free queues are members of heap allocated widgets, and operator new
+    ignores extended alignment before C++17, so padding is used instead of alignas.
+ */
+template <typename T> struct PaddedAtomic
+{
+    char padding[64];
+    std::atomic<T> value{0};
+};
+
+#endif
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include "paddedatomic.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/** @class SpscRing
+    @brief A fixed capacity lock-free queue for one producer thread and one consumer thread.
+    Pushing never blocks: when the ring is full the new item is dropped and counted.
+ */
+template <typename T, size_t Capacity> class SpscRing
+{
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() = default;
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /** @brief Producer side: append an item, returns false if the ring was full */
+    bool push(const T &item)
+    {
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        if (tail - m_head.value.load(std::memory_order_acquire) == Capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Consumer side: take the oldest item, returns false if the ring was empty */
+    bool pop(T &item)
+    {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if (head == m_tail.value.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_items[head & (Capacity - 1)];
+        m_head.value.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Consumer side: discard all pending items */
+    void clear() { m_head.value.store(m_tail.value.load(std::memory_order_acquire), std::memory_order_release); }
+
+    /** @brief Approximate count of pending items */
+    size_t size() const { return m_tail.value.load(std::memory_order_acquire) - m_head.value.load(std::memory_order_acquire); }
+    static constexpr size_t capacity() { return Capacity; }
+    /** @brief Count of items dropped because the ring was full */
+    size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::array<T, Capacity> m_items;
+    // Keep the indexes on their own cache lines, each one is written by a single thread
+    PaddedAtomic<size_t> m_head;
+    PaddedAtomic<size_t> m_tail;
+    std::atomic<size_t> m_dropped{0};
+};
+
+#endif
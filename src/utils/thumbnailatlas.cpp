@@ -0,0 +1,304 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "thumbnailatlas.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "doc/kthumb.h"
+#include "utils/thumbnailcache.hpp"
+
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <climits>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+std::unique_ptr<ThumbnailAtlas> ThumbnailAtlas::instance;
+std::once_flag ThumbnailAtlas::m_onceFlag;
+
+bool ThumbnailAtlas::Key::operator==(const Key &other) const
+{
+    return frame == other.frame && binId == other.binId;
+}
+
+std::size_t ThumbnailAtlas::KeyHash::operator()(const Key &key) const
+{
+    std::size_t seed = std::hash<QString>()(key.binId);
+    seed ^= std::hash<int>()(key.frame) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+ThumbnailAtlas::ThumbnailAtlas()
+    : QObject()
+{
+    // Thumbnails are extracted with the clip's thumbnail producer, which cannot be shared between threads
+    m_pool.setMaxThreadCount(1);
+}
+
+ThumbnailAtlas::~ThumbnailAtlas()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+std::unique_ptr<ThumbnailAtlas> &ThumbnailAtlas::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailAtlas()); });
+    return instance;
+}
+
+ThumbnailAtlas::Slot ThumbnailAtlas::slot(const QString &binId, int frame)
+{
+    QMutexLocker locker(&m_mutex);
+    Key key{binId, frame};
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, m_slots[it->second].lru);
+        return {it->second / slotsPerPage(), slotRect(it->second)};
+    }
+    if (binId.isEmpty() || m_pending.count(key) > 0) {
+        return {-1, QRect()};
+    }
+    quint64 generation = ++m_generation;
+    m_pending[key] = generation;
+    class ThumbnailFetcher : public QRunnable
+    {
+    public:
+        ThumbnailFetcher(ThumbnailAtlas *atlas, QString binId, int frame, quint64 generation)
+            : m_atlas(atlas)
+            , m_binId(std::move(binId))
+            , m_frame(frame)
+            , m_generation(generation)
+        {
+        }
+        void run() override { m_atlas->insert(m_binId, m_frame, fetchThumbnail(m_binId, m_frame), m_generation); }
+
+    private:
+        ThumbnailAtlas *m_atlas;
+        QString m_binId;
+        int m_frame;
+        quint64 m_generation;
+    };
+    // Serve the latest requests first, they are the ones displayed after a fast scroll
+    m_pool.start(new ThumbnailFetcher(this, binId, frame, generation), int(qMin(generation, quint64(INT_MAX))));
+    return {-1, QRect()};
+}
+
+// static
+QImage ThumbnailAtlas::fetchThumbnail(const QString &binId, int frame)
+{
+    QImage result = ThumbnailCache::get()->getThumbnail(binId, frame);
+    if (!result.isNull()) {
+        return result;
+    }
+    std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+    if (!binClip) {
+        return result;
+    }
+    std::shared_ptr<Mlt::Producer> producer = binClip->thumbProducer();
+    if (!producer || !producer->is_valid()) {
+        return result;
+    }
+    producer->seek(frame);
+    QScopedPointer<Mlt::Frame> mltFrame(producer->get_frame());
+    if (mltFrame == nullptr || !mltFrame->is_valid()) {
+        return result;
+    }
+    int imageHeight = pCore->thumbProfile()->height();
+    int imageWidth = pCore->thumbProfile()->width();
+    int fullWidth = imageHeight * pCore->getCurrentDar() + 0.5;
+    result = KThumb::getFrame(mltFrame.data(), imageWidth, imageHeight, fullWidth);
+    ThumbnailCache::get()->storeThumbnail(binId, frame, result, false);
+    return result;
+}
+
+void ThumbnailAtlas::insert(const QString &binId, int frame, const QImage &image, quint64 generation)
+{
+    Key key{binId, frame};
+    QSize size;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(key);
+        if (it == m_pending.end() || it->second != generation) {
+            // The clip was invalidated while fetching
+            return;
+        }
+        if (image.isNull() || image.height() <= 0) {
+            m_pending.erase(it);
+            return;
+        }
+        size = m_slotSize.isValid() ? m_slotSize : QSize(qBound(1, qRound(SlotHeight * image.width() / double(image.height())), PageSize), SlotHeight);
+    }
+    // Scale outside of the lock, painting items query the atlas. Thumbnails of another aspect ratio than the slots are cropped
+    QImage scaled = image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    scaled = scaled.copy(QRect(QPoint((scaled.width() - size.width()) / 2, (scaled.height() - size.height()) / 2), size))
+                 .convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    bool recycled = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(key);
+        if (it == m_pending.end() || it->second != generation) {
+            return;
+        }
+        m_pending.erase(it);
+        if (!m_slotSize.isValid()) {
+            m_slotSize = size;
+        }
+        if (m_slotSize == size) {
+            int index = allocateSlot(recycled);
+            SlotInfo &info = m_slots[index];
+            info.key = key;
+            info.used = true;
+            info.revision = ++m_revision;
+            m_lru.push_front(index);
+            info.lru = m_lru.begin();
+            m_index[key] = index;
+            Page &page = m_pages[index / slotsPerPage()];
+            page.revision = m_revision;
+            QPainter painter(&page.image);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawImage(slotRect(index).topLeft(), scaled);
+        }
+        // Otherwise the atlas was cleared and the slot size changed while scaling, the thumbnail will be requested again on repaint
+    }
+    if (recycled) {
+        emit slotsRecycled();
+    }
+    emit thumbnailReady(binId);
+}
+
+int ThumbnailAtlas::allocateSlot(bool &recycled)
+{
+    if (!m_freeSlots.empty()) {
+        int index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return index;
+    }
+    if ((int)m_pages.size() < MaxPages) {
+        Page page;
+        page.image = QImage(PageSize, PageSize, QImage::Format_RGBA8888_Premultiplied);
+        page.image.fill(Qt::transparent);
+        page.revision = m_revision;
+        m_pages.push_back(page);
+        int first = (int)m_slots.size();
+        m_slots.resize(first + slotsPerPage(), SlotInfo{Key{QString(), 0}, 0, false, m_lru.end()});
+        // Fill the page from its top left corner
+        for (int i = (int)m_slots.size() - 1; i > first; --i) {
+            m_freeSlots.push_back(i);
+        }
+        return first;
+    }
+    // All pages are full, reuse the least recently used slot
+    int index = m_lru.back();
+    m_lru.pop_back();
+    m_index.erase(m_slots[index].key);
+    m_slots[index].used = false;
+    recycled = true;
+    return index;
+}
+
+void ThumbnailAtlas::releaseSlot(int index)
+{
+    SlotInfo &info = m_slots[index];
+    m_lru.erase(info.lru);
+    m_index.erase(info.key);
+    info.used = false;
+    m_freeSlots.push_back(index);
+}
+
+int ThumbnailAtlas::slotsPerPage() const
+{
+    return (PageSize / m_slotSize.width()) * (PageSize / m_slotSize.height());
+}
+
+QRect ThumbnailAtlas::slotRect(int index) const
+{
+    const int columns = PageSize / m_slotSize.width();
+    const int local = index % slotsPerPage();
+    return QRect(QPoint((local % columns) * m_slotSize.width(), (local / columns) * m_slotSize.height()), m_slotSize);
+}
+
+int ThumbnailAtlas::pageCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return (int)m_pages.size();
+}
+
+quint64 ThumbnailAtlas::pageRevision(int page) const
+{
+    QMutexLocker locker(&m_mutex);
+    return page < (int)m_pages.size() ? m_pages[page].revision : 0;
+}
+
+quint64 ThumbnailAtlas::updatedSlots(int page, quint64 revision, const std::function<void(const QImage &, const QRect &)> &upload) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (page >= (int)m_pages.size()) {
+        return revision;
+    }
+    const Page &current = m_pages[page];
+    if (current.revision > revision) {
+        const int first = page * slotsPerPage();
+        for (int i = first; i < first + slotsPerPage(); ++i) {
+            if (m_slots[i].used && m_slots[i].revision > revision) {
+                upload(current.image, slotRect(i));
+            }
+        }
+    }
+    return current.revision;
+}
+
+void ThumbnailAtlas::invalidateClip(const QString &binId)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = 0; i < (int)m_slots.size(); ++i) {
+            if (m_slots[i].used && m_slots[i].key.binId == binId) {
+                releaseSlot(i);
+            }
+        }
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (it->first.binId == binId) {
+                it = m_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    emit slotsRecycled();
+}
+
+void ThumbnailAtlas::clear()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pages.clear();
+        m_slots.clear();
+        m_freeSlots.clear();
+        m_lru.clear();
+        m_index.clear();
+        m_pending.clear();
+        m_slotSize = QSize();
+    }
+    emit slotsRecycled();
+}
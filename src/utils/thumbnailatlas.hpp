@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRect>
+#include <QThreadPool>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/** @brief This class packs the timeline clip thumbnails in a few large images, so that the timeline can draw them from shared textures.
+    Pages are split in slots of identical size, the least recently used slot is recycled when all pages are full. Missing thumbnails
+    are fetched from the ThumbnailCache, or extracted from the clip, in a background thread, and thumbnailReady is emitted when they were
+    copied in their slot. Each page keeps a revision number, so that textures only need to upload the slots changed since their last
+    upload.
+ * Note that this class is a Singleton
+ */
+class ThumbnailAtlas : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Width and height of a page, in pixels */
+    static const int PageSize = 2048;
+    /** @brief Maximum number of pages */
+    static const int MaxPages = 4;
+    /** @brief Height of the thumbnails stored in the atlas, the width follows the thumbnails aspect ratio */
+    static const int SlotHeight = 90;
+
+    /** @brief Location of a thumbnail, page is -1 if it is not available yet */
+    struct Slot
+    {
+        int page;
+        QRect rect;
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<ThumbnailAtlas> &get();
+    ~ThumbnailAtlas() override;
+
+    /** @brief Returns the location of a thumbnail in the atlas.
+        If it is not available yet, it is fetched in the background and thumbnailReady will be emitted
+    */
+    Slot slot(const QString &binId, int frame);
+
+    /** @brief Returns the number of allocated pages */
+    int pageCount() const;
+
+    /** @brief Returns the revision of a page, increased each time a thumbnail is stored in it */
+    quint64 pageRevision(int page) const;
+
+    /** @brief Calls @param upload with the content of each slot of @param page changed after @param revision
+        @returns the current revision of the page
+    */
+    quint64 updatedSlots(int page, quint64 revision, const std::function<void(const QImage &, const QRect &)> &upload) const;
+
+    /** @brief Removes all the thumbnails of a clip, for example when it was reloaded */
+    void invalidateClip(const QString &binId);
+
+    /** @brief Removes all thumbnails, to be called when the project or its profile changes */
+    void clear();
+
+signals:
+    /** @brief A thumbnail of the given clip was stored in the atlas */
+    void thumbnailReady(const QString &binId);
+    /** @brief Slots were reused for other thumbnails, items displaying them must be updated */
+    void slotsRecycled();
+
+protected:
+    ThumbnailAtlas();
+    static std::unique_ptr<ThumbnailAtlas> instance;
+    static std::once_flag m_onceFlag; // flag to create the repository only once;
+
+    /** @brief Returns the thumbnail of a clip, from the thumbnail cache or extracted from the clip */
+    static QImage fetchThumbnail(const QString &binId, int frame);
+
+    /** @brief Copies a fetched thumbnail in a free slot, @param generation identifies the request */
+    void insert(const QString &binId, int frame, const QImage &image, quint64 generation);
+
+private:
+    struct Key
+    {
+        QString binId;
+        int frame;
+        bool operator==(const Key &other) const;
+    };
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+    struct SlotInfo
+    {
+        Key key;
+        quint64 revision;
+        bool used;
+        // Position in the LRU list, only valid if the slot is used
+        std::list<int>::iterator lru;
+    };
+    struct Page
+    {
+        QImage image;
+        quint64 revision;
+    };
+
+    /** @brief Returns a free slot, recycling the least recently used one if needed, -1 if the slot size is unknown */
+    int allocateSlot(bool &recycled);
+    void releaseSlot(int index);
+    int slotsPerPage() const;
+    QRect slotRect(int index) const;
+
+    mutable QMutex m_mutex;
+    QThreadPool m_pool;
+    QSize m_slotSize;
+    std::vector<Page> m_pages;
+    std::vector<SlotInfo> m_slots;
+    std::vector<int> m_freeSlots;
+    // Most recently used slots are at the front
+    std::list<int> m_lru;
+    std::unordered_map<Key, int, KeyHash> m_index;
+    // Thumbnails being fetched, with the generation of their request
+    std::unordered_map<Key, quint64, KeyHash> m_pending;
+    quint64 m_generation{0};
+    quint64 m_revision{0};
+};
@@ -24,13 +24,43 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "doc/kdenlivedoc.h"
+#include "thumbnailatlas.hpp"
+#include "thumbnailpack.hpp"
 #include <QDir>
+#include <QFile>
 #include <QMutexLocker>
+#include <chrono>
 #include <list>
 
 std::unique_ptr<ThumbnailCache> ThumbnailCache::instance;
 std::once_flag ThumbnailCache::m_onceFlag;
 
+namespace {
+// Memory used by the volatile cache, in bytes
+const int memoryBudget = 10000000;
+
+struct ThumbKeyHash
+{
+    std::size_t operator()(const ThumbnailCache::ThumbKey &key) const { return std::hash<quint64>()(key.first) ^ (std::hash<int>()(key.second) << 1); }
+};
+
+// Measures the duration of a lookup and adds it to the given counter
+class LookupTimer
+{
+public:
+    explicit LookupTimer(std::atomic<quint64> &counter)
+        : m_counter(counter)
+        , m_start(std::chrono::steady_clock::now())
+    {
+    }
+    ~LookupTimer() { m_counter += (quint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count(); }
+
+private:
+    std::atomic<quint64> &m_counter;
+    std::chrono::steady_clock::time_point m_start;
+};
+} // namespace
+
 class ThumbnailCache::Cache_t
 {
 public:
@@ -39,9 +69,9 @@ public:
     {
     }
 
-    bool contains(const QString &key) const { return m_cache.count(key) > 0; }
+    bool contains(const ThumbKey &key) const { return m_cache.count(key) > 0; }
 
-    void remove(const QString &key)
+    void remove(const ThumbKey &key)
     {
         if (!contains(key)) {
             return;
@@ -52,11 +82,25 @@ public:
         m_cache.erase(key);
     }
 
-    void insert(const QString &key, const QImage &img, int cost)
+    void removeClip(quint64 clip)
+    {
+        for (auto it = m_data.begin(); it != m_data.end();) {
+            if (it->first.first == clip) {
+                m_currentCost -= it->second.second;
+                m_cache.erase(it->first);
+                it = m_data.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void insert(const ThumbKey &key, const QImage &img, int cost)
     {
         if (cost > m_maxCost) {
             return;
         }
+        remove(key);
         m_data.push_front({key, {img, cost}});
         auto it = m_data.begin();
         m_cache[key] = it;
@@ -66,19 +110,15 @@ public:
         }
     }
 
-    QImage get(const QString &key)
+    QImage get(const ThumbKey &key)
     {
         if (!contains(key)) {
             return QImage();
         }
         // when a get operation occurs, we put the corresponding list item in front to remember last access
-        std::pair<QString, std::pair<QImage, int>> data;
         auto it = m_cache.at(key);
-        std::swap(data, (*it));                                         // take data out without copy
-        QImage result = data.second.first;                              // a copy occurs here
-        m_data.erase(it);                                               // delete old iterator
-        m_cache[key] = m_data.emplace(m_data.begin(), std::move(data)); // reinsert without copy and store iterator
-        return result;
+        m_data.splice(m_data.begin(), m_data, it); // move to front without copy, iterators stay valid
+        return it->second.first;
     }
     void clear()
     {
@@ -91,50 +131,111 @@ protected:
     int m_maxCost;
     int m_currentCost{0};
 
-    std::list<std::pair<QString, std::pair<QImage, int>>> m_data; // the data is stored as (key,(image, cost))
-    std::unordered_map<QString, decltype(m_data.begin())> m_cache;
+    std::list<std::pair<ThumbKey, std::pair<QImage, int>>> m_data; // the data is stored as (key,(image, cost))
+    std::unordered_map<ThumbKey, decltype(m_data.begin()), ThumbKeyHash> m_cache;
+};
+
+struct ThumbnailCache::Shard
+{
+    explicit Shard(int maxCost = memoryBudget / ShardCount)
+        : cache(maxCost)
+    {
+    }
+    QMutex mutex;
+    Cache_t cache;
 };
 
 ThumbnailCache::ThumbnailCache()
-    : m_volatileCache(new Cache_t(10000000))
+    : m_shards(new Shard[ShardCount])
+    , m_largeThumbs(new Shard(memoryBudget))
 {
 }
 
+ThumbnailCache::~ThumbnailCache() = default;
+
 std::unique_ptr<ThumbnailCache> &ThumbnailCache::get()
 {
     std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailCache()); });
     return instance;
 }
 
+ThumbnailCache::Shard &ThumbnailCache::shard(const ThumbKey &key) const
+{
+    return m_shards[ThumbKeyHash()(key) % ShardCount];
+}
+
+ThumbnailCache::Shard &ThumbnailCache::shard(const ThumbKey &key, int cost) const
+{
+    return cost > memoryBudget / ShardCount ? *m_largeThumbs : shard(key);
+}
+
+bool ThumbnailCache::volatileThumbnail(const ThumbKey &key, QImage *image) const
+{
+    for (Shard *s : {&shard(key), m_largeThumbs.get()}) {
+        QMutexLocker locker(&s->mutex);
+        if (s->cache.contains(key)) {
+            if (image) {
+                *image = s->cache.get(key);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<ThumbnailPack> ThumbnailCache::getPack(quint64 clip, const QString &clipHash) const
+{
+    QMutexLocker locker(&m_packMutex);
+    auto it = m_packs.find(clip);
+    if (it != m_packs.end()) {
+        return it->second;
+    }
+    bool ok = false;
+    QDir thumbFolder = getDir(false, &ok);
+    if (!ok) {
+        return nullptr;
+    }
+    // The pack file is only opened (or created) on first access
+    auto pack = std::make_shared<ThumbnailPack>(thumbFolder.absoluteFilePath(clipHash + QStringLiteral(".thumbs")));
+    m_packs[clip] = pack;
+    return pack;
+}
+
 bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = pos < 0 ? getAudioKey(binId, &ok).first() : getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
+    if (pos < 0) {
+        auto key = getAudioKey(binId, &ok).first();
+        if (!ok || volatileOnly) {
+            return false;
+        }
+        QDir thumbFolder = getDir(true, &ok);
+        return ok && thumbFolder.exists(key);
+    }
+    QString clipHash;
+    auto key = getKey(binId, pos, &ok, &clipHash);
+    if (!ok) {
+        return false;
+    }
+    if (volatileThumbnail(key, nullptr)) {
         return true;
     }
-    if (!ok || volatileOnly) {
+    if (volatileOnly) {
         return false;
     }
-    QDir thumbFolder = getDir(pos < 0, &ok);
-    return ok && thumbFolder.exists(key);
+    auto pack = getPack(key.first, clipHash);
+    return pack && pack->contains(pos);
 }
 
 QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getAudioKey(binId, &ok).first();
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
-    }
     if (!ok || volatileOnly) {
         return QImage();
     }
     QDir thumbFolder = getDir(true, &ok);
     if (ok && thumbFolder.exists(key)) {
-        m_storedOnDisk[binId].push_back(-1);
         return QImage(thumbFolder.absoluteFilePath(key));
     }
     return QImage();
@@ -142,7 +243,6 @@ QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly
 
 const QList <QUrl> ThumbnailCache::getAudioThumbPath(const QString &binId) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getAudioKey(binId, &ok);
     QDir thumbFolder = getDir(true, &ok);
@@ -159,64 +259,88 @@ const QList <QUrl> ThumbnailCache::getAudioThumbPath(const QString &binId) const
 
 QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
+    LookupTimer timer(m_lookupTime);
     bool ok = false;
-    auto key = getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
+    QString clipHash;
+    auto key = getKey(binId, pos, &ok, &clipHash);
+    if (!ok) {
+        m_misses++;
+        return QImage();
     }
-    if (!ok || volatileOnly) {
+    QImage result;
+    if (volatileThumbnail(key, &result)) {
+        m_memoryHits++;
+        return result;
+    }
+    if (volatileOnly) {
+        m_misses++;
         return QImage();
     }
-    QDir thumbFolder = getDir(false, &ok);
-    if (ok && thumbFolder.exists(key)) {
-        m_storedOnDisk[binId].push_back(pos);
-        return QImage(thumbFolder.absoluteFilePath(key));
+    auto pack = getPack(key.first, clipHash);
+    result = pack ? pack->read(pos) : QImage();
+    if (result.isNull()) {
+        m_misses++;
+        return result;
     }
-    return QImage();
+    m_diskHits++;
+    const int cost = (int)result.sizeInBytes();
+    Shard &s = shard(key, cost);
+    QMutexLocker locker(&s.mutex);
+    s.cache.insert(key, result, cost);
+    return result;
 }
 
 void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    const QString key = getKey(binId, pos, &ok);
+    QString clipHash;
+    auto key = getKey(binId, pos, &ok, &clipHash);
     if (!ok) {
         return;
     }
+    m_stores++;
     if (persistent) {
-        QDir thumbFolder = getDir(false, &ok);
-        if (ok) {
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: "<<thumbFolder.absoluteFilePath(key);
-            }
-            m_storedOnDisk[binId].push_back(pos);
-            // if volatile cache also contains this entry, update it
-            if (m_volatileCache->contains(key)) {
-                m_volatileCache->remove(key);
-            } else {
-                m_storedVolatile[binId].push_back(pos);
-            }
-            m_volatileCache->insert(key, img, (int)img.sizeInBytes());
+        auto pack = getPack(key.first, clipHash);
+        if (!pack || !pack->append(pos, img)) {
+            qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB for clip: " << binId << ", frame: " << pos;
         }
-    } else {
-        m_volatileCache->insert(key, img, (int)img.sizeInBytes());
-        m_storedVolatile[binId].push_back(pos);
     }
+    const int cost = (int)img.sizeInBytes();
+    Shard &s = shard(key, cost);
+    Shard &other = &s == m_largeThumbs.get() ? shard(key) : *m_largeThumbs;
+    {
+        // The previous thumbnail might have had another size
+        QMutexLocker locker(&other.mutex);
+        other.cache.remove(key);
+    }
+    QMutexLocker locker(&s.mutex);
+    s.cache.insert(key, img, cost);
 }
 
-void ThumbnailCache::saveCachedThumbs(QStringList keys)
+void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vector<int>> &keys)
 {
-    bool ok;
-    QDir thumbFolder = getDir(false, &ok);
-    if (!ok) {
-        return;
-    }
-    for (const QString &key : keys) {
-        if (!thumbFolder.exists(key) && m_volatileCache->contains(key)) {
-            QImage img = m_volatileCache->get(key);
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << "// Error writing thumbnails to " << thumbFolder.absolutePath();
+    for (const auto &clip : keys) {
+        bool ok = false;
+        QString clipHash;
+        auto key = getKey(clip.first, 0, &ok, &clipHash);
+        if (!ok) {
+            continue;
+        }
+        auto pack = getPack(key.first, clipHash);
+        if (!pack) {
+            continue;
+        }
+        for (int pos : clip.second) {
+            key.second = pos;
+            if (pack->contains(pos)) {
+                continue;
+            }
+            QImage img;
+            if (!volatileThumbnail(key, &img)) {
+                continue;
+            }
+            if (!pack->append(pos, img)) {
+                qDebug() << "// Error writing thumbnails for clip " << clip.first;
                 break;
             }
         }
@@ -225,62 +349,103 @@ void ThumbnailCache::saveCachedThumbs(QStringList keys)
 
 void ThumbnailCache::invalidateThumbsForClip(const QString &binId, bool reloadAudio)
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_storedVolatile.find(binId) != m_storedVolatile.end()) {
-        bool ok = false;
-        for (int pos : m_storedVolatile.at(binId)) {
-            auto key = getKey(binId, pos, &ok);
-            if (ok) {
-                m_volatileCache->remove(key);
-            }
-        }
-        m_storedVolatile.erase(binId);
-    }
+    ThumbnailAtlas::get()->invalidateClip(binId);
     bool ok = false;
-    // Video thumbs
-    QDir thumbFolder = getDir(false, &ok);
-    QDir audioThumbFolder = getDir(true, &ok);
-    if (ok && m_storedOnDisk.find(binId) != m_storedOnDisk.end()) {
-        // Remove persistent cache
-        for (int pos : m_storedOnDisk.at(binId)) {
-            if (pos < 0) {
-                if (reloadAudio) {
-                    auto key = getAudioKey(binId, &ok);
-                    if (ok) {
-                        for (const QString &p : key) {
-                            QFile::remove(audioThumbFolder.absoluteFilePath(p));
-                        }
-                    }
-                }
-            } else {
-                auto key = getKey(binId, pos, &ok);
-                if (ok) {
-                    QFile::remove(thumbFolder.absoluteFilePath(key));
-                }
+    QString clipHash;
+    auto key = getKey(binId, 0, &ok, &clipHash);
+    {
+        // The clip hash might change on reload, so forget it
+        QWriteLocker locker(&m_hashLock);
+        m_clipHashes.erase(binId);
+    }
+    if (!ok) {
+        return;
+    }
+    for (int i = 0; i < ShardCount; ++i) {
+        QMutexLocker locker(&m_shards[i].mutex);
+        m_shards[i].cache.removeClip(key.first);
+    }
+    {
+        QMutexLocker locker(&m_largeThumbs->mutex);
+        m_largeThumbs->cache.removeClip(key.first);
+    }
+    // Remove persistent cache
+    std::shared_ptr<ThumbnailPack> pack = getPack(key.first, clipHash);
+    if (pack) {
+        pack->discard();
+    }
+    {
+        QMutexLocker locker(&m_packMutex);
+        m_packs.erase(key.first);
+    }
+    if (reloadAudio) {
+        QDir audioThumbFolder = getDir(true, &ok);
+        auto audioKey = getAudioKey(binId, &ok);
+        if (ok) {
+            for (const QString &p : audioKey) {
+                QFile::remove(audioThumbFolder.absoluteFilePath(p));
             }
         }
-        m_storedOnDisk.erase(binId);
     }
 }
 
 void ThumbnailCache::clearCache()
 {
-    QMutexLocker locker(&m_mutex);
-    m_volatileCache->clear();
-    m_storedVolatile.clear();
-    m_storedOnDisk.clear();
+    ThumbnailAtlas::get()->clear();
+    for (int i = 0; i < ShardCount; ++i) {
+        QMutexLocker locker(&m_shards[i].mutex);
+        m_shards[i].cache.clear();
+    }
+    {
+        QMutexLocker locker(&m_largeThumbs->mutex);
+        m_largeThumbs->cache.clear();
+    }
+    {
+        QMutexLocker locker(&m_packMutex);
+        m_packs.clear();
+    }
+    QWriteLocker locker(&m_hashLock);
+    m_clipHashes.clear();
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const
+{
+    return {m_memoryHits, m_diskHits, m_misses, m_stores, m_lookupTime};
 }
 
-// static
-QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
+ThumbnailCache::ThumbKey ThumbnailCache::getKey(const QString &binId, int pos, bool *ok, QString *clipHash) const
 {
+    *ok = false;
     if (binId.isEmpty()) {
-        *ok = false;
-        return QString();
+        return {0, pos};
+    }
+    {
+        QReadLocker locker(&m_hashLock);
+        auto it = m_clipHashes.find(binId);
+        if (it != m_clipHashes.end()) {
+            *ok = true;
+            if (clipHash) {
+                *clipHash = it->second.second;
+            }
+            return {it->second.first, pos};
+        }
     }
     auto binClip = pCore->projectItemModel()->getClipByBinID(binId);
-    *ok = binClip != nullptr;
-    return *ok ? binClip->hash() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".png") : QString();
+    if (!binClip) {
+        return {0, pos};
+    }
+    const QString hash = binClip->hash();
+    // The clip hash is a md5 hex string, its first 64 bits are enough to identify the clip
+    quint64 numericHash = hash.leftRef(16).toULongLong(ok, 16);
+    if (!*ok) {
+        return {0, pos};
+    }
+    QWriteLocker locker(&m_hashLock);
+    m_clipHashes[binId] = {numericHash, hash};
+    if (clipHash) {
+        *clipHash = hash;
+    }
+    return {numericHash, pos};
 }
 
 // static
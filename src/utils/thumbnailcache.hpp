@@ -26,17 +26,24 @@
 #include <QUrl>
 #include <QImage>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
 
+class ThumbnailPack;
+
 /** @brief This class class is an interface to the caches that store thumbnails.
     In Kdenlive, we use two such caches, a persistent that is stored on disk to allow thumbnails to be reused when reopening.
     The other one is a volatile LRU cache that lives in memory.
     Note that for the volatile cache uses a custom implementation.
     QCache is not suitable since it operates on pointers and since the object is removed from the cache when accessed.
     KImageCache is not suitable since it lacks a way to remove objects from the cache.
+    The volatile cache is split in shards, each with its own lock, so that concurrent jobs and the QML provider don't contend on a single mutex.
+    Video thumbnails are identified by a (clip hash, frame) pair of integers. On disk, all the thumbnails of a clip are appended to a single
+    pack file, which is memory mapped for reading.
  * Note that this class is a Singleton
  */
 
@@ -44,8 +51,23 @@ class ThumbnailCache
 {
 
 public:
+    /** @brief Identifies a video thumbnail: numeric form of the clip hash, frame number */
+    using ThumbKey = std::pair<quint64, int>;
+
+    /** @brief Usage counters of the cache, for diagnostics */
+    struct Stats
+    {
+        quint64 memoryHits;
+        quint64 diskHits;
+        quint64 misses;
+        quint64 stores;
+        // Total time spent in thumbnail lookups, in nanoseconds
+        quint64 lookupTime;
+    };
+
     // Returns the instance of the Singleton
     static std::unique_ptr<ThumbnailCache> &get();
+    ~ThumbnailCache();
 
     /* @brief Check whether a given thumbnail is in the cache
        @param binId is the id of the queried clip
@@ -73,18 +95,23 @@ public:
     /* @brief Removes all the thumbnails for a given clip */
     void invalidateThumbsForClip(const QString &binId, bool reloadAudio);
 
-    /* @brief Save all cached thumbs to disk */
-    void saveCachedThumbs(QStringList keys);
+    /* @brief Save cached thumbs to disk
+       @param keys maps a bin id to the frames that should be written to the persistent cache
+    */
+    void saveCachedThumbs(const std::unordered_map<QString, std::vector<int>> &keys);
 
     /* @brief Reset cache (discarding all thumbs stored in memory) */
     void clearCache();
 
+    /* @brief Returns the hit / miss counters of the cache */
+    Stats stats() const;
+
 protected:
     // Constructor is protected because class is a Singleton
     ThumbnailCache();
 
-    // Return the key associated to a thumbnail
-    static QString getKey(const QString &binId, int pos, bool *ok);
+    // Return the key associated to a thumbnail, and optionally the clip hash used to name its pack file
+    ThumbKey getKey(const QString &binId, int pos, bool *ok, QString *clipHash = nullptr) const;
     static QStringList getAudioKey(const QString &binId, bool *ok);
 
     // Return the dir where the persistent cache lives
@@ -94,11 +121,29 @@ protected:
     static std::once_flag m_onceFlag; // flag to create the repository only once;
 
     class Cache_t;
-    std::unique_ptr<Cache_t> m_volatileCache;
-    mutable QMutex m_mutex;
-
-    // the following maps keeps track of the positions that we store for each clip in volatile caches.
-    // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
-    std::unordered_map<QString, std::vector<int>> m_storedVolatile;
-    mutable std::unordered_map<QString, std::vector<int>> m_storedOnDisk;
+    struct Shard;
+    static const int ShardCount = 16;
+    std::unique_ptr<Shard[]> m_shards;
+    // Thumbnails larger than the capacity of a shard are kept in a separate, unsharded cache
+    std::unique_ptr<Shard> m_largeThumbs;
+    Shard &shard(const ThumbKey &key) const;
+    /* @brief Returns the cache where a thumbnail of @param cost bytes is stored */
+    Shard &shard(const ThumbKey &key, int cost) const;
+    /* @brief Looks for a thumbnail in the volatile cache, copying it in @param image if it is not null */
+    bool volatileThumbnail(const ThumbKey &key, QImage *image) const;
+
+    /* @brief Returns the pack file storing the thumbnails of a clip, nullptr if the cache folder is not available */
+    std::shared_ptr<ThumbnailPack> getPack(quint64 clip, const QString &clipHash) const;
+    mutable QMutex m_packMutex;
+    mutable std::unordered_map<quint64, std::shared_ptr<ThumbnailPack>> m_packs;
+
+    // Caches the hash of each bin clip, so that lookups don't need to query the bin model
+    mutable QReadWriteLock m_hashLock;
+    mutable std::unordered_map<QString, std::pair<quint64, QString>> m_clipHashes;
+
+    mutable std::atomic<quint64> m_memoryHits{0};
+    mutable std::atomic<quint64> m_diskHits{0};
+    mutable std::atomic<quint64> m_misses{0};
+    mutable std::atomic<quint64> m_stores{0};
+    mutable std::atomic<quint64> m_lookupTime{0};
 };
@@ -0,0 +1,222 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "thumbnailpack.hpp"
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtEndian>
+
+namespace {
+const QByteArray packMagic("KDENTHM1");
+const int recordHeaderSize = 8;
+} // namespace
+
+ThumbnailPack::ThumbnailPack(const QString &path)
+    : m_file(path)
+{
+}
+
+bool ThumbnailPack::contains(int frame)
+{
+    QMutexLocker locker(&m_mutex);
+    return open(false) && m_index.count(frame) > 0;
+}
+
+QImage ThumbnailPack::read(int frame)
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!open(false) || m_index.count(frame) == 0) {
+            return QImage();
+        }
+        const auto &record = m_index.at(frame);
+        if (record.first + record.second > m_mapSize && !remap()) {
+            return QImage();
+        }
+        // copy the encoded data so that decoding happens without holding the lock
+        data = QByteArray(reinterpret_cast<const char *>(m_map + record.first), (int)record.second);
+    }
+    return QImage::fromData(data);
+}
+
+bool ThumbnailPack::append(int frame, const QImage &img)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!img.save(&buffer, img.hasAlphaChannel() ? "PNG" : "JPG", img.hasAlphaChannel() ? -1 : 90)) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    return open(true) && writeRecord(frame, data);
+}
+
+void ThumbnailPack::discard()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_file.remove();
+    for (const QString &path : legacyThumbs()) {
+        QFile::remove(path);
+    }
+    m_index.clear();
+    m_end = 0;
+    m_mapSize = 0;
+    // Reading an existing pack would fail from now, but a new one can be created
+    m_checked = true;
+}
+
+bool ThumbnailPack::open(bool create)
+{
+    if (m_file.isOpen()) {
+        return true;
+    }
+    if (m_checked && !create) {
+        // We already know that there is no pack on disk
+        return false;
+    }
+    m_checked = true;
+    const QStringList legacy = legacyThumbs();
+    if (!create && legacy.isEmpty() && !m_file.exists()) {
+        return false;
+    }
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "// Error opening thumbnail pack " << m_file.fileName();
+        return false;
+    }
+    qint64 size = m_file.size();
+    if (size > 0 && (size < packMagic.size() || m_file.read(packMagic.size()) != packMagic)) {
+        // Unknown file, move it aside instead of overwriting it and start a new pack
+        const QString backup = m_file.fileName() + QStringLiteral(".bak");
+        qDebug() << "// Unknown thumbnail pack format, moving it to " << backup;
+        m_file.close();
+        QFile::remove(backup);
+        if (!QFile::rename(m_file.fileName(), backup) || !m_file.open(QIODevice::ReadWrite)) {
+            qDebug() << "// Error opening thumbnail pack " << m_file.fileName();
+            m_file.close();
+            return false;
+        }
+        size = 0;
+    }
+    if (size == 0) {
+        if (m_file.write(packMagic) != packMagic.size()) {
+            qDebug() << "// Error writing thumbnail pack " << m_file.fileName();
+            m_file.close();
+            return false;
+        }
+        m_file.flush();
+        m_end = packMagic.size();
+    } else {
+        if (!remap()) {
+            m_file.close();
+            return false;
+        }
+        qint64 pos = packMagic.size();
+        while (pos + recordHeaderSize <= size) {
+            int frame = qFromLittleEndian<qint32>(m_map + pos);
+            quint32 length = qFromLittleEndian<quint32>(m_map + pos + 4);
+            if (pos + recordHeaderSize + length > size) {
+                break;
+            }
+            m_index[frame] = {pos + recordHeaderSize, length};
+            pos += recordHeaderSize + length;
+        }
+        m_end = pos;
+        if (m_end < size) {
+            qDebug() << "// Dropping truncated record in thumbnail pack " << m_file.fileName();
+            m_file.unmap(m_map);
+            m_map = nullptr;
+            m_mapSize = 0;
+            m_file.resize(m_end);
+        }
+    }
+    migrateLegacy(legacy);
+    return true;
+}
+
+bool ThumbnailPack::remap()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+    m_map = m_file.map(0, m_file.size());
+    m_mapSize = m_map ? m_file.size() : 0;
+    return m_map != nullptr;
+}
+
+bool ThumbnailPack::writeRecord(int frame, const QByteArray &data)
+{
+    if (!m_file.seek(m_end)) {
+        return false;
+    }
+    uchar header[recordHeaderSize];
+    qToLittleEndian<qint32>(frame, header);
+    qToLittleEndian<quint32>((quint32)data.size(), header + 4);
+    if (m_file.write(reinterpret_cast<const char *>(header), recordHeaderSize) != recordHeaderSize || m_file.write(data) != data.size()) {
+        qDebug() << "// Error writing thumbnail pack " << m_file.fileName();
+        return false;
+    }
+    m_file.flush();
+    m_index[frame] = {m_end + recordHeaderSize, (quint32)data.size()};
+    m_end += recordHeaderSize + data.size();
+    return true;
+}
+
+QStringList ThumbnailPack::legacyThumbs() const
+{
+    // Legacy thumbnails were stored next to the pack, as <clip hash>#<frame>.png
+    QFileInfo info(m_file.fileName());
+    QDir dir = info.dir();
+    QStringList result;
+    for (const QString &name : dir.entryList({info.completeBaseName() + QStringLiteral("#*.png")}, QDir::Files)) {
+        result << dir.absoluteFilePath(name);
+    }
+    return result;
+}
+
+void ThumbnailPack::migrateLegacy(const QStringList &files)
+{
+    const int prefixSize = QFileInfo(m_file.fileName()).completeBaseName().size() + 1;
+    for (const QString &path : files) {
+        const QString name = QFileInfo(path).fileName();
+        bool ok = false;
+        int frame = name.midRef(prefixSize, name.size() - prefixSize - 4).toInt(&ok);
+        QFile legacyFile(path);
+        if (ok && m_index.count(frame) == 0 && legacyFile.open(QIODevice::ReadOnly)) {
+            // The pack can store the PNG data as is
+            const QByteArray data = legacyFile.readAll();
+            legacyFile.close();
+            if (!data.isEmpty() && !writeRecord(frame, data)) {
+                // Keep the remaining files, they will be migrated next time
+                return;
+            }
+        }
+        legacyFile.remove();
+    }
+}
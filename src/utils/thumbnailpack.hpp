@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QImage>
+#include <QMutex>
+#include <QStringList>
+#include <unordered_map>
+
+/** @brief Append-only file storing all the persistent thumbnails of a clip.
+    The file starts with a magic string and is followed by records, each made of the frame number and the size of the encoded image (both
+    32 bits, little endian), followed by the image data. The index of the records is rebuilt when the pack is first accessed, a truncated
+    trailing record (eg. after a crash) is dropped. When a frame is stored several times, the last record wins. The written part of the
+    file is memory mapped for reading.
+    Thumbnails stored by previous versions as one <hash>#<frame>.png file per frame are moved into the pack when it is first opened.
+    This class is thread safe.
+ */
+class ThumbnailPack
+{
+public:
+    /** @brief Creates a pack stored in @param path, named after the clip hash. The file is only opened (or created) on first access */
+    explicit ThumbnailPack(const QString &path);
+
+    bool contains(int frame);
+    QImage read(int frame);
+    /** @brief Stores the image of a frame, encoded in JPG or in PNG for images with an alpha channel */
+    bool append(int frame, const QImage &img);
+
+    /** @brief Closes and deletes the pack file */
+    void discard();
+
+protected:
+    /** @brief Opens the pack and builds its index. Must be called with the mutex locked
+        @param create if true, the file is created when it doesn't exist
+    */
+    bool open(bool create);
+    /** @brief Maps the whole written part of the pack. Must be called with the mutex locked */
+    bool remap();
+    /** @brief Writes a record at the end of the pack. Must be called with the mutex locked */
+    bool writeRecord(int frame, const QByteArray &data);
+    /** @brief Returns the thumbnail files of the former one file per frame cache that belong to this pack */
+    QStringList legacyThumbs() const;
+    /** @brief Moves the given legacy thumbnail files into the pack. Must be called with the mutex locked */
+    void migrateLegacy(const QStringList &files);
+
+    QMutex m_mutex;
+    QFile m_file;
+    bool m_checked{false};
+    uchar *m_map{nullptr};
+    qint64 m_mapSize{0};
+    qint64 m_end{0};
+    std::unordered_map<int, std::pair<qint64, quint32>> m_index; // frame -> (offset of the image data, size of the image data)
+};
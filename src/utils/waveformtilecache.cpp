@@ -0,0 +1,230 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "waveformtilecache.hpp"
+#include "lib/audio/audioPeaks.h"
+
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <cmath>
+
+std::unique_ptr<WaveformTileCache> WaveformTileCache::instance;
+std::once_flag WaveformTileCache::m_onceFlag;
+
+bool WaveformTileCache::TileKey::operator==(const TileKey &other) const
+{
+    return tile == other.tile && zoom == other.zoom && stream == other.stream && height == other.height && channels == other.channels &&
+           separateChannels == other.separateChannels && color == other.color && clipHash == other.clipHash;
+}
+
+std::size_t WaveformTileCache::TileKeyHash::operator()(const TileKey &key) const
+{
+    std::size_t seed = std::hash<QString>()(key.clipHash);
+    for (qint64 v : {qint64(key.stream), key.zoom, qint64(key.tile), qint64(key.height), qint64(key.channels), qint64(key.separateChannels), qint64(key.color)}) {
+        seed ^= std::hash<qint64>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+WaveformTileCache::WaveformTileCache()
+    : QObject()
+    , m_maxMemory(64 * 1024 * 1024)
+{
+    // Leave room for the playback and the clip jobs
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+WaveformTileCache::~WaveformTileCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+std::unique_ptr<WaveformTileCache> &WaveformTileCache::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new WaveformTileCache()); });
+    return instance;
+}
+
+// static
+qint64 WaveformTileCache::zoomKey(double framesPerPixel)
+{
+    return qRound64(qAbs(framesPerPixel) * 1000000.);
+}
+
+QImage WaveformTileCache::tile(const TileKey &key, const std::shared_ptr<const AudioPeakFile> &peaks)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+        return it->second->second;
+    }
+    if (!peaks || m_pending.count(key) > 0) {
+        return QImage();
+    }
+    quint64 generation = ++m_generation;
+    m_pending[key] = generation;
+    class TileRenderer : public QRunnable
+    {
+    public:
+        TileRenderer(WaveformTileCache *cache, TileKey key, std::shared_ptr<const AudioPeakFile> peaks, quint64 generation)
+            : m_cache(cache)
+            , m_key(std::move(key))
+            , m_peaks(std::move(peaks))
+            , m_generation(generation)
+        {
+        }
+        void run() override
+        {
+            double framesPerPixel = m_key.zoom / 1000000.;
+            QImage img(TileWidth, m_key.height, QImage::Format_ARGB32_Premultiplied);
+            img.fill(Qt::transparent);
+            QPainter painter(&img);
+            drawWaveform(&painter, *m_peaks, m_key.tile * TileWidth * framesPerPixel, framesPerPixel, TileWidth, m_key.height, m_key.channels,
+                         m_key.separateChannels, QColor::fromRgba(m_key.color));
+            painter.end();
+            m_cache->insert(m_key, img, m_generation);
+        }
+
+    private:
+        WaveformTileCache *m_cache;
+        TileKey m_key;
+        std::shared_ptr<const AudioPeakFile> m_peaks;
+        quint64 m_generation;
+    };
+    m_pool.start(new TileRenderer(this, key, peaks, generation));
+    return QImage();
+}
+
+void WaveformTileCache::insert(const TileKey &key, const QImage &image, quint64 generation)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(key);
+        if (it == m_pending.end() || it->second != generation) {
+            // The clip was invalidated while rendering, the tile might have been requested again since
+            return;
+        }
+        m_pending.erase(it);
+        m_tiles.emplace_front(key, image);
+        m_index[key] = m_tiles.begin();
+        m_memory += image.sizeInBytes();
+        while (m_memory > m_maxMemory && m_tiles.size() > 1) {
+            const Entry &last = m_tiles.back();
+            m_memory -= last.second.sizeInBytes();
+            m_index.erase(last.first);
+            m_tiles.pop_back();
+        }
+    }
+    emit tileReady(key.clipHash);
+}
+
+void WaveformTileCache::invalidateClip(const QString &clipHash)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (it->first.clipHash == clipHash) {
+            m_memory -= it->second.sizeInBytes();
+            m_index.erase(it->first);
+            it = m_tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (it->first.clipHash == clipHash) {
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// static
+void WaveformTileCache::drawWaveform(QPainter *painter, const AudioPeakFile &peaks, double startFrame, double framesPerPixel, int width, int height,
+                                     int channels, bool separateChannels, const QColor &color)
+{
+    // Read the peak level with about one bin per pixel for the current zoom
+    const int level = peaks.levelForZoom(framesPerPixel);
+    channels = qMin(channels, peaks.channels());
+    // Scale to the loudest sample, like the former 8 bit levels
+    const double scale = 1. / peaks.maxLevel();
+    if (channels <= 0 || width <= 0) {
+        return;
+    }
+    QPen pen = painter->pen();
+    pen.setColor(color);
+    pen.setWidthF(0);
+    painter->setBrush(color);
+    painter->setPen(pen);
+    if (!separateChannels) {
+        // Draw merged channels
+        QPolygonF polygon;
+        polygon.reserve(width + 3);
+        polygon << QPointF(0, height);
+        for (int x = 0; x <= width; x++) {
+            double start = startFrame + x * framesPerPixel;
+            int peak = 0;
+            for (int k = 0; k < channels; k++) {
+                auto range = peaks.range(level, k, start, start + framesPerPixel);
+                peak = qMax(peak, qMax(-range.first, range.second));
+            }
+            polygon << QPointF(x, height - height * qMin(1., peak * scale));
+        }
+        polygon << QPointF(width, height);
+        painter->drawPolygon(polygon);
+        return;
+    }
+    double channelHeight = (double)height / channels;
+    // Draw separate channels
+    QRectF bgRect(0, 0, width, channelHeight);
+    QVector<QPointF> bottom;
+    for (int channel = 0; channel < channels; channel++) {
+        // y is channel median pos
+        double y = (channel * channelHeight) + channelHeight / 2;
+        painter->setOpacity(0.2);
+        if (channel % 2 == 0) {
+            // Add dark background on odd channels
+            bgRect.moveTo(0, channel * channelHeight);
+            painter->fillRect(bgRect, Qt::black);
+        }
+        // Draw channel median line
+        painter->setOpacity(0.5);
+        painter->drawLine(QLineF(0., y, width, y));
+        painter->setOpacity(1);
+        // The outline goes along the maximums, then back along the minimums
+        QPolygonF polygon;
+        polygon.reserve(2 * (width + 1));
+        bottom.clear();
+        for (int x = 0; x <= width; x++) {
+            double start = startFrame + x * framesPerPixel;
+            auto range = peaks.range(level, channel, start, start + framesPerPixel);
+            polygon << QPointF(x, y - qMin(1., range.second * scale) * channelHeight / 2);
+            bottom << QPointF(x, y - qMax(-1., range.first * scale) * channelHeight / 2);
+        }
+        for (int i = bottom.size() - 1; i >= 0; i--) {
+            polygon << bottom.at(i);
+        }
+        painter->drawPolygon(polygon);
+    }
+}
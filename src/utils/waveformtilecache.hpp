@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QColor>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class AudioPeakFile;
+class QPainter;
+
+/** @brief This class caches rasterized timeline waveforms.
+    Waveforms are split in tiles of fixed width, aligned on the frames of the source clip, so that all the timeline clips using the same
+    source and displayed at the same zoom share their tiles. Missing tiles are rendered on a thread pool, and tileReady is emitted when
+    they are available, so that painting a waveform never has to compute it.
+ * Note that this class is a Singleton
+ */
+class WaveformTileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Width of a tile, in pixels */
+    static const int TileWidth = 256;
+
+    struct TileKey
+    {
+        QString clipHash;
+        int stream;
+        // frames per pixel, in millionth of frame
+        qint64 zoom;
+        int tile;
+        int height;
+        int channels;
+        bool separateChannels;
+        QRgb color;
+        bool operator==(const TileKey &other) const;
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<WaveformTileCache> &get();
+    ~WaveformTileCache() override;
+
+    /** @brief Returns the zoom value used in the tile keys for a given scale */
+    static qint64 zoomKey(double framesPerPixel);
+
+    /** @brief Returns a tile from the cache.
+        If it is not available yet, a null image is returned and the tile is rendered in the background from the given peaks
+    */
+    QImage tile(const TileKey &key, const std::shared_ptr<const AudioPeakFile> &peaks);
+
+    /** @brief Removes all the tiles of a clip, for example when its audio was recomputed */
+    void invalidateClip(const QString &clipHash);
+
+    /** @brief Draws the waveform of a range of the source clip, starting at @param startFrame */
+    static void drawWaveform(QPainter *painter, const AudioPeakFile &peaks, double startFrame, double framesPerPixel, int width, int height, int channels,
+                             bool separateChannels, const QColor &color);
+
+signals:
+    /** @brief A tile of the given clip was rendered */
+    void tileReady(const QString &clipHash);
+
+protected:
+    WaveformTileCache();
+    static std::unique_ptr<WaveformTileCache> instance;
+    static std::once_flag m_onceFlag; // flag to create the repository only once;
+
+private:
+    struct TileKeyHash
+    {
+        std::size_t operator()(const TileKey &key) const;
+    };
+    using Entry = std::pair<TileKey, QImage>;
+
+    /** @brief Stores a rendered tile, @param generation identifies the request */
+    void insert(const TileKey &key, const QImage &image, quint64 generation);
+
+    QMutex m_mutex;
+    QThreadPool m_pool;
+    // Most recently used tiles are at the front
+    std::list<Entry> m_tiles;
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> m_index;
+    // Tiles being rendered, with the generation of their request
+    std::unordered_map<TileKey, quint64, TileKeyHash> m_pending;
+    quint64 m_generation{0};
+    qint64 m_memory{0};
+    qint64 m_maxMemory;
+};
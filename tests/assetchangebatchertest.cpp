@@ -0,0 +1,109 @@
+#include "test_utils.hpp"
+
+#include "assets/model/assetchangebatcher.hpp"
+#include "effects/effectstack/model/effectitemmodel.hpp"
+#include "effects/effectstack/model/effectstackmodel.hpp"
+
+Mlt::Profile profile_batcher;
+
+TEST_CASE("Coalesce asset parameter changes", "[AssetChangeBatcher]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_batcher, guideModel, undoStack);
+
+    QString binId = createProducer(profile_batcher, "red", binModel);
+    int tid1 = TrackModel::construct(timeline);
+    int cid1;
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 100, cid1));
+
+    auto stack = timeline->getClipPtr(cid1)->m_effectStack;
+    REQUIRE(stack->appendEffect(QStringLiteral("sepia")));
+    auto effect = std::dynamic_pointer_cast<EffectItemModel>(stack->getEffectStackRow(0));
+    REQUIRE(effect);
+
+    auto &batcher = AssetChangeBatcher::get();
+    // Discard notifications of the effect creation
+    batcher->flush();
+    batcher->resetStats();
+
+    int dataChanges = 0;
+    int modelChanges = 0;
+    int firstRow = -1;
+    int lastRow = -1;
+    auto c1 = QObject::connect(effect.get(), &QAbstractItemModel::dataChanged, [&](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        dataChanges++;
+        firstRow = topLeft.row();
+        lastRow = bottomRight.row();
+    });
+    auto c2 = QObject::connect(effect.get(), &AssetParameterModel::modelChanged, [&]() { modelChanges++; });
+
+    SECTION("Values are applied immediately, notifications once per frame")
+    {
+        for (int i = 0; i < 10; ++i) {
+            effect->setParameter(QStringLiteral("u"), QString::number(50 + i), true);
+        }
+        effect->setParameter(QStringLiteral("v"), QStringLiteral("120"), true);
+        // The filter already has the new values
+        REQUIRE(effect->m_asset->get_int("u") == 59);
+        REQUIRE(effect->m_asset->get_int("v") == 120);
+        REQUIRE(dataChanges == 0);
+        REQUIRE(modelChanges == 0);
+
+        auto stats = batcher->stats();
+        REQUIRE(stats.changes == 11);
+        REQUIRE(stats.coalesced == 10);
+
+        batcher->flush();
+        REQUIRE(dataChanges == 1);
+        REQUIRE(modelChanges == 1);
+        REQUIRE(firstRow == effect->m_rows.indexOf(QStringLiteral("u")));
+        REQUIRE(lastRow == effect->m_rows.indexOf(QStringLiteral("v")));
+        stats = batcher->stats();
+        REQUIRE(stats.flushes == 1);
+        REQUIRE(stats.monitorRefreshes == 1);
+        REQUIRE(stats.invalidations == 1);
+
+        // Nothing left to send
+        batcher->flush();
+        REQUIRE(dataChanges == 1);
+        REQUIRE(batcher->stats().flushes == 1);
+    }
+    SECTION("Changes made while notifying are sent on the next frame")
+    {
+        bool reentered = false;
+        auto c3 = QObject::connect(effect.get(), &AssetParameterModel::modelChanged, [&]() {
+            if (!reentered) {
+                reentered = true;
+                effect->setParameter(QStringLiteral("v"), QStringLiteral("100"), true);
+            }
+        });
+        effect->setParameter(QStringLiteral("u"), QStringLiteral("60"), true);
+        batcher->flush();
+        REQUIRE(reentered);
+        REQUIRE(effect->m_asset->get_int("v") == 100);
+        REQUIRE(dataChanges == 1);
+        REQUIRE(modelChanges == 1);
+
+        batcher->flush();
+        REQUIRE(dataChanges == 2);
+        REQUIRE(modelChanges == 2);
+        REQUIRE(firstRow == effect->m_rows.indexOf(QStringLiteral("v")));
+        REQUIRE(lastRow == firstRow);
+        QObject::disconnect(c3);
+    }
+    QObject::disconnect(c1);
+    QObject::disconnect(c2);
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
@@ -0,0 +1,134 @@
+#include "test_utils.hpp"
+
+#include "lib/audio/audioLevels.h"
+#include "lib/audio/audioPeaks.h"
+#include <QImage>
+#include <QTemporaryDir>
+#include <cmath>
+#include <random>
+
+TEST_CASE("Streaming audio level reduction", "[AudioLevels]")
+{
+    const int frequency = 48000;
+    const double fps = 25.;
+    const int samplesPerFrame = 1920;
+    const int frames = 50;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::uniform_int_distribution<int> blockDist(1, 5000);
+
+    for (int channels : {1, 2, 6}) {
+        std::vector<qint16> data(size_t(frames * samplesPerFrame * channels));
+        for (auto &v : data) {
+            v = qint16(dist(gen));
+        }
+        AudioLevelReducer reducer(channels, frequency, fps);
+        // Feed blocks of random sizes, as they come from the pipe
+        int offset = 0;
+        const int total = frames * samplesPerFrame;
+        while (offset < total) {
+            int block = qMin(total - offset, blockDist(gen));
+            reducer.process(data.data() + offset * channels, block);
+            offset += block;
+        }
+        reducer.finish();
+        REQUIRE(reducer.samplesConsumed() == total);
+        REQUIRE(reducer.binCount() == frames);
+        for (int f = 0; f < frames; ++f) {
+            for (int c = 0; c < channels; ++c) {
+                int minimum = 0;
+                int maximum = 0;
+                double squares = 0;
+                for (int s = f * samplesPerFrame; s < (f + 1) * samplesPerFrame; ++s) {
+                    int v = data[size_t(s * channels + c)];
+                    minimum = qMin(minimum, v);
+                    maximum = qMax(maximum, v);
+                    squares += double(v) * v;
+                }
+                size_t ix = size_t(f * channels + c);
+                REQUIRE(reducer.minimums()[ix] == minimum);
+                REQUIRE(reducer.maximums()[ix] == maximum);
+                REQUIRE(reducer.rms()[ix] == Approx(std::sqrt(squares / samplesPerFrame)).epsilon(0.001));
+            }
+        }
+    }
+}
+
+TEST_CASE("Audio peak file levels", "[AudioLevels]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("test.peaks"));
+    const int channels = 2;
+    const int binsPerFrame = 4;
+    const int frames = 1000;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<qint16> minimums, maximums;
+    for (int i = 0; i < frames * binsPerFrame * channels; ++i) {
+        int a = dist(gen);
+        int b = dist(gen);
+        minimums.push_back(qint16(qMin(a, b)));
+        maximums.push_back(qint16(qMax(a, b)));
+    }
+    REQUIRE(AudioPeakFile::write(path, channels, binsPerFrame, minimums, maximums));
+    auto peaks = AudioPeakFile::open(path);
+    REQUIRE(peaks);
+    REQUIRE(peaks->channels() == channels);
+    REQUIRE(peaks->frameCount() == frames);
+    REQUIRE(peaks->levelCount() > 3);
+    REQUIRE(peaks->level(0).binCount == frames * binsPerFrame);
+    REQUIRE(peaks->level(1).binCount == frames * binsPerFrame / 2);
+
+    // Every level gives the same extrema for a range aligned on its bins
+    for (int level = 0; level < peaks->levelCount(); ++level) {
+        double span = peaks->level(level).framesPerBin;
+        for (int channel = 0; channel < channels; ++channel) {
+            double start = span * 3;
+            double end = start + span;
+            int low = 0;
+            int high = 0;
+            for (int bin = int(start * binsPerFrame); bin < int(end * binsPerFrame) && bin < frames * binsPerFrame; ++bin) {
+                low = qMin(low, minimums[size_t(bin * channels + channel)] >> 8);
+                high = qMax(high, maximums[size_t(bin * channels + channel)] >> 8);
+            }
+            auto range = peaks->range(level, channel, start, end);
+            REQUIRE(range.first == low);
+            REQUIRE(range.second == high);
+        }
+    }
+    // Zoom selection picks coarser levels when zooming out
+    REQUIRE(peaks->levelForZoom(0.1) == 0);
+    REQUIRE(peaks->levelForZoom(1. / binsPerFrame * 2) == 1);
+    REQUIRE(peaks->levelForZoom(1000.) == peaks->levelCount() - 1);
+}
+
+TEST_CASE("Legacy audio thumbnail conversion", "[AudioLevels]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const int channels = 2;
+    // 8 frames of 2 channels, packed 4 values by pixel
+    QImage image(4, channels, QImage::Format_ARGB32);
+    std::vector<int> levels;
+    for (int i = 0; i < image.width() * image.height(); ++i) {
+        int r = (i * 16) % 256, g = (i * 16 + 4) % 256, b = (i * 16 + 8) % 256, a = (i * 16 + 12) % 256;
+        image.setPixel(i / channels, i % channels, qRgba(r, g, b, a));
+        levels.insert(levels.end(), {r, g, b, a});
+    }
+    const QString imagePath = dir.filePath(QStringLiteral("legacy.png"));
+    const QString path = dir.filePath(QStringLiteral("legacy.peaks"));
+    REQUIRE(image.save(imagePath));
+    REQUIRE(AudioPeakFile::convertLegacyImage(imagePath, channels, path));
+    auto peaks = AudioPeakFile::open(path);
+    REQUIRE(peaks);
+    REQUIRE(peaks->frameCount() == int(levels.size()) / channels);
+    for (int frame = 0; frame < peaks->frameCount(); ++frame) {
+        for (int channel = 0; channel < channels; ++channel) {
+            auto range = peaks->range(0, channel, frame, frame + 1);
+            int expected = (levels[size_t(frame * channels + channel)] * 32767 / 255) >> 8;
+            REQUIRE(range.second == expected);
+            REQUIRE(range.first == (-(levels[size_t(frame * channels + channel)] * 32767 / 255)) >> 8);
+        }
+    }
+}
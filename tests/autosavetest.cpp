@@ -0,0 +1,97 @@
+#include "test_utils.hpp"
+
+#include "project/autosavejournal.h"
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+namespace {
+
+QByteArray makeScene(int clips)
+{
+    QByteArray scene("<?xml version='1.0' encoding='utf-8'?>\n<mlt>\n");
+    for (int i = 0; i < clips; ++i) {
+        scene.append(QStringLiteral(" <producer id=\"producer%1\"><property name=\"length\">%2</property></producer>\n").arg(i).arg(i * 25).toUtf8());
+    }
+    scene.append("</mlt>\n");
+    return scene;
+}
+
+// Keeps the journals out of the user data folder
+struct TestPaths
+{
+    TestPaths() { QStandardPaths::setTestModeEnabled(true); }
+    ~TestPaths()
+    {
+        QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+        QStandardPaths::setTestModeEnabled(false);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Autosave journal", "[AutoSave]")
+{
+    const QByteArray base = makeScene(500);
+
+    SECTION("Entries rebuild the scene")
+    {
+        QByteArray edited = base;
+        edited.replace("producer250\"><property name=\"length\">6250", "producer250\"><property name=\"length\">42");
+        REQUIRE(edited != base);
+        const QByteArray entry = AutoSaveJournal::createEntry(base, edited);
+        REQUIRE(entry.size() < base.size() / 10);
+        QByteArray result;
+        REQUIRE(AutoSaveJournal::applyEntry(base, entry, result));
+        REQUIRE(result == edited);
+
+        // Insertions, removals and changes at both ends
+        for (const QByteArray &scene : {makeScene(501), makeScene(499), QByteArray("<mlt/>"), QByteArray(), base, QByteArray(base + base)}) {
+            QByteArray rebuilt;
+            REQUIRE(AutoSaveJournal::applyEntry(base, AutoSaveJournal::createEntry(base, scene), rebuilt));
+            REQUIRE(rebuilt == scene);
+        }
+    }
+
+    SECTION("Entries only apply to their base")
+    {
+        const QByteArray entry = AutoSaveJournal::createEntry(base, makeScene(501));
+        QByteArray result("unchanged");
+        REQUIRE_FALSE(AutoSaveJournal::applyEntry(makeScene(499), entry, result));
+        REQUIRE_FALSE(AutoSaveJournal::applyEntry(base, entry.left(entry.size() / 2), result));
+        REQUIRE_FALSE(AutoSaveJournal::applyEntry(base, QByteArray(), result));
+        REQUIRE(result == QByteArray("unchanged"));
+    }
+
+    SECTION("Replay on recovery")
+    {
+        TestPaths paths;
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString autosave = dir.filePath(QStringLiteral("autosave.kdenlive"));
+        QFile file(autosave);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(base);
+        file.close();
+
+        // Nothing to replay
+        REQUIRE(AutoSaveJournal::replay(autosave));
+
+        const QByteArray edited = makeScene(520);
+        REQUIRE(AutoSaveJournal::write(autosave, AutoSaveJournal::createEntry(base, edited)));
+        REQUIRE(QFile::exists(AutoSaveJournal::journalFile(autosave)));
+        REQUIRE(AutoSaveJournal::replay(autosave));
+        REQUIRE_FALSE(QFile::exists(AutoSaveJournal::journalFile(autosave)));
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        REQUIRE(file.readAll() == edited);
+        file.close();
+
+        // A journal written against an older base is ignored
+        REQUIRE(AutoSaveJournal::write(autosave, AutoSaveJournal::createEntry(base, makeScene(10))));
+        REQUIRE_FALSE(AutoSaveJournal::replay(autosave));
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        REQUIRE(file.readAll() == edited);
+        file.close();
+        AutoSaveJournal::discard(autosave);
+        REQUIRE_FALSE(QFile::exists(AutoSaveJournal::journalFile(autosave)));
+    }
+}
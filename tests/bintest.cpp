@@ -0,0 +1,105 @@
+#include "test_utils.hpp"
+
+Mlt::Profile profile_bin;
+
+TEST_CASE("Bin id lookup", "[BinModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    QString binId = createProducer(profile_bin, "red", binModel);
+    QString binId2 = createProducer(profile_bin, "blue", binModel);
+
+    SECTION("Clips are found by id")
+    {
+        REQUIRE(binModel->getClipByBinID(binId) != nullptr);
+        REQUIRE(binModel->getClipByBinID(binId)->clipId() == binId);
+        REQUIRE(binModel->getClipByBinID(binId2)->clipId() == binId2);
+        REQUIRE(binModel->hasClip(binId));
+        REQUIRE_FALSE(binModel->isIdFree(binId));
+        REQUIRE(binModel->getClipByBinID(QStringLiteral("9999")) == nullptr);
+        REQUIRE(binModel->isIdFree(QStringLiteral("9999")));
+    }
+
+    SECTION("Suffixed ids resolve to the master clip")
+    {
+        QString suffixed = binId + QStringLiteral("_0");
+        REQUIRE(binModel->getClipByBinID(suffixed) == binModel->getClipByBinID(binId));
+    }
+
+    SECTION("Folders are not returned as clips")
+    {
+        QString folderId;
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(binModel->requestAddFolder(folderId, QStringLiteral("folder"), binModel->getRootFolder()->clipId(), undo, redo));
+        REQUIRE(binModel->getFolderByBinId(folderId) != nullptr);
+        REQUIRE(binModel->getClipByBinID(folderId) == nullptr);
+        REQUIRE(binModel->getFolderByBinId(binId) == nullptr);
+        REQUIRE(binModel->getItemByBinId(folderId) != nullptr);
+        REQUIRE(undo());
+        REQUIRE(binModel->getFolderByBinId(folderId) == nullptr);
+        REQUIRE(binModel->isIdFree(folderId));
+    }
+
+    SECTION("Index follows deletion and undo")
+    {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(binModel->requestBinClipDeletion(binModel->getItemByBinId(binId), undo, redo));
+        REQUIRE(binModel->getClipByBinID(binId) == nullptr);
+        REQUIRE(binModel->isIdFree(binId));
+        REQUIRE(binModel->getClipByBinID(binId2) != nullptr);
+        REQUIRE(undo());
+        REQUIRE(binModel->getClipByBinID(binId) != nullptr);
+        REQUIRE(binModel->getClipByBinID(binId)->clipId() == binId);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Bin id lookup benchmark", "[.][benchmark][BinModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::vector<QString> ids;
+    const int lookups = 100000;
+    // Lookup cost should stay flat while the bin grows
+    for (int size : {30, 300, 3000}) {
+        while ((int)ids.size() < size) {
+            ids.push_back(createProducer(profile_bin, "red", binModel));
+        }
+        const QString last = ids.back();
+        const QString suffixed = ids.front() + QStringLiteral("_1");
+        const std::string name = QStringLiteral("%1 lookups, bin of %2 clips").arg(lookups).arg(size).toStdString();
+        int found = 0;
+        BENCHMARK(name)
+        {
+            for (int i = 0; i < lookups; ++i) {
+                if (binModel->getClipByBinID(i % 2 == 0 ? last : suffixed)) {
+                    found++;
+                }
+            }
+        }
+        REQUIRE(found > 0);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
@@ -0,0 +1,111 @@
+#include "test_utils.hpp"
+
+#include "jobs/cachejob.hpp"
+#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <map>
+
+Mlt::Profile profile_cache;
+
+TEST_CASE("Parallel thumbnail extraction", "[CacheJob]")
+{
+    std::vector<int> frames;
+    for (int i = 0; i < 40; i += 3) {
+        frames.push_back(i);
+    }
+    auto makeProducers = [](int count) {
+        std::vector<std::shared_ptr<Mlt::Producer>> producers;
+        for (int i = 0; i < count; ++i) {
+            producers.push_back(std::make_shared<Mlt::Producer>(profile_cache, "color", "red"));
+            REQUIRE(producers.back()->is_valid());
+        }
+        return producers;
+    };
+    QMutex mutex;
+    std::map<int, QImage> extracted;
+    int duplicates = 0;
+    auto store = [&](int frame, const QImage &img) {
+        QMutexLocker locker(&mutex);
+        if (!extracted.emplace(frame, img).second) {
+            duplicates++;
+        }
+    };
+
+    SECTION("Each frame is extracted once")
+    {
+        // More producers than frames for the last case
+        for (int workers : {1, 3, 20}) {
+            extracted.clear();
+            CacheJob::extractFrames(makeProducers(workers), frames, 0, store, []() { return false; });
+            REQUIRE(duplicates == 0);
+            REQUIRE(extracted.size() == frames.size());
+            for (int frame : frames) {
+                REQUIRE(extracted.count(frame) == 1);
+                const QImage &img = extracted.at(frame);
+                REQUIRE(img.size() == QSize(profile_cache.width(), profile_cache.height()));
+                REQUIRE(img.pixelColor(img.width() / 2, img.height() / 2) == QColor(Qt::red));
+            }
+        }
+    }
+
+    SECTION("Thumbnails are scaled to the requested width")
+    {
+        CacheJob::extractFrames(makeProducers(2), {0, 10}, 100, store, []() { return false; });
+        REQUIRE(extracted.size() == 2);
+        REQUIRE(extracted.at(10).size() == QSize(100, profile_cache.height()));
+    }
+
+    SECTION("Canceled extraction stops")
+    {
+        CacheJob::extractFrames(makeProducers(2), frames, 0, store, []() { return true; });
+        REQUIRE(extracted.empty());
+    }
+
+    SECTION("Visible frames are extracted first")
+    {
+        std::set<int> all(frames.begin(), frames.end());
+        auto batches = CacheJob::frameBatches(all, {{10, 20}, {30, 34}});
+        REQUIRE(batches.size() == 2);
+        REQUIRE(batches[0] == std::vector<int>({12, 15, 18, 30, 33}));
+        REQUIRE(batches[1] == std::vector<int>({0, 3, 6, 9, 21, 24, 27, 36, 39}));
+        // Without visible range, a single batch holds all the frames in increasing order
+        batches = CacheJob::frameBatches(all, {});
+        REQUIRE(batches.size() == 1);
+        REQUIRE(batches[0] == frames);
+        batches = CacheJob::frameBatches(all, {{0, 100}});
+        REQUIRE(batches.size() == 1);
+        REQUIRE(batches[0] == frames);
+    }
+}
+
+TEST_CASE("Parallel thumbnail extraction benchmark", "[.][benchmark][CacheJob]")
+{
+    const std::string path = QFileInfo("../tests/small.mkv").absoluteFilePath().toStdString();
+    std::shared_ptr<Mlt::Producer> probe = std::make_shared<Mlt::Producer>(profile_cache, "avformat", path.c_str());
+    if (!probe->is_valid()) {
+        WARN("No avformat support, skipping thumbnail extraction benchmark");
+        return;
+    }
+    int length = probe->get_length();
+    std::vector<int> frames;
+    for (int i = 0; i < length; i += 2) {
+        frames.push_back(i);
+    }
+    REQUIRE(!frames.empty());
+
+    for (int workers = 1; workers <= QThread::idealThreadCount() && workers <= 8; workers *= 2) {
+        std::vector<std::shared_ptr<Mlt::Producer>> producers;
+        for (int i = 0; i < workers; ++i) {
+            producers.push_back(std::make_shared<Mlt::Producer>(profile_cache, "avformat", path.c_str()));
+            REQUIRE(producers.back()->is_valid());
+        }
+        std::atomic<int> extracted{0};
+        const std::string name = QStringLiteral("%1 thumbnails, %2 producers").arg(frames.size()).arg(workers).toStdString();
+        BENCHMARK(name)
+        {
+            CacheJob::extractFrames(producers, frames, 0, [&](int, const QImage &) { extracted++; }, []() { return false; });
+        }
+        REQUIRE(extracted >= (int)frames.size());
+    }
+}
@@ -0,0 +1,178 @@
+#include "test_utils.hpp"
+
+#include "monitor/scopes/dataqueue.h"
+#include <QMutex>
+#include <QWaitCondition>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// The previous mutex based queue, in discard oldest mode, for comparison
+template <class T> class MutexQueue
+{
+public:
+    explicit MutexQueue(int maxSize)
+        : m_maxSize(maxSize)
+    {
+    }
+    void push(const T &item)
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_queue.size() == m_maxSize) {
+            m_queue.removeFirst();
+        }
+        m_queue.append(item);
+        if (m_queue.size() == 1) {
+            m_notEmptyCondition.wakeOne();
+        }
+    }
+    T pop()
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_queue.isEmpty()) {
+            m_notEmptyCondition.wait(&m_mutex);
+        }
+        return m_queue.takeFirst();
+    }
+    int count() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_queue.size();
+    }
+
+private:
+    QList<T> m_queue;
+    int m_maxSize;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmptyCondition;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Push a timestamp at 120 fps while the consumer polls like ScopeWidget::refreshScope, returns the average and worst latency in µs
+template <class Queue> std::pair<double, qint64> frameLatency(Queue &queue, int frames)
+{
+    std::thread producer([&queue, frames]() {
+        const auto start = Clock::now();
+        for (int i = 0; i < frames; ++i) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(i * 1000000 / 120));
+            queue.push(Clock::now().time_since_epoch().count());
+        }
+    });
+    qint64 total = 0;
+    qint64 worst = 0;
+    int received = 0;
+    while (received < frames) {
+        if (queue.count() > 0) {
+            const qint64 sent = queue.pop();
+            const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch() - Clock::duration(sent)).count();
+            total += latency;
+            worst = qMax(worst, qint64(latency));
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    return {double(total) / frames, worst};
+}
+
+} // namespace
+
+TEST_CASE("Scope frame queue", "[DataQueue]")
+{
+    SECTION("Discard oldest")
+    {
+        DataQueue<QString> queue(3, DataQueue<QString>::OverflowModeDiscardOldest);
+        for (int i = 0; i < 5; ++i) {
+            queue.push(QString::number(i));
+        }
+        REQUIRE(queue.count() == 3);
+        REQUIRE(queue.dropped() == 2);
+        REQUIRE(queue.pop() == QStringLiteral("2"));
+        REQUIRE(queue.pop() == QStringLiteral("3"));
+        REQUIRE(queue.pop() == QStringLiteral("4"));
+        QString item;
+        REQUIRE_FALSE(queue.tryPop(item));
+        REQUIRE(queue.count() == 0);
+    }
+
+    SECTION("Discard newest")
+    {
+        DataQueue<int> queue(3, DataQueue<int>::OverflowModeDiscardNewest);
+        for (int i = 0; i < 5; ++i) {
+            queue.push(i);
+        }
+        REQUIRE(queue.dropped() == 2);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(queue.pop() == i);
+        }
+    }
+
+    SECTION("Wait with several producers")
+    {
+        DataQueue<int> queue(3, DataQueue<int>::OverflowModeWait);
+        const int count = 20000;
+        std::thread even([&queue]() {
+            for (int i = 0; i < count; i += 2) {
+                queue.push(i);
+            }
+        });
+        std::thread odd([&queue]() {
+            for (int i = 1; i < count; i += 2) {
+                queue.push(i);
+            }
+        });
+        qint64 sum = 0;
+        int lastEven = -2;
+        int lastOdd = -1;
+        bool ordered = true;
+        for (int i = 0; i < count; ++i) {
+            const int value = queue.pop();
+            sum += value;
+            int &last = value % 2 ? lastOdd : lastEven;
+            ordered = ordered && value > last;
+            last = value;
+        }
+        even.join();
+        odd.join();
+        REQUIRE(ordered);
+        REQUIRE(sum == qint64(count) * (count - 1) / 2);
+        REQUIRE(queue.dropped() == 0);
+    }
+}
+
+TEST_CASE("Scope frame queue benchmark", "[.][benchmark][DataQueue]")
+{
+    const int items = 1000000;
+    BENCHMARK("Mutex queue, push and pop")
+    {
+        MutexQueue<qint64> queue(3);
+        for (int i = 0; i < items; ++i) {
+            queue.push(i);
+            if (queue.count() > 1) {
+                queue.pop();
+            }
+        }
+    }
+    BENCHMARK("Lock-free queue, push and pop")
+    {
+        DataQueue<qint64> queue(3, DataQueue<qint64>::OverflowModeDiscardOldest);
+        qint64 item;
+        for (int i = 0; i < items; ++i) {
+            queue.push(i);
+            if (queue.count() > 1) {
+                queue.tryPop(item);
+            }
+        }
+    }
+
+    MutexQueue<qint64> mutexQueue(3);
+    auto latency = frameLatency(mutexQueue, 240);
+    WARN("Mutex queue at 120 fps: " << latency.first << "µs average latency, " << latency.second << "µs worst");
+    DataQueue<qint64> ring(3, DataQueue<qint64>::OverflowModeDiscardOldest);
+    latency = frameLatency(ring, 240);
+    WARN("Lock-free queue at 120 fps: " << latency.first << "µs average latency, " << latency.second << "µs worst");
+    REQUIRE(ring.dropped() == 0);
+}
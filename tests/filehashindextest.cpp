@@ -0,0 +1,100 @@
+#include "test_utils.hpp"
+
+#include "utils/filehashindex.hpp"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace {
+void writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+}
+} // namespace
+
+TEST_CASE("File hash index", "[FileHashIndex]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString indexFile = dir.filePath(QStringLiteral("cache/filehash.index"));
+
+    SECTION("Hash formats")
+    {
+        REQUIRE(FileHashIndex::hashData(QByteArray(), FileHashIndex::Algorithm::Fast) == QStringLiteral("ef46db3751d8e999"));
+        REQUIRE(FileHashIndex::hashData(QByteArray("abc"), FileHashIndex::Algorithm::Fast) == QStringLiteral("44bc2cf5ad770999"));
+        // Inputs of 32 bytes or more go through the 4 lanes
+        REQUIRE(FileHashIndex::hashData(QByteArray("Nobody inspects the spammish repetition"), FileHashIndex::Algorithm::Fast) ==
+                QStringLiteral("fbcea83c8a378bf1"));
+        REQUIRE(FileHashIndex::hashData(QByteArray(100, 'a'), FileHashIndex::Algorithm::Fast) == QStringLiteral("375041e8b1decfb3"));
+        REQUIRE(FileHashIndex::hashData(QByteArray("abc"), FileHashIndex::Algorithm::Md5) == QStringLiteral("900150983cd24fb0d6963f7d28e17f72"));
+        REQUIRE(FileHashIndex::algorithmFor(QStringLiteral("44bc2cf5ad770999")) == FileHashIndex::Algorithm::Fast);
+        REQUIRE(FileHashIndex::algorithmFor(QStringLiteral("900150983cd24fb0d6963f7d28e17f72")) == FileHashIndex::Algorithm::Md5);
+    }
+
+    SECTION("Large files are hashed on their first and last MB")
+    {
+        QByteArray data(3000000, 'a');
+        data.replace(1000000, 1000000, QByteArray(1000000, 'b'));
+        const QString path = dir.filePath(QStringLiteral("large.bin"));
+        writeFile(path, data);
+        FileHashIndex index(QString());
+        const QByteArray sample = data.left(1000000) + data.right(1000000);
+        REQUIRE(index.fileHash(path, FileHashIndex::Algorithm::Md5) == QString::fromLatin1(QCryptographicHash::hash(sample, QCryptographicHash::Md5).toHex()));
+        REQUIRE(index.fileHash(path, FileHashIndex::Algorithm::Fast) == FileHashIndex::hashData(sample, FileHashIndex::Algorithm::Fast));
+    }
+
+    SECTION("Indexed files are not read again")
+    {
+        const QString path = dir.filePath(QStringLiteral("clip.bin"));
+        writeFile(path, QByteArray("first content"));
+        QString hash;
+        {
+            FileHashIndex index(indexFile);
+            hash = index.fileHash(path, FileHashIndex::Algorithm::Md5);
+            REQUIRE(hash == FileHashIndex::hashData(QByteArray("first content"), FileHashIndex::Algorithm::Md5));
+            REQUIRE(index.fileHash(path, FileHashIndex::Algorithm::Md5) == hash);
+            REQUIRE(index.filesRead() == 1);
+            // Each format is computed once
+            index.fileHash(path, FileHashIndex::Algorithm::Fast);
+            REQUIRE(index.filesRead() == 2);
+            REQUIRE(index.fileHash(dir.filePath(QStringLiteral("missing.bin")), FileHashIndex::Algorithm::Md5).isEmpty());
+        }
+        REQUIRE(QFile::exists(indexFile));
+
+        // The index is reloaded from disk
+        FileHashIndex index(indexFile);
+        REQUIRE(index.fileHash(path, FileHashIndex::Algorithm::Md5) == hash);
+        REQUIRE(index.filesRead() == 0);
+
+        // A modified file is hashed again
+        writeFile(path, QByteArray("second, longer content"));
+        REQUIRE(index.fileHash(path, FileHashIndex::Algorithm::Md5) ==
+                FileHashIndex::hashData(QByteArray("second, longer content"), FileHashIndex::Algorithm::Md5));
+        REQUIRE(index.filesRead() == 1);
+    }
+
+    SECTION("Find a file among candidates")
+    {
+        QStringList paths;
+        for (int i = 0; i < 8; ++i) {
+            paths << dir.filePath(QStringLiteral("candidate%1.bin").arg(i));
+            writeFile(paths.last(), QByteArray::number(i).repeated(100));
+        }
+        FileHashIndex index(QString());
+        const QString md5 = FileHashIndex::hashData(QByteArray::number(5).repeated(100), FileHashIndex::Algorithm::Md5);
+        const QString fast = FileHashIndex::hashData(QByteArray::number(6).repeated(100), FileHashIndex::Algorithm::Fast);
+        REQUIRE(index.findFile(paths, md5) == paths.at(5));
+        REQUIRE(index.findFile(paths, fast) == paths.at(6));
+        REQUIRE(index.findFile(paths, QStringLiteral("0123456789abcdef")).isEmpty());
+        REQUIRE(index.filesRead() == 16);
+
+        const QStringList hashes = index.fileHashes(paths, FileHashIndex::Algorithm::Md5);
+        REQUIRE(hashes.size() == paths.size());
+        REQUIRE(hashes.at(5) == md5);
+        REQUIRE(index.filesRead() == 16);
+    }
+}
@@ -0,0 +1,79 @@
+#include "test_utils.hpp"
+
+#include "jobs/jobscheduler.hpp"
+#include <QMutex>
+#include <QSemaphore>
+#include <atomic>
+
+TEST_CASE("Job scheduler priorities", "[JobScheduler]")
+{
+    JobScheduler scheduler(2);
+    QMutex orderMutex;
+    std::vector<JobScheduler::Priority> order;
+    QSemaphore gate;
+    QSemaphore blocked;
+
+    // Occupy both threads so that everything queued afterwards is dispatched by priority
+    for (int i = 0; i < 2; ++i) {
+        scheduler.enqueue(JobScheduler::LoadPriority, [&]() {
+            blocked.release();
+            gate.acquire();
+        });
+    }
+    blocked.acquire(2);
+
+    std::atomic<int> runningTranscodes{0};
+    std::atomic<int> maxTranscodes{0};
+    auto record = [&](JobScheduler::Priority p) {
+        QMutexLocker lk(&orderMutex);
+        order.push_back(p);
+    };
+    // Tasks record themselves when they run, which is racy between threads, so the dispatch order is checked from the
+    // scheduler's own count of started tasks, which is updated under its lock when a task is handed to a thread
+    std::vector<qint64> thumbsDispatchedBeforeTranscode;
+    for (int i = 0; i < 4; ++i) {
+        scheduler.enqueue(JobScheduler::TranscodePriority, [&]() {
+            record(JobScheduler::TranscodePriority);
+            {
+                QMutexLocker schedulerLock(&scheduler.m_mutex);
+                qint64 thumbs = scheduler.m_startedCount[JobScheduler::ThumbPriority];
+                QMutexLocker lk(&orderMutex);
+                thumbsDispatchedBeforeTranscode.push_back(thumbs);
+            }
+            int current = ++runningTranscodes;
+            int previous = maxTranscodes;
+            while (current > previous && !maxTranscodes.compare_exchange_weak(previous, current)) {
+            }
+            QThread::msleep(5);
+            --runningTranscodes;
+        });
+    }
+    for (int i = 0; i < 4; ++i) {
+        scheduler.enqueue(JobScheduler::ThumbPriority, [&]() { record(JobScheduler::ThumbPriority); });
+    }
+    REQUIRE(scheduler.queueDepth(JobScheduler::ThumbPriority) == 4);
+    REQUIRE(scheduler.queueDepth(JobScheduler::TranscodePriority) == 4);
+    REQUIRE(scheduler.runningCount(JobScheduler::LoadPriority) == 2);
+
+    gate.release(2);
+    scheduler.waitForDone();
+
+    REQUIRE(order.size() == 8);
+    // All thumbnails were dispatched before the first transcode
+    REQUIRE(thumbsDispatchedBeforeTranscode.size() == 4);
+    for (qint64 thumbs : thumbsDispatchedBeforeTranscode) {
+        REQUIRE(thumbs == 4);
+    }
+    // Transcodes are capped to a part of the pool
+    REQUIRE(maxTranscodes == 1);
+    REQUIRE(scheduler.queueDepth(JobScheduler::ThumbPriority) == 0);
+    REQUIRE(scheduler.queueDepth(JobScheduler::TranscodePriority) == 0);
+}
+
+TEST_CASE("Job priority classes", "[JobScheduler]")
+{
+    REQUIRE(JobScheduler::priorityForType(AbstractClipJob::THUMBJOB) < JobScheduler::priorityForType(AbstractClipJob::AUDIOTHUMBJOB));
+    REQUIRE(JobScheduler::priorityForType(AbstractClipJob::AUDIOTHUMBJOB) < JobScheduler::priorityForType(AbstractClipJob::LOADJOB));
+    REQUIRE(JobScheduler::priorityForType(AbstractClipJob::LOADJOB) < JobScheduler::priorityForType(AbstractClipJob::PROXYJOB));
+    REQUIRE(JobScheduler::priorityForType(AbstractClipJob::PROXYJOB) == JobScheduler::priorityForType(AbstractClipJob::TRANSCODEJOB));
+}
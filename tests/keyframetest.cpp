@@ -251,6 +251,35 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+
+    SECTION("Interpolated values follow modifications")
+    {
+        REQUIRE(model->addKeyframe(GenTime(50, 25), KeyframeType::Linear, 1.));
+        auto check_range = [&]() {
+            QVector<QVariant> values = model->getInterpolatedValues(0, 60);
+            REQUIRE(values.size() == 61);
+            for (int i = 0; i <= 60; ++i) {
+                REQUIRE(values.at(i).toDouble() == Approx(model->getInterpolatedValue(i).toDouble()));
+            }
+            return values;
+        };
+        QVector<QVariant> values = check_range();
+        REQUIRE(values.at(50).toDouble() == Approx(1.));
+        REQUIRE(values.at(60).toDouble() == Approx(1.));
+        for (int i = 1; i <= 50; ++i) {
+            REQUIRE(values.at(i).toDouble() >= values.at(i - 1).toDouble());
+        }
+
+        // The cached animation must be dropped on modification
+        REQUIRE(model->addKeyframe(GenTime(40, 25), KeyframeType::Discrete, 0.));
+        values = check_range();
+        REQUIRE(values.at(45).toDouble() == Approx(0.));
+        undoStack->undo();
+        values = check_range();
+        REQUIRE(values.at(45).toDouble() > 0.);
+
+        REQUIRE(model->getInterpolatedValues(10, 9).isEmpty());
+    }
     pCore->m_projectManager = nullptr;
     Logger::print_trace();
 }
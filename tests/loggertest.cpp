@@ -0,0 +1,208 @@
+#include "test_utils.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace fakeit;
+Mlt::Profile profile_logger;
+
+namespace {
+// Traced through the macros, which must expand without the GNU comma extension
+struct TracedObject
+{
+    TracedObject() { TRACE_CONSTR(this); }
+    void noArgs() { TRACE(); }
+    int withArgs(int value, const QString &name)
+    {
+        TRACE(value, name);
+        TRACE_RES(value * 2);
+        return value * 2;
+    }
+    static void staticCall(const std::shared_ptr<TracedObject> &object, bool flag) { TRACE_STATIC(object, flag); }
+};
+} // namespace
+
+TEST_CASE("Bounded operation tracer", "[Logger]")
+{
+    Logger::clear();
+
+    SECTION("Only top level calls are logged")
+    {
+        LogGuard outer;
+        REQUIRE(outer.hasGuard());
+        {
+            LogGuard inner;
+            REQUIRE_FALSE(inner.hasGuard());
+        }
+    }
+
+    SECTION("Runtime switch")
+    {
+        Logger::set_enabled(false);
+        REQUIRE_FALSE(Logger::is_enabled());
+        {
+            LogGuard guard;
+            REQUIRE_FALSE(guard.hasGuard());
+        }
+        Logger::set_enabled(true);
+        LogGuard guard;
+        REQUIRE(guard.hasGuard());
+    }
+
+    SECTION("Buffers have a fixed size")
+    {
+        Logger::set_buffer_size(1024);
+        for (int i = 0; i < 10; ++i) {
+            Logger::log_undo(i % 2 == 0);
+        }
+        REQUIRE(Logger::dropped_records() == 0);
+        for (int i = 0; i < 1000; ++i) {
+            Logger::log_undo(i % 2 == 0);
+        }
+        REQUIRE(Logger::dropped_records() > 0);
+        Logger::clear();
+        REQUIRE(Logger::dropped_records() == 0);
+        Logger::set_buffer_size(4 * 1024 * 1024);
+    }
+}
+
+TEST_CASE("Trace macros", "[Logger]")
+{
+    Logger::clear();
+    auto object = std::make_shared<TracedObject>();
+    object->noArgs();
+    REQUIRE(object->withArgs(21, QStringLiteral("name")) == 42);
+    TracedObject::staticCall(object, true);
+
+    Logger::decode_trace();
+    REQUIRE(Logger::operations.size() == 4);
+    REQUIRE(Logger::operations[0].can_convert<Logger::ConstrId>());
+    REQUIRE(Logger::constr.size() == 1);
+    REQUIRE(Logger::constr.begin()->second.size() == 1);
+    REQUIRE(Logger::constr.begin()->second[0].second.empty());
+    REQUIRE(Logger::invoks.size() == 3);
+    REQUIRE(Logger::invoks[0].method == "noArgs");
+    REQUIRE(Logger::invoks[0].args.empty());
+    REQUIRE_FALSE(Logger::invoks[0].res.is_valid());
+    REQUIRE(Logger::invoks[1].method == "withArgs");
+    REQUIRE(Logger::invoks[1].args.size() == 2);
+    REQUIRE(Logger::invoks[1].args[0].convert<int>() == 21);
+    REQUIRE(Logger::invoks[1].args[1].convert<QString>() == QStringLiteral("name"));
+    REQUIRE(Logger::invoks[1].res.convert<int>() == 42);
+    REQUIRE(Logger::invoks[2].method == "staticCall");
+    REQUIRE(Logger::invoks[2].args.size() == 1);
+    REQUIRE(Logger::invoks[2].args[0].convert<bool>());
+    Logger::clear();
+}
+
+TEST_CASE("Trace round trip", "[Logger]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_logger, guideModel, undoStack);
+    TimelineModel *model = timeline.get();
+
+    // Only keep the operations written below
+    Logger::clear();
+    Logger::log_constr(model);
+    Logger::log_create_producer("test_producer", {std::string("red"), binModel, 20, true});
+    Logger::log(model, "requestClipMove", 3, 1, 25, true, false, true, false);
+    std::thread other([&]() {
+        Logger::log(model, "requestClipsGroup", std::unordered_set<int>({4}), true, GroupType::Normal);
+        Logger::log_res(7);
+    });
+    other.join();
+    // Results belong to the last call of their thread, even when another thread logged in between
+    Logger::log_res(true);
+    Logger::log_undo(true);
+    Logger::log(timeline.get(), "requestClipCut", 3, 10);
+    Logger::log_res(false);
+
+    Logger::decode_trace();
+    REQUIRE(Logger::dropped_records() == 0);
+    REQUIRE(Logger::operations.size() == 6);
+    auto invok = [](size_t operation) -> const Logger::Invok & {
+        REQUIRE(Logger::operations[operation].can_convert<Logger::InvokId>());
+        return Logger::invoks[Logger::operations[operation].convert<Logger::InvokId>().id];
+    };
+
+    REQUIRE(Logger::operations[0].can_convert<Logger::ConstrId>());
+    auto constrId = Logger::operations[0].convert<Logger::ConstrId>();
+    REQUIRE(constrId.type == "TimelineModel");
+    REQUIRE(Logger::constr["TimelineModel"].size() == 1);
+    REQUIRE(Logger::constr["TimelineModel"][constrId.id].first.convert<TimelineModel *>() == model);
+    REQUIRE(Logger::constr["TimelineModel"][constrId.id].second.empty());
+
+    REQUIRE(Logger::operations[1].can_convert<Logger::ConstrId>());
+    constrId = Logger::operations[1].convert<Logger::ConstrId>();
+    REQUIRE(constrId.type == "test_producer");
+    const auto &producerArgs = Logger::constr["test_producer"][constrId.id].second;
+    REQUIRE(producerArgs.size() == 4);
+    REQUIRE(producerArgs[0].convert<std::string>() == "red");
+    REQUIRE(producerArgs[1].convert<ProjectItemModel *>() == binModel.get());
+    REQUIRE(producerArgs[2].convert<int>() == 20);
+    REQUIRE(producerArgs[3].convert<bool>());
+
+    const Logger::Invok &move = invok(2);
+    REQUIRE(move.ptr.convert<TimelineModel *>() == model);
+    REQUIRE(move.method == "requestClipMove");
+    REQUIRE(move.args.size() == 7);
+    REQUIRE(move.args[0].get_type() == rttr::type::get<int>());
+    REQUIRE(move.args[2].convert<int>() == 25);
+    REQUIRE(move.args[3].get_type() == rttr::type::get<bool>());
+    REQUIRE_FALSE(move.args[4].convert<bool>());
+    REQUIRE(move.res.get_type() == rttr::type::get<bool>());
+    REQUIRE(move.res.convert<bool>());
+
+    const Logger::Invok &group = invok(3);
+    REQUIRE(group.ptr.convert<TimelineModel *>() == model);
+    REQUIRE(group.method == "requestClipsGroup");
+    REQUIRE(group.args.size() == 3);
+    REQUIRE(group.args[0].convert<std::unordered_set<int>>() == std::unordered_set<int>({4}));
+    REQUIRE(group.args[2].get_type() == rttr::type::get<GroupType>());
+    REQUIRE(group.args[2].convert<GroupType>() == GroupType::Normal);
+    REQUIRE(group.res.convert<int>() == 7);
+
+    REQUIRE(Logger::operations[4].can_convert<Logger::Undo>());
+    REQUIRE(Logger::operations[4].convert<Logger::Undo>().undo);
+
+    const Logger::Invok &cut = invok(5);
+    REQUIRE(cut.ptr.convert<TimelineItemModel *>() == timeline.get());
+    REQUIRE(cut.method == "requestClipCut");
+    REQUIRE(cut.args.size() == 2);
+    REQUIRE(cut.args[1].convert<int>() == 10);
+    REQUIRE_FALSE(cut.res.convert<bool>());
+
+    // The generated test case replays the same operations
+    Logger::print_trace();
+    std::ifstream file("test_case_" + std::to_string(Logger::dump_count) + ".cpp");
+    REQUIRE(file.is_open());
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string testCase = ss.str();
+    std::vector<std::string> expected = {"TimelineItemModel tim_0(&reg_profile, undoStack);",
+                                         "createProducer(reg_profile, \"red\", binModel, 20, true);",
+                                         "timeline_0->requestClipMove(3, 1, 25, true, false, true, false);",
+                                         "REQUIRE( res == true);",
+                                         "timeline_0->requestClipsGroup(",
+                                         "true, GroupType::Normal);",
+                                         "REQUIRE( res == 7);",
+                                         "undoStack->undo();",
+                                         "TimelineFunctions::requestClipCut(timeline_0, 3, 10);",
+                                         "REQUIRE( res == false);"};
+    size_t pos = 0;
+    for (const std::string &line : expected) {
+        INFO(line);
+        pos = testCase.find(line, pos);
+        REQUIRE(pos != std::string::npos);
+    }
+
+    Logger::clear();
+    pCore->m_projectManager = nullptr;
+}
@@ -0,0 +1,67 @@
+#include "test_utils.hpp"
+
+#include "audiomixer/mixerwidget.hpp"
+#include <QDomDocument>
+#include <mlt++/MltConsumer.h>
+#include <mlt++/MltTractor.h>
+
+Mlt::Profile profile_mixer;
+
+namespace {
+// Returns the value of the disable property of each audio meter in the serialized scene
+QStringList meterStates(Mlt::Tractor &tractor)
+{
+    Mlt::Consumer xmlConsumer(profile_mixer, "xml", "kdenlive_playlist");
+    xmlConsumer.set("store", "kdenlive");
+    xmlConsumer.connect(tractor);
+    xmlConsumer.run();
+    QDomDocument doc;
+    doc.setContent(QString::fromUtf8(xmlConsumer.get("kdenlive_playlist")));
+    QStringList states;
+    QDomNodeList filters = doc.elementsByTagName(QStringLiteral("filter"));
+    for (int i = 0; i < filters.count(); ++i) {
+        QString service;
+        QString disable;
+        QDomNodeList props = filters.item(i).toElement().elementsByTagName(QStringLiteral("property"));
+        for (int j = 0; j < props.count(); ++j) {
+            QDomElement prop = props.item(j).toElement();
+            if (prop.attribute(QStringLiteral("name")) == QLatin1String("mlt_service")) {
+                service = prop.text();
+            } else if (prop.attribute(QStringLiteral("name")) == QLatin1String("disable")) {
+                disable = prop.text();
+            }
+        }
+        if (service == QLatin1String("audiolevel") || service == QLatin1String("loudness_meter")) {
+            states << disable;
+        }
+    }
+    return states;
+}
+} // namespace
+
+TEST_CASE("Audio meters are paused in the saved scene", "[MixerWidget]")
+{
+    Mlt::Tractor tractor(profile_mixer);
+    Mlt::Producer producer(profile_mixer, "color:red");
+    REQUIRE(producer.is_valid());
+    tractor.set_track(producer, 0);
+
+    MixerWidget mixer(1, &tractor, QStringLiteral("A1"));
+    // The rms and peak meters, and the loudness meter when available
+    REQUIRE(mixer.m_monitorFilter);
+    REQUIRE(mixer.m_peakFilter);
+
+    mixer.pauseMonitoring(true);
+    QStringList states = meterStates(tractor);
+    REQUIRE(states.size() == (mixer.m_loudnessFilter ? 3 : 2));
+    for (const QString &state : states) {
+        REQUIRE(state == QLatin1String("1"));
+    }
+
+    mixer.pauseMonitoring(false);
+    REQUIRE(mixer.m_monitorFilter->get_int("disable") == 0);
+    REQUIRE(mixer.m_peakFilter->get_int("disable") == 0);
+    if (mixer.m_loudnessFilter) {
+        REQUIRE(mixer.m_loudnessFilter->get_int("disable") == 0);
+    }
+}
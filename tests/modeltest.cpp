@@ -2067,3 +2067,114 @@ TEST_CASE("Operations under locked tracks", "[Locked]")
     pCore->m_projectManager = nullptr;
     Logger::print_trace();
 }
+
+TEST_CASE("Bulk loading", "[ClipModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+
+    const int length = 20;
+    QString binId = createProducer(profile_model, "red", binModel, length);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+
+    // Loading happens inside a model reset, so that views don't query silently changing rows
+    int aboutToReset = 0;
+    int reset = 0;
+    int inserted = 0;
+    QObject::connect(timeline.get(), &QAbstractItemModel::modelAboutToBeReset, [&]() { aboutToReset++; });
+    QObject::connect(timeline.get(), &QAbstractItemModel::modelReset, [&]() { reset++; });
+    QObject::connect(timeline.get(), &QAbstractItemModel::rowsInserted, [&]() { inserted++; });
+
+    timeline->setBulkLoading(true);
+    REQUIRE(timeline->isBulkLoading());
+    REQUIRE(aboutToReset == 1);
+    REQUIRE(reset == 0);
+    for (int i = 0; i < 100; ++i) {
+        int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(timeline->requestClipMove(cid, i % 2 == 0 ? tid1 : tid2, (i / 2) * length, true, true, false, true, undo, redo));
+    }
+    REQUIRE(reset == 0);
+    REQUIRE(inserted == 0);
+    timeline->setBulkLoading(false);
+    REQUIRE_FALSE(timeline->isBulkLoading());
+    REQUIRE(aboutToReset == 1);
+    REQUIRE(reset == 1);
+
+    REQUIRE(timeline->checkConsistency());
+    REQUIRE(timeline->getClipsCount() == 100);
+    REQUIRE(timeline->duration() == 50 * length);
+    REQUIRE(timeline->m_snaps->getNextPoint(0) == length);
+    REQUIRE(timeline->m_snaps->getPreviousPoint(50 * length) == 49 * length);
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Bulk loading benchmark", "[.][benchmark][ClipModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    const int clipCount = 20000;
+    const int trackCount = 4;
+    const int length = 10;
+    QString binId = createProducer(profile_model, "red", binModel, length);
+
+    // Builds a timeline the way the project loader does, with or without bulk loading
+    auto load = [&](bool bulk) {
+        std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_model, guideModel, undoStack);
+        std::vector<int> tracks;
+        for (int i = 0; i < trackCount; ++i) {
+            tracks.push_back(TrackModel::construct(timeline));
+        }
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        timeline->setBulkLoading(bulk);
+        for (int i = 0; i < clipCount; ++i) {
+            int cid = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+            if (bulk) {
+                Fun local_undo = []() { return true; };
+                Fun local_redo = []() { return true; };
+                timeline->requestClipMove(cid, tracks[size_t(i % trackCount)], (i / trackCount) * length, true, true, false, true, local_undo, local_redo);
+            } else {
+                timeline->requestClipMove(cid, tracks[size_t(i % trackCount)], (i / trackCount) * length, true, true, false, true, undo, redo);
+            }
+        }
+        timeline->setBulkLoading(false);
+        REQUIRE(timeline->getClipsCount() == clipCount);
+    };
+
+    BENCHMARK("Load 20000 clips with interactive insertions")
+    {
+        load(false);
+    }
+    BENCHMARK("Load 20000 clips in bulk")
+    {
+        load(true);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
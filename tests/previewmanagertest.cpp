@@ -0,0 +1,125 @@
+#include "test_utils.hpp"
+
+#include "kdenlivesettings.h"
+#include "timeline2/view/previewmanager.h"
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+#include <mlt++/MltTractor.h>
+
+Mlt::Profile profile_preview;
+
+TEST_CASE("Invalidating a zone only stops the workers rendering it", "[PreviewManager]")
+{
+    // Stand-in for kdenlive_render: waits for chunks on stdin
+    const QString cat = QStandardPaths::findExecutable(QStringLiteral("cat"));
+    if (cat.isEmpty()) {
+        WARN("No cat executable, skipping preview worker test");
+        return;
+    }
+    Mlt::Tractor tractor(profile_preview);
+    PreviewManager manager(nullptr, &tractor);
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    const QList<int> chunks{0, chunkSize, 2 * chunkSize, 4 * chunkSize, -1};
+    for (int chunk : chunks) {
+        auto *process = new QProcess(&manager);
+        process->start(cat, {});
+        REQUIRE(process->waitForStarted());
+        manager.m_workers << PreviewManager::PreviewWorker{process, chunk, false};
+    }
+    // Keep the lowest chunk in progress, so that the (missing) controller is not notified
+    manager.workingPreview = 0;
+    QList<QProcess *> processes;
+    for (const auto &worker : manager.m_workers) {
+        processes << worker.process;
+    }
+
+    // Frames in the second and third chunks
+    manager.invalidatePreview(chunkSize + 1, 2 * chunkSize + 1);
+
+    QList<int> remaining;
+    for (const auto &worker : manager.m_workers) {
+        remaining << worker.chunk;
+        // Survivors finish their chunk but don't get new ones
+        REQUIRE(worker.retired);
+    }
+    REQUIRE(remaining == QList<int>{0, 4 * chunkSize, -1});
+    REQUIRE(manager.workerIndex(processes.at(0)) == 0);
+    REQUIRE(manager.workerIndex(processes.at(1)) == -1);
+    REQUIRE(manager.workerIndex(processes.at(2)) == -1);
+    REQUIRE(processes.at(1)->state() == QProcess::NotRunning);
+    REQUIRE(processes.at(2)->state() == QProcess::NotRunning);
+    // No new worker is started on the outdated scene
+    REQUIRE(manager.m_sceneList.isEmpty());
+    REQUIRE(manager.workingPreview == 0);
+
+    for (const auto &worker : manager.m_workers) {
+        worker.process->disconnect(&manager);
+        worker.process->kill();
+        worker.process->waitForFinished();
+    }
+    manager.m_workers.clear();
+}
+
+TEST_CASE("Outdated scenes are deleted with their last worker", "[PreviewManager]")
+{
+    const QString cat = QStandardPaths::findExecutable(QStringLiteral("cat"));
+    if (cat.isEmpty()) {
+        WARN("No cat executable, skipping preview worker test");
+        return;
+    }
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString scene = dir.filePath(QStringLiteral("preview.mlt"));
+    QFile file(scene);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.close();
+    Mlt::Tractor tractor(profile_preview);
+    PreviewManager manager(nullptr, &tractor);
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    manager.m_sceneList = scene;
+    for (int chunk : {0, chunkSize}) {
+        auto *process = new QProcess(&manager);
+        process->start(cat, {});
+        REQUIRE(process->waitForStarted());
+        manager.m_workers << PreviewManager::PreviewWorker{process, chunk, false, scene};
+    }
+    manager.workingPreview = 0;
+
+    // The workers are not rendering the invalidated zone, they are retired
+    manager.invalidatePreview(4 * chunkSize, 5 * chunkSize);
+    REQUIRE(manager.m_workers.count() == 2);
+    REQUIRE(manager.m_sceneList.isEmpty());
+    REQUIRE(QFile::exists(scene));
+    manager.stopWorker(1);
+    REQUIRE(QFile::exists(scene));
+    manager.stopWorker(0);
+    REQUIRE_FALSE(QFile::exists(scene));
+}
+
+TEST_CASE("A renderer that fails to start is not waited for", "[PreviewManager]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString scene = dir.filePath(QStringLiteral("preview.mlt"));
+    QFile file(scene);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.close();
+    Mlt::Tractor tractor(profile_preview);
+    PreviewManager manager(nullptr, &tractor);
+    manager.m_renderer = dir.filePath(QStringLiteral("missing_renderer"));
+    manager.m_sceneList = scene;
+
+    manager.startWorker();
+    // The failure is reported asynchronously
+    for (int i = 0; i < 500 && !manager.m_workers.isEmpty(); ++i) {
+        QCoreApplication::processEvents();
+        QThread::msleep(10);
+    }
+    REQUIRE(manager.m_workers.isEmpty());
+    // No worker is started again on this scene
+    REQUIRE(manager.m_sceneList.isEmpty());
+    REQUIRE_FALSE(QFile::exists(scene));
+}
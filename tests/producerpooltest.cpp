@@ -0,0 +1,102 @@
+#include "test_utils.hpp"
+
+#include "bin/producerpool.h"
+#include <mlt++/MltFilter.h>
+
+TEST_CASE("Producer pool", "[ProducerPool]")
+{
+    Mlt::Profile profile;
+    int created = 0;
+    auto create = [&profile, &created]() {
+        created++;
+        auto *producer = new Mlt::Producer(profile, "color", "red");
+        producer->set("length", 100);
+        producer->set_in_and_out(0, 99);
+        return producer;
+    };
+    auto pool = std::make_shared<ProducerPool>(2);
+
+    SECTION("Released producers are reused in their original state")
+    {
+        Mlt::Producer *raw = nullptr;
+        {
+            auto producer = pool->checkout(QStringLiteral("1"), 0, create);
+            raw = producer.get();
+            producer->set_in_and_out(10, 20);
+            producer->set("set.test_audio", 1);
+            Mlt::Filter filter(profile, "brightness");
+            producer->attach(filter);
+            producer->seek(5);
+            REQUIRE(pool->stats().checkedOut == 1);
+        }
+        REQUIRE(pool->stats().checkedOut == 0);
+        REQUIRE(pool->stats().recycled == 1);
+        REQUIRE(pool->stats().idle == 1);
+
+        auto producer = pool->checkout(QStringLiteral("1"), 0, create);
+        REQUIRE(producer.get() == raw);
+        REQUIRE(created == 1);
+        REQUIRE(producer->get_in() == 0);
+        REQUIRE(producer->get_out() == 99);
+        REQUIRE(producer->position() == 0);
+        REQUIRE(producer->get("set.test_audio") == nullptr);
+        REQUIRE(producer->filter_count() == 0);
+        REQUIRE(pool->stats().hits == 1);
+        REQUIRE(pool->stats().misses == 1);
+        REQUIRE(pool->stats().idle == 0);
+
+        // Other variants and clips don't share producers
+        auto other = pool->checkout(QStringLiteral("1"), 1, create);
+        REQUIRE(other.get() != raw);
+        REQUIRE(created == 2);
+        REQUIRE(pool->stats().checkedOut == 2);
+    }
+
+    SECTION("Producers still referenced by MLT are not reused")
+    {
+        std::unique_ptr<Mlt::Producer> cut;
+        {
+            auto producer = pool->checkout(QStringLiteral("1"), 0, create);
+            cut.reset(producer->cut(0, 10));
+        }
+        REQUIRE(pool->stats().discarded == 1);
+        REQUIRE(pool->stats().idle == 0);
+        REQUIRE(cut->parent().is_valid());
+    }
+
+    SECTION("Invalidated producers are closed")
+    {
+        pool->checkout(QStringLiteral("1"), 0, create);
+        auto producer = pool->checkout(QStringLiteral("2"), 0, create);
+        REQUIRE(pool->stats().idle == 1);
+        pool->invalidate(QStringLiteral("1"));
+        pool->invalidate(QStringLiteral("2"));
+        REQUIRE(pool->stats().idle == 0);
+        producer.reset();
+        REQUIRE(pool->stats().discarded == 1);
+        pool->checkout(QStringLiteral("2"), 0, create);
+        REQUIRE(created == 3);
+    }
+
+    SECTION("Least recently used producers are closed first")
+    {
+        {
+            auto p1 = pool->checkout(QStringLiteral("1"), 0, create);
+            auto p2 = pool->checkout(QStringLiteral("2"), 0, create);
+            auto p3 = pool->checkout(QStringLiteral("3"), 0, create);
+            p2.reset();
+            p1.reset();
+            p3.reset();
+        }
+        REQUIRE(pool->stats().evicted == 1);
+        REQUIRE(pool->stats().idle == 2);
+        pool->checkout(QStringLiteral("1"), 0, create);
+        pool->checkout(QStringLiteral("3"), 0, create);
+        REQUIRE(created == 3);
+        pool->checkout(QStringLiteral("2"), 0, create);
+        REQUIRE(created == 4);
+
+        pool->setMaxIdle(0);
+        REQUIRE(pool->stats().idle == 0);
+    }
+}
@@ -0,0 +1,155 @@
+#include "test_utils.hpp"
+
+#include "jobs/scenecutdetector.hpp"
+#include <QThread>
+#include <atomic>
+
+Mlt::Profile profile_scenecut;
+
+namespace {
+// Synthetic clip: textured scenes moving one pixel per frame, with noise and a slow fade
+const std::vector<int> sceneStarts{0, 37, 100, 201, 262, 300};
+const int sceneLength = 400;
+
+uint hashValue(uint a, uint b, uint c)
+{
+    uint h = a * 73856093u ^ b * 19349663u ^ c * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    return h ^ (h >> 15);
+}
+
+bool syntheticFrame(int position, uchar *luma)
+{
+    const int scene = int(std::upper_bound(sceneStarts.begin(), sceneStarts.end(), position) - sceneStarts.begin()) - 1;
+    const int offset = position - sceneStarts[(size_t)scene];
+    // Consecutive scenes differ in brightness and texture
+    const int base = scene % 2 == 0 ? 90 : 120;
+    const int fade = scene == 3 ? offset / 3 : 0;
+    for (int y = 0; y < SceneCutDetector::Height; ++y) {
+        for (int x = 0; x < SceneCutDetector::Width; ++x) {
+            int texture = int(hashValue(uint(x + offset) / 6, uint(y) / 6, uint(scene)) % 48);
+            int noise = int(hashValue(uint(x), uint(y), uint(position)) % 7) - 3;
+            luma[y * SceneCutDetector::Width + x] = uchar(qBound(0, base + fade + texture + noise + (x + y) / 8, 255));
+        }
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("Scene cut detection", "[SceneCutDetector]")
+{
+    const std::vector<int> expected(sceneStarts.begin() + 1, sceneStarts.end());
+    const std::vector<SceneCutDetector::Reader> single{syntheticFrame};
+    SceneCutDetector detector;
+
+    SECTION("Cuts of a synthetic sequence are found at the exact frames")
+    {
+        std::vector<int> cuts = detector.detect(single, sceneLength, []() { return false; });
+        REQUIRE(cuts == expected);
+    }
+
+    SECTION("Segments scanned in parallel give the same boundaries")
+    {
+        // 4 segments starting at 0, 100, 200 and 300, with cuts at and right after the edges
+        std::vector<SceneCutDetector::Reader> readers(4, syntheticFrame);
+        std::atomic<int> framesRead{0};
+        std::vector<int> cuts = detector.detect(readers, sceneLength, []() { return false; }, [&](int) { framesRead++; });
+        REQUIRE(cuts == expected);
+        // Each segment reads a few frames of the previous one
+        REQUIRE(framesRead >= sceneLength);
+        REQUIRE(framesRead <= sceneLength + 3 * (SceneCutDetector::Window + 1));
+    }
+
+    SECTION("Canceled detection stops reading")
+    {
+        int framesRead = 0;
+        std::vector<int> cuts = detector.detect(single, sceneLength, [&]() { return framesRead >= 50; }, [&](int count) { framesRead = count; });
+        REQUIRE(framesRead == 50);
+        REQUIRE(cuts == std::vector<int>{37});
+    }
+
+    SECTION("Identical frames don't differ")
+    {
+        std::vector<uchar> luma(SceneCutDetector::Width * SceneCutDetector::Height);
+        syntheticFrame(10, luma.data());
+        SceneCutDetector::Signature a, b;
+        SceneCutDetector::signature(luma.data(), a);
+        SceneCutDetector::signature(luma.data(), b);
+        REQUIRE(SceneCutDetector::difference(a, b) == 0.);
+        syntheticFrame(40, luma.data());
+        SceneCutDetector::signature(luma.data(), b);
+        REQUIRE(SceneCutDetector::difference(a, b) > 0.3);
+        REQUIRE(SceneCutDetector::difference(a, b) <= 1.);
+    }
+
+    SECTION("Luma extraction from packed yuv422")
+    {
+        std::vector<uchar> yuv(2 * 37);
+        for (size_t i = 0; i < yuv.size(); ++i) {
+            yuv[i] = uchar(i % 2 == 0 ? i / 2 * 5 : 128);
+        }
+        std::vector<uchar> luma(37);
+        SceneCutDetector::lumaFromYuv422(yuv.data(), 37, luma.data());
+        for (size_t i = 0; i < luma.size(); ++i) {
+            REQUIRE(luma[i] == uchar(i * 5));
+        }
+    }
+}
+
+TEST_CASE("Scene cut detection on producers", "[SceneCutDetector]")
+{
+    // Color clips played one after the other
+    const QStringList colors{QStringLiteral("red"), QStringLiteral("blue"), QStringLiteral("white"), QStringLiteral("black")};
+    const std::vector<int> lengths{60, 90, 100, 50};
+    std::vector<std::shared_ptr<Mlt::Producer>> producers;
+    for (int i = 0; i < 3; ++i) {
+        std::shared_ptr<Mlt::Playlist> playlist = std::make_shared<Mlt::Playlist>(profile_scenecut);
+        for (int c = 0; c < colors.size(); ++c) {
+            Mlt::Producer color(profile_scenecut, QStringLiteral("color:%1").arg(colors.at(c)).toUtf8().constData());
+            REQUIRE(color.is_valid());
+            playlist->append(color, 0, lengths[(size_t)c] - 1);
+        }
+        producers.push_back(playlist);
+    }
+    REQUIRE(producers.front()->get_playtime() == 300);
+    SceneCutDetector detector;
+    std::vector<int> cuts = detector.detect(producers, 300, []() { return false; });
+    REQUIRE(cuts == std::vector<int>{60, 150, 250});
+}
+
+TEST_CASE("Scene cut detection benchmark", "[.][benchmark][SceneCutDetector]")
+{
+    std::vector<uchar> luma(SceneCutDetector::Width * SceneCutDetector::Height);
+    syntheticFrame(10, luma.data());
+    SceneCutDetector::Signature a, b;
+    SceneCutDetector::signature(luma.data(), b);
+    BENCHMARK("Signature and difference, 1000 frames")
+    {
+        for (int i = 0; i < 1000; ++i) {
+            SceneCutDetector::signature(luma.data(), a);
+            SceneCutDetector::difference(a, b);
+        }
+    }
+
+    const std::string path = QFileInfo("../tests/small.mkv").absoluteFilePath().toStdString();
+    std::shared_ptr<Mlt::Producer> probe = std::make_shared<Mlt::Producer>(profile_scenecut, "avformat", path.c_str());
+    if (!probe->is_valid()) {
+        WARN("No avformat support, skipping clip scan benchmark");
+        return;
+    }
+    int length = probe->get_length();
+    SceneCutDetector detector;
+    for (int workers = 1; workers <= QThread::idealThreadCount() && workers <= 4; workers *= 2) {
+        std::vector<std::shared_ptr<Mlt::Producer>> producers;
+        for (int i = 0; i < workers; ++i) {
+            producers.push_back(std::make_shared<Mlt::Producer>(profile_scenecut, "avformat", path.c_str()));
+            REQUIRE(producers.back()->is_valid());
+        }
+        const std::string name = QStringLiteral("Scan %1 frames, %2 producers").arg(length).arg(workers).toStdString();
+        BENCHMARK(name)
+        {
+            detector.detect(producers, length, []() { return false; });
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include "test_utils.hpp"
+
+#include "scopes/colorscopes/scopekernels.h"
+#include <QImage>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+QImage randomImage(int width, int height)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<uint> dist(0, 0xffffff);
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            line[x] = 0xff000000 | dist(gen);
+        }
+    }
+    return image;
+}
+
+int referenceLuma(QRgb c)
+{
+    const int r = int(REC_709_R * 32768 + .5);
+    const int g = int(REC_709_G * 32768 + .5);
+    const int b = int(REC_709_B * 32768 + .5);
+    return qMin(255, (qRed(c) * r + qGreen(c) * g + qBlue(c) * b) >> 15);
+}
+
+// Straightforward per pixel versions of the scopes, as the generators used to compute them
+std::vector<uint> referenceWaveform(const QImage &image, int columns, uint rowStep)
+{
+    std::vector<uint> bins(size_t(columns) * 256, 0);
+    for (int y = 0; y < image.height(); y += int(rowStep)) {
+        for (int x = 0; x < image.width(); ++x) {
+            const int column = x * (columns - 1) / (image.width() - 1);
+            bins[size_t(column) * 256 + size_t(referenceLuma(image.pixel(x, y)))]++;
+        }
+    }
+    return bins;
+}
+
+std::vector<uint> referenceParade(const QImage &image, int columns, uint rowStep)
+{
+    const size_t plane = size_t(columns) * 256;
+    std::vector<uint> bins(plane * 3, 0);
+    for (int y = 0; y < image.height(); y += int(rowStep)) {
+        for (int x = 0; x < image.width(); ++x) {
+            const size_t column = size_t(x * (columns - 1) / (image.width() - 1)) * 256;
+            const QRgb c = image.pixel(x, y);
+            bins[column + size_t(qRed(c))]++;
+            bins[plane + column + size_t(qGreen(c))]++;
+            bins[2 * plane + column + size_t(qBlue(c))]++;
+        }
+    }
+    return bins;
+}
+
+std::array<uint, 1024> referenceHistogram(const QImage &image, uint rowStep)
+{
+    std::array<uint, 1024> bins;
+    bins.fill(0);
+    for (int y = 0; y < image.height(); y += int(rowStep)) {
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb c = image.pixel(x, y);
+            bins[size_t(qRed(c))]++;
+            bins[256 + size_t(qGreen(c))]++;
+            bins[512 + size_t(qBlue(c))]++;
+            bins[768 + size_t(referenceLuma(c))]++;
+        }
+    }
+    return bins;
+}
+
+} // namespace
+
+TEST_CASE("Color scope kernels", "[Scopes]")
+{
+    // Tall enough to be split in several bands
+    const QImage image = randomImage(333, 517);
+
+    SECTION("Luma")
+    {
+        const auto *pixels = reinterpret_cast<const QRgb *>(image.constScanLine(0));
+        std::vector<uchar> luma((size_t)image.width());
+        ScopeKernels::luma(pixels, image.width(), ITURec::Rec_709, luma.data());
+        for (int x = 0; x < image.width(); ++x) {
+            REQUIRE(luma[(size_t)x] == referenceLuma(pixels[x]));
+        }
+    }
+
+    for (uint rowStep : {1u, 3u}) {
+        SECTION("Waveform, row step " + std::to_string(rowStep))
+        {
+            std::vector<uint> bins;
+            ScopeKernels::waveform(image, 120, ITURec::Rec_709, rowStep, bins);
+            REQUIRE(bins == referenceWaveform(image, 120, rowStep));
+        }
+        SECTION("Parade, row step " + std::to_string(rowStep))
+        {
+            std::vector<uint> bins;
+            ScopeKernels::ParadeStats stats;
+            ScopeKernels::parade(image, 90, rowStep, bins, stats);
+            REQUIRE(bins == referenceParade(image, 90, rowStep));
+        }
+        SECTION("Histogram, row step " + std::to_string(rowStep))
+        {
+            std::array<uint, 1024> bins;
+            ScopeKernels::histogram(image, ITURec::Rec_709, true, rowStep, bins);
+            REQUIRE(bins == referenceHistogram(image, rowStep));
+        }
+    }
+
+    SECTION("Parade extremes")
+    {
+        QImage plain(200, 200, QImage::Format_RGB32);
+        plain.fill(qRgb(10, 20, 30));
+        plain.setPixel(150, 150, qRgb(200, 5, 40));
+        std::vector<uint> bins;
+        ScopeKernels::ParadeStats stats;
+        ScopeKernels::parade(plain, 50, 1, bins, stats);
+        REQUIRE(stats.min == std::array<uchar, 3>{{10, 5, 30}});
+        REQUIRE(stats.max == std::array<uchar, 3>{{200, 20, 40}});
+    }
+
+    SECTION("Vectorscope keeps the last color of each point")
+    {
+        QImage plain(100, 300, QImage::Format_RGB32);
+        plain.fill(qRgb(128, 128, 128));
+        // Grays all fall on the center point, the last pixel of the image is a slightly different gray
+        plain.setPixel(99, 299, qRgb(129, 128, 127));
+        const ScopeKernels::ChromaMatrix matrix{-0.0006671f, -0.001299f, 0.0019608f, 0.001961f, -0.001642f, -0.0003189f};
+        std::vector<uint> hits;
+        std::vector<QRgb> colors;
+        ScopeKernels::vectorscope(plain, QSize(101, 101), 101, matrix, 1.f / .7f, 1, hits, &colors);
+        const auto center = size_t(std::max_element(hits.begin(), hits.end()) - hits.begin());
+        REQUIRE(hits[center] == 100 * 300);
+        REQUIRE(colors[center] == qRgb(129, 128, 127));
+    }
+}
+
+TEST_CASE("Color scope kernels benchmark", "[.][benchmark][Scopes]")
+{
+    const QImage image = randomImage(3840, 2160);
+    std::vector<uint> bins;
+    std::array<uint, 1024> histogram;
+    ScopeKernels::ParadeStats stats;
+
+    BENCHMARK("Waveform, per pixel")
+    {
+        bins = referenceWaveform(image, 1920, 1);
+    }
+    BENCHMARK("Waveform, kernel")
+    {
+        ScopeKernels::waveform(image, 1920, ITURec::Rec_709, 1, bins);
+    }
+    BENCHMARK("Parade, per pixel")
+    {
+        bins = referenceParade(image, 1920, 1);
+    }
+    BENCHMARK("Parade, kernel")
+    {
+        ScopeKernels::parade(image, 1920, 1, bins, stats);
+    }
+    BENCHMARK("Histogram, per pixel")
+    {
+        histogram = referenceHistogram(image, 1);
+    }
+    BENCHMARK("Histogram, kernel")
+    {
+        ScopeKernels::histogram(image, ITURec::Rec_709, true, 1, histogram);
+    }
+}
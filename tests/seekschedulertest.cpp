@@ -0,0 +1,94 @@
+#include "test_utils.hpp"
+
+#include "monitor/seekscheduler.h"
+
+TEST_CASE("Seek coalescing", "[SeekScheduler]")
+{
+    SeekScheduler scheduler(100);
+
+    SECTION("Seeks are sent one at a time")
+    {
+        REQUIRE(scheduler.request(10, 0));
+        REQUIRE_FALSE(scheduler.settled());
+        // Frame 10 is not displayed yet, the next requests replace each other
+        REQUIRE_FALSE(scheduler.request(11, 5));
+        REQUIRE_FALSE(scheduler.request(12, 10));
+        REQUIRE_FALSE(scheduler.request(13, 15));
+        REQUIRE(scheduler.target() == 13);
+
+        // Display of frame 10 sends the last request only
+        REQUIRE(scheduler.frameDisplayed(10, 40) == 13);
+        REQUIRE_FALSE(scheduler.settled());
+        REQUIRE(scheduler.frameDisplayed(13, 60) == -1);
+        REQUIRE(scheduler.settled());
+
+        SeekScheduler::Stats stats = scheduler.stats();
+        REQUIRE(stats.requests == 4);
+        REQUIRE(stats.coalesced == 2);
+        REQUIRE(stats.sent == 2);
+        REQUIRE(stats.responseMax == 40);
+        REQUIRE(stats.exactMax == 45);
+        REQUIRE(stats.exactPercentile95 == 45);
+
+        // Once settled, a new request is sent immediately
+        REQUIRE(scheduler.request(20, 100));
+        REQUIRE(scheduler.frameDisplayed(20, 110) == -1);
+        stats = scheduler.stats();
+        REQUIRE(stats.sent == 3);
+        REQUIRE(stats.exactAverage == Approx(27.5));
+        REQUIRE(stats.responseAverage == Approx(25));
+    }
+
+    SECTION("Previews don't complete the seek in progress")
+    {
+        REQUIRE(scheduler.request(10, 0));
+        REQUIRE_FALSE(scheduler.request(30, 5));
+        // A cached frame close to the target is displayed while decoding
+        REQUIRE(scheduler.frameDisplayed(28, 8) == -1);
+        SeekScheduler::Stats stats = scheduler.stats();
+        REQUIRE(stats.responseMax == 8);
+        REQUIRE(stats.exactMax == 0);
+        REQUIRE(scheduler.frameDisplayed(10, 30) == 30);
+        REQUIRE(scheduler.frameDisplayed(30, 50) == -1);
+        REQUIRE(scheduler.settled());
+        REQUIRE(scheduler.stats().exactMax == 45);
+    }
+
+    SECTION("Lost seeks time out")
+    {
+        REQUIRE(scheduler.request(10, 0));
+        REQUIRE_FALSE(scheduler.request(11, 10));
+        REQUIRE(scheduler.expire(50) == -1);
+        // The consumer never displayed frame 10, send the pending seek
+        REQUIRE(scheduler.expire(101) == 11);
+        REQUIRE(scheduler.frameDisplayed(11, 120) == -1);
+        REQUIRE(scheduler.settled());
+
+        // Out of range seek with nothing pending, stop waiting
+        REQUIRE(scheduler.request(1000, 200));
+        REQUIRE(scheduler.frameDisplayed(999, 220) == -1);
+        REQUIRE_FALSE(scheduler.settled());
+        REQUIRE(scheduler.expire(301) == -1);
+        REQUIRE(scheduler.settled());
+
+        // A request arriving after the timeout is sent directly
+        REQUIRE(scheduler.request(40, 400));
+        REQUIRE(scheduler.request(41, 501));
+        REQUIRE(scheduler.stats().sent == 5);
+    }
+
+    SECTION("Cancel and reset")
+    {
+        REQUIRE(scheduler.request(10, 0));
+        REQUIRE_FALSE(scheduler.request(11, 1));
+        scheduler.cancel();
+        REQUIRE(scheduler.settled());
+        REQUIRE(scheduler.frameDisplayed(10, 20) == -1);
+        REQUIRE(scheduler.request(12, 30));
+        scheduler.resetStats();
+        SeekScheduler::Stats stats = scheduler.stats();
+        REQUIRE(stats.requests == 0);
+        REQUIRE(stats.sent == 0);
+        REQUIRE(stats.exactAverage == 0);
+    }
+}
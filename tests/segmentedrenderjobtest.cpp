@@ -0,0 +1,84 @@
+#include "test_utils.hpp"
+
+#include "segmentedrenderjob.h"
+#include <QDomDocument>
+#include <QTemporaryDir>
+
+namespace {
+void writeScene(const QString &path, const QString &consumer)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write(QStringLiteral("<mlt><profile width=\"320\" height=\"240\"/>%1</mlt>").arg(consumer).toUtf8());
+    file.close();
+}
+
+QDomElement readConsumer(const QString &playlist)
+{
+    QFile file(playlist);
+    QDomDocument doc;
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    REQUIRE(doc.setContent(&file, false));
+    return doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+}
+} // namespace
+
+TEST_CASE("Split a render in segments", "[SegmentedRenderJob]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString scene = dir.filePath(QStringLiteral("render.mlt"));
+    const QString target = dir.filePath(QStringLiteral("render.mp4"));
+
+    SECTION("Segments contain whole GOPs, the last one is shorter")
+    {
+        // 650 frames in GOPs of 100 frames: 7 GOPs shared by 4 processes
+        writeScene(scene, QStringLiteral("<consumer mlt_service=\"avformat\" in=\"100\" out=\"749\" g=\"100\"/>"));
+        SegmentedRenderJob job(QStringLiteral("melt"), scene, target, -1, 4, QStringLiteral("ffmpeg"));
+        QString error;
+        REQUIRE(job.prepareSegments(error));
+        REQUIRE(job.m_hasAudio);
+        // 4 video segments and the audio pass
+        REQUIRE(job.m_segments.count() == 5);
+        const QVector<int> starts{100, 300, 500, 700};
+        const QVector<int> frames{200, 200, 200, 50};
+        for (int i = 0; i < 4; ++i) {
+            const auto &segment = job.m_segments.at(i);
+            REQUIRE(segment.frames == frames.at(i));
+            REQUIRE(segment.target == dir.filePath(QStringLiteral("render.segment%1.mp4").arg(i)));
+            QDomElement consumer = readConsumer(segment.playlist);
+            REQUIRE(consumer.attribute(QStringLiteral("in")).toInt() == starts.at(i));
+            REQUIRE(consumer.attribute(QStringLiteral("out")).toInt() == starts.at(i) + frames.at(i) - 1);
+            REQUIRE(consumer.attribute(QStringLiteral("target")) == segment.target);
+            REQUIRE(consumer.attribute(QStringLiteral("an")) == QLatin1String("1"));
+        }
+        const auto &audio = job.m_segments.last();
+        REQUIRE(audio.frames == 650);
+        QDomElement consumer = readConsumer(audio.playlist);
+        REQUIRE(consumer.attribute(QStringLiteral("in")).toInt() == 100);
+        REQUIRE(consumer.attribute(QStringLiteral("out")).toInt() == 749);
+        REQUIRE(consumer.attribute(QStringLiteral("vn")) == QLatin1String("1"));
+        REQUIRE_FALSE(consumer.hasAttribute(QStringLiteral("an")));
+    }
+
+    SECTION("A zone shorter than a GOP is a single segment")
+    {
+        writeScene(scene, QStringLiteral("<consumer mlt_service=\"avformat\" in=\"0\" out=\"99\" an=\"1\"/>"));
+        SegmentedRenderJob job(QStringLiteral("melt"), scene, target, -1, 4, QStringLiteral("ffmpeg"));
+        QString error;
+        REQUIRE(job.prepareSegments(error));
+        REQUIRE_FALSE(job.m_hasAudio);
+        REQUIRE(job.m_segments.count() == 1);
+        REQUIRE(job.m_segments.first().frames == 100);
+    }
+
+    SECTION("An unknown zone is an error")
+    {
+        writeScene(scene, QStringLiteral("<consumer mlt_service=\"avformat\"/>"));
+        SegmentedRenderJob job(QStringLiteral("melt"), scene, target, -1, 4, QStringLiteral("ffmpeg"));
+        QString error;
+        REQUIRE_FALSE(job.prepareSegments(error));
+        REQUIRE_FALSE(error.isEmpty());
+        REQUIRE(job.m_segments.isEmpty());
+    }
+}
@@ -123,4 +123,22 @@ TEST_CASE("Snap points model test", "[SnapModel]")
         REQUIRE(snap.getClosestPoint(9) == 15);
         REQUIRE(snap.getClosestPoint(999) == 15);
     }
+
+    SECTION("Batching")
+    {
+        snap.setBatching(true);
+        for (int i : {40, 10, 30, 10, 20}) {
+            snap.addPoint(i);
+        }
+        // Queries see the queued points
+        REQUIRE(snap.getClosestPoint(12) == 10);
+        snap.addPoint(50);
+        snap.removePoint(10);
+        REQUIRE(snap.getClosestPoint(12) == 10);
+        snap.removePoint(10);
+        REQUIRE(snap.getClosestPoint(12) == 20);
+        snap.addPoint(5);
+        snap.setBatching(false);
+        REQUIRE(snap._snaps() == std::map<int, int>{{5, 1}, {20, 1}, {30, 1}, {40, 1}, {50, 1}});
+    }
 }
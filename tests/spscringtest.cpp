@@ -0,0 +1,65 @@
+#include "test_utils.hpp"
+
+#include "utils/spscring.hpp"
+#include <thread>
+
+TEST_CASE("Single producer single consumer ring", "[SpscRing]")
+{
+    SECTION("Order and overflow")
+    {
+        SpscRing<int, 4> ring;
+        int value = -1;
+        REQUIRE_FALSE(ring.pop(value));
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(ring.push(i));
+        }
+        REQUIRE_FALSE(ring.push(4));
+        REQUIRE(ring.dropped() == 1);
+        REQUIRE(ring.size() == 4);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(ring.pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE_FALSE(ring.pop(value));
+
+        // Indexes wrap around
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(ring.push(i));
+            REQUIRE(ring.pop(value));
+            REQUIRE(value == i);
+        }
+        ring.push(1);
+        ring.push(2);
+        ring.clear();
+        REQUIRE(ring.size() == 0);
+        REQUIRE_FALSE(ring.pop(value));
+    }
+
+    SECTION("Concurrent producer")
+    {
+        SpscRing<int, 64> ring;
+        const int count = 100000;
+        std::thread producer([&ring]() {
+            for (int i = 0; i < count;) {
+                if (ring.push(i)) {
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        int expected = 0;
+        bool ordered = true;
+        while (expected < count) {
+            int value;
+            if (ring.pop(value)) {
+                ordered = ordered && value == expected;
+                ++expected;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        REQUIRE(ordered);
+    }
+}
@@ -0,0 +1,123 @@
+#include "test_utils.hpp"
+#include "utils/thumbnailatlas.hpp"
+#include <QPainter>
+
+TEST_CASE("Thumbnail atlas", "[ThumbnailAtlas]")
+{
+    std::unique_ptr<ThumbnailAtlas> atlas(new ThumbnailAtlas());
+    int recycled = 0;
+    QObject::connect(atlas.get(), &ThumbnailAtlas::slotsRecycled, [&]() { recycled++; });
+
+    // Simulates the end of a background fetch
+    auto store = [&](const QString &binId, int frame, const QColor &color) {
+        QImage img(256, 144, QImage::Format_ARGB32);
+        img.fill(color);
+        quint64 generation = ++atlas->m_generation;
+        atlas->m_pending[{binId, frame}] = generation;
+        atlas->insert(binId, frame, img, generation);
+    };
+    auto uploads = [&](int page, quint64 &revision) {
+        int count = 0;
+        revision = atlas->updatedSlots(page, revision, [&](const QImage &, const QRect &) { count++; });
+        return count;
+    };
+
+    store(QStringLiteral("1"), 0, Qt::red);
+    store(QStringLiteral("1"), 5, Qt::blue);
+    REQUIRE(atlas->pageCount() == 1);
+    // Slots follow the thumbnail aspect ratio
+    REQUIRE(atlas->m_slotSize == QSize(160, ThumbnailAtlas::SlotHeight));
+    ThumbnailAtlas::Slot first = atlas->slot(QStringLiteral("1"), 0);
+    ThumbnailAtlas::Slot second = atlas->slot(QStringLiteral("1"), 5);
+    REQUIRE(first.page == 0);
+    REQUIRE(second.page == 0);
+    REQUIRE(first.rect == QRect(0, 0, 160, 90));
+    REQUIRE(second.rect == QRect(160, 0, 160, 90));
+    REQUIRE(atlas->m_pages[0].image.pixelColor(first.rect.center()) == QColor(Qt::red));
+    REQUIRE(atlas->m_pages[0].image.pixelColor(second.rect.center()) == QColor(Qt::blue));
+
+    SECTION("Only new thumbnails are uploaded")
+    {
+        quint64 revision = 0;
+        REQUIRE(uploads(0, revision) == 2);
+        REQUIRE(revision == atlas->pageRevision(0));
+        REQUIRE(uploads(0, revision) == 0);
+        store(QStringLiteral("2"), 0, Qt::green);
+        REQUIRE(atlas->pageRevision(0) > revision);
+        REQUIRE(uploads(0, revision) == 1);
+        REQUIRE(uploads(1, revision) == 0);
+    }
+
+    SECTION("Outdated fetches are dropped")
+    {
+        quint64 generation = ++atlas->m_generation;
+        atlas->m_pending[{QStringLiteral("2"), 0}] = generation;
+        atlas->invalidateClip(QStringLiteral("2"));
+        QImage img(256, 144, QImage::Format_ARGB32);
+        img.fill(Qt::green);
+        atlas->insert(QStringLiteral("2"), 0, img, generation);
+        REQUIRE(atlas->m_index.size() == 2);
+    }
+
+    SECTION("Invalidated clips free their slots")
+    {
+        atlas->invalidateClip(QStringLiteral("1"));
+        REQUIRE(recycled == 1);
+        REQUIRE(atlas->m_index.empty());
+        REQUIRE(atlas->m_freeSlots.size() == size_t(atlas->slotsPerPage()));
+        store(QStringLiteral("2"), 0, Qt::green);
+        REQUIRE(atlas->pageCount() == 1);
+    }
+
+    SECTION("Least recently used slots are recycled when full")
+    {
+        const int capacity = ThumbnailAtlas::MaxPages * atlas->slotsPerPage();
+        for (int i = 2; i < capacity; ++i) {
+            store(QStringLiteral("2"), i, Qt::green);
+        }
+        REQUIRE(atlas->pageCount() == ThumbnailAtlas::MaxPages);
+        REQUIRE(recycled == 0);
+        // Displaying the first thumbnail keeps it in the atlas
+        atlas->slot(QStringLiteral("1"), 0);
+        store(QStringLiteral("3"), 0, Qt::black);
+        REQUIRE(recycled == 1);
+        REQUIRE(atlas->m_index.size() == size_t(capacity));
+        REQUIRE(atlas->m_index.count({QStringLiteral("1"), 0}) == 1);
+        REQUIRE(atlas->m_index.count({QStringLiteral("1"), 5}) == 0);
+        REQUIRE(atlas->slot(QStringLiteral("3"), 0).rect == second.rect);
+    }
+
+    SECTION("Thumbnails of another aspect ratio are cropped, not distorted")
+    {
+        // Square image with blue bands on the top and bottom quarters
+        QImage img(144, 144, QImage::Format_ARGB32);
+        img.fill(Qt::red);
+        QPainter painter(&img);
+        painter.fillRect(0, 0, 144, 36, Qt::blue);
+        painter.fillRect(0, 108, 144, 36, Qt::blue);
+        painter.end();
+        quint64 generation = ++atlas->m_generation;
+        atlas->m_pending[{QStringLiteral("2"), 0}] = generation;
+        atlas->insert(QStringLiteral("2"), 0, img, generation);
+        ThumbnailAtlas::Slot slot = atlas->slot(QStringLiteral("2"), 0);
+        REQUIRE(slot.rect.size() == QSize(160, 90));
+        const QImage &page = atlas->m_pages[slot.page].image;
+        // The slot shows the middle of the image at its original aspect ratio: the bands are mostly cut out
+        REQUIRE(page.pixelColor(slot.rect.topLeft() + QPoint(2, 10)) == QColor(Qt::red));
+        REQUIRE(page.pixelColor(slot.rect.bottomRight() - QPoint(2, 10)) == QColor(Qt::red));
+        REQUIRE(page.pixelColor(slot.rect.topLeft() + QPoint(2, 1)) == QColor(Qt::blue));
+    }
+
+    SECTION("Clearing resets the slot size")
+    {
+        atlas->clear();
+        REQUIRE(atlas->pageCount() == 0);
+        REQUIRE(atlas->m_index.empty());
+        QImage img(100, 100, QImage::Format_ARGB32);
+        img.fill(Qt::red);
+        quint64 generation = ++atlas->m_generation;
+        atlas->m_pending[{QStringLiteral("1"), 0}] = generation;
+        atlas->insert(QStringLiteral("1"), 0, img, generation);
+        REQUIRE(atlas->m_slotSize == QSize(90, 90));
+    }
+}
@@ -0,0 +1,125 @@
+#include "test_utils.hpp"
+
+#include "utils/thumbnailpack.hpp"
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+namespace {
+QImage makeThumb(int frame)
+{
+    // Thumbnails with an alpha channel are stored in PNG, so they are read back unchanged
+    QImage img(32, 18, QImage::Format_ARGB32);
+    img.fill(QColor(frame % 256, 100, 200, 128));
+    return img;
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    return file.readAll();
+}
+
+void writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+}
+} // namespace
+
+TEST_CASE("Thumbnail pack", "[ThumbnailPack]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("0123456789abcdef.thumbs"));
+
+    SECTION("Thumbnails are written and reloaded")
+    {
+        {
+            ThumbnailPack pack(path);
+            REQUIRE_FALSE(pack.contains(0));
+            REQUIRE_FALSE(QFile::exists(path));
+            REQUIRE(pack.append(0, makeThumb(0)));
+            REQUIRE(pack.append(25, makeThumb(25)));
+            // The last record of a frame wins
+            REQUIRE(pack.append(25, makeThumb(26)));
+            QImage opaque(32, 18, QImage::Format_RGB32);
+            opaque.fill(Qt::red);
+            REQUIRE(pack.append(50, opaque));
+            REQUIRE(pack.read(0) == makeThumb(0));
+        }
+        ThumbnailPack pack(path);
+        REQUIRE(pack.contains(0));
+        REQUIRE(pack.contains(25));
+        REQUIRE_FALSE(pack.contains(1));
+        REQUIRE(pack.read(0) == makeThumb(0));
+        REQUIRE(pack.read(25) == makeThumb(26));
+        REQUIRE(pack.read(50).size() == QSize(32, 18));
+        REQUIRE(pack.read(1).isNull());
+
+        pack.discard();
+        REQUIRE_FALSE(QFile::exists(path));
+        REQUIRE_FALSE(pack.contains(0));
+        REQUIRE(pack.append(3, makeThumb(3)));
+        REQUIRE(pack.read(3) == makeThumb(3));
+    }
+
+    SECTION("A truncated record is dropped")
+    {
+        qint64 completeSize = 0;
+        {
+            ThumbnailPack pack(path);
+            REQUIRE(pack.append(1, makeThumb(1)));
+            completeSize = QFileInfo(path).size();
+            REQUIRE(pack.append(2, makeThumb(2)));
+        }
+        // Simulate a crash while writing the second record
+        QFile file(path);
+        REQUIRE(file.resize(QFileInfo(path).size() - 10));
+        {
+            ThumbnailPack pack(path);
+            REQUIRE(pack.read(1) == makeThumb(1));
+            REQUIRE_FALSE(pack.contains(2));
+            REQUIRE(QFileInfo(path).size() == completeSize);
+            // New records are written after the last complete one
+            REQUIRE(pack.append(2, makeThumb(2)));
+        }
+        ThumbnailPack pack(path);
+        REQUIRE(pack.read(1) == makeThumb(1));
+        REQUIRE(pack.read(2) == makeThumb(2));
+    }
+
+    SECTION("An unknown file is kept aside")
+    {
+        writeFile(path, QByteArray("not a thumbnail pack"));
+        ThumbnailPack pack(path);
+        REQUIRE_FALSE(pack.contains(0));
+        REQUIRE(readFile(path + QStringLiteral(".bak")) == QByteArray("not a thumbnail pack"));
+        REQUIRE(pack.append(0, makeThumb(0)));
+        REQUIRE(pack.read(0) == makeThumb(0));
+    }
+
+    SECTION("Legacy thumbnails are moved into the pack")
+    {
+        REQUIRE(makeThumb(4).save(dir.filePath(QStringLiteral("0123456789abcdef#4.png"))));
+        REQUIRE(makeThumb(12).save(dir.filePath(QStringLiteral("0123456789abcdef#12.png"))));
+        // Thumbnails of another clip are left alone
+        REQUIRE(makeThumb(4).save(dir.filePath(QStringLiteral("fedcba9876543210#4.png"))));
+        writeFile(dir.filePath(QStringLiteral("0123456789abcdef#bad.png")), QByteArray("garbage"));
+        {
+            ThumbnailPack pack(path);
+            REQUIRE(pack.contains(4));
+            REQUIRE(pack.read(12) == makeThumb(12));
+            REQUIRE(QDir(dir.path()).entryList({QStringLiteral("0123456789abcdef#*")}).isEmpty());
+            REQUIRE(QFile::exists(dir.filePath(QStringLiteral("fedcba9876543210#4.png"))));
+        }
+        ThumbnailPack pack(path);
+        REQUIRE(pack.read(4) == makeThumb(4));
+        REQUIRE(pack.read(12) == makeThumb(12));
+    }
+}
@@ -0,0 +1,179 @@
+#include "test_utils.hpp"
+
+Mlt::Profile profile_range;
+
+// Reference implementation: linear scan over every item of the track
+std::unordered_set<int> scanClipsInRange(const std::shared_ptr<TrackModel> &track, int position, int end)
+{
+    std::unordered_set<int> ids;
+    for (const auto &clp : track->m_allClips) {
+        int pos = clp.second->getPosition();
+        int length = clp.second->getPlaytime();
+        if (end > -1 && pos >= end) {
+            continue;
+        }
+        if (pos >= position || pos + length - 1 >= position) {
+            ids.insert(clp.first);
+        }
+    }
+    return ids;
+}
+
+std::unordered_set<int> scanCompositionsInRange(const std::shared_ptr<TrackModel> &track, int position, int end)
+{
+    std::unordered_set<int> ids;
+    for (const auto &compo : track->m_allCompositions) {
+        int pos = compo.second->getPosition();
+        int length = compo.second->getPlaytime();
+        if (end > -1 && pos >= end) {
+            continue;
+        }
+        if (pos >= position || pos + length - 1 >= position) {
+            ids.insert(compo.first);
+        }
+    }
+    return ids;
+}
+
+TEST_CASE("Track range queries", "[TrackModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_range, guideModel, undoStack);
+
+    QString aCompo;
+    for (const auto &trans : TransitionsRepository::get()->getNames()) {
+        if (TransitionsRepository::get()->isComposition(trans.first)) {
+            aCompo = trans.first;
+            break;
+        }
+    }
+    REQUIRE(!aCompo.isEmpty());
+
+    QString binId = createProducer(profile_range, "red", binModel, 20);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    auto track = timeline->getTrackById(tid1);
+
+    auto checkRanges = [&]() {
+        REQUIRE(timeline->checkConsistency());
+        for (int start = 0; start < 130; start += 3) {
+            for (int end : {-1, start + 1, start + 7, start + 40}) {
+                REQUIRE(track->getClipsInRange(start, end) == scanClipsInRange(track, start, end));
+                REQUIRE(track->getCompositionsInRange(start, end) == scanCompositionsInRange(track, start, end));
+            }
+        }
+    };
+
+    // clips [0,19] [30,49] [60,79], compositions [5,14] [40,49]
+    int cid1, cid2, cid3;
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 0, cid1));
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 30, cid2));
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 60, cid3));
+    int compo1 = CompositionModel::construct(timeline, aCompo);
+    int compo2 = CompositionModel::construct(timeline, aCompo);
+    REQUIRE(timeline->requestCompositionMove(compo1, tid1, 5));
+    REQUIRE(timeline->requestItemResize(compo1, 10, true) > -1);
+    REQUIRE(timeline->requestCompositionMove(compo2, tid1, 40));
+    REQUIRE(timeline->requestItemResize(compo2, 10, true) > -1);
+    checkRanges();
+
+    REQUIRE(track->getClipsInRange(10, 11) == std::unordered_set<int>({cid1}));
+    REQUIRE(track->getClipsInRange(20, 30).empty());
+    REQUIRE(track->getClipsInRange(45, -1) == std::unordered_set<int>({cid2, cid3}));
+    REQUIRE(track->getCompositionsInRange(10, 45) == std::unordered_set<int>({compo1, compo2}));
+
+    SECTION("Index follows moves, resizes and deletions")
+    {
+        REQUIRE(timeline->requestClipMove(cid2, tid1, 90));
+        checkRanges();
+        REQUIRE(timeline->requestItemResize(cid3, 10, false) > -1);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        checkRanges();
+        REQUIRE(timeline->requestClipMove(cid1, tid2, 0));
+        checkRanges();
+        REQUIRE(track->getClipsInRange(0, 20).empty());
+        REQUIRE(timeline->requestCompositionMove(compo2, tid1, 100));
+        checkRanges();
+        REQUIRE(timeline->requestItemDeletion(cid3));
+        REQUIRE(timeline->requestItemDeletion(compo1));
+        checkRanges();
+        undoStack->undo();
+        checkRanges();
+        undoStack->undo();
+        checkRanges();
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        checkRanges();
+        undoStack->redo();
+        undoStack->redo();
+        checkRanges();
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Track range query benchmark", "[.][benchmark][TrackModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_range, guideModel, undoStack);
+
+    const int clipCount = 10000;
+    const int length = 10;
+    QString binId = createProducer(profile_range, "red", binModel, length);
+    int tid1 = TrackModel::construct(timeline);
+    auto track = timeline->getTrackById(tid1);
+    for (int i = 0; i < clipCount; ++i) {
+        int cid;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, i * length, cid, false));
+    }
+    REQUIRE(track->getClipsCount() == clipCount);
+
+    const int queries = 1000;
+    std::default_random_engine gen(42);
+    std::uniform_int_distribution<int> dist(0, clipCount * length);
+    std::vector<int> starts;
+    for (int i = 0; i < queries; ++i) {
+        starts.push_back(dist(gen));
+    }
+    size_t indexed = 0, scanned = 0;
+    BENCHMARK("Indexed range query, 10k clips")
+    {
+        for (int start : starts) {
+            indexed += track->getClipsInRange(start, start + 5 * length).size();
+        }
+    }
+    BENCHMARK("Linear scan range query, 10k clips")
+    {
+        for (int start : starts) {
+            scanned += scanClipsInRange(track, start, start + 5 * length).size();
+        }
+    }
+    REQUIRE(indexed > 0);
+    REQUIRE(scanned > 0);
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
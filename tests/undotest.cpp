@@ -0,0 +1,165 @@
+#include "test_utils.hpp"
+
+#include "macros.hpp"
+#include <random>
+
+Mlt::Profile profile_undo;
+
+namespace {
+
+// Reference implementations: the nested lambda chains that FunTransaction replaces
+void nestedUpdate(Fun &lambda, const Fun &operation, bool reverse)
+{
+    Fun previous = lambda;
+    if (reverse) {
+        lambda = [operation, previous]() {
+            bool v = operation();
+            return previous() && v;
+        };
+    } else {
+        lambda = [operation, previous]() {
+            bool v = previous();
+            return operation() && v;
+        };
+    }
+}
+
+void nestedPush(Fun &lambda, const Fun &operation, bool front)
+{
+    Fun previous = lambda;
+    if (front) {
+        lambda = [operation, previous]() {
+            bool v = operation();
+            return v && previous();
+        };
+    } else {
+        lambda = [operation, previous]() {
+            bool v = previous();
+            return v && operation();
+        };
+    }
+}
+
+} // namespace
+
+TEST_CASE("Flat undo transactions", "[Undo]")
+{
+    SECTION("Execution order")
+    {
+        QString log;
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        for (int i = 0; i < 5; ++i) {
+            Fun operation = [&log, i]() {
+                log.append(QString::number(i));
+                return true;
+            };
+            Fun reverse = [&log, i]() {
+                log.append(QString::number(-i));
+                return true;
+            };
+            UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+        }
+        REQUIRE(FunTransaction::count(undo) == 6);
+        REQUIRE(FunTransaction::count(redo) == 6);
+        REQUIRE(redo());
+        REQUIRE(log == QStringLiteral("01234"));
+        log.clear();
+        REQUIRE(undo());
+        REQUIRE(log == QStringLiteral("-4-3-2-10"));
+
+        // Copies are independent
+        Fun copy = redo;
+        PUSH_LAMBDA([]() { return true; }, copy);
+        REQUIRE(FunTransaction::count(copy) == 7);
+        REQUIRE(FunTransaction::count(redo) == 6);
+    }
+
+    SECTION("Same results and side effects as nested lambdas")
+    {
+        std::mt19937 gen(42);
+        for (int trial = 0; trial < 2000; ++trial) {
+            const int count = int(gen() % 12) + 1;
+            QString nestedLog, flatLog;
+            Fun nestedUndo = []() { return true; };
+            Fun nestedRedo = []() { return true; };
+            Fun flatUndo = nestedUndo;
+            Fun flatRedo = nestedRedo;
+            for (int i = 0; i < count; ++i) {
+                const bool fails = gen() % 4 == 0;
+                const int kind = int(gen() % 4);
+                auto make = [i, fails](QString &log) {
+                    return Fun([&log, i, fails]() {
+                        log.append(QChar('a' + i));
+                        return !fails;
+                    });
+                };
+                Fun &nestedTarget = (i % 2) ? nestedUndo : nestedRedo;
+                Fun &flatTarget = (i % 2) ? flatUndo : flatRedo;
+                switch (kind) {
+                case 0:
+                    nestedUpdate(nestedTarget, make(nestedLog), i % 2);
+                    FunTransaction::append(flatTarget, make(flatLog), i % 2);
+                    break;
+                case 1:
+                    nestedPush(nestedTarget, make(nestedLog), false);
+                    PUSH_LAMBDA(make(flatLog), flatTarget);
+                    break;
+                default:
+                    nestedPush(nestedTarget, make(nestedLog), true);
+                    PUSH_FRONT_LAMBDA(make(flatLog), flatTarget);
+                    break;
+                }
+            }
+            REQUIRE(nestedUndo() == flatUndo());
+            REQUIRE(nestedRedo() == flatRedo());
+            REQUIRE(nestedLog == flatLog);
+        }
+    }
+}
+
+TEST_CASE("Large group move benchmark", "[.][benchmark][Undo]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_undo, guideModel, undoStack);
+
+    const int clipCount = 5000;
+    const int length = 10;
+    QString binId = createProducer(profile_undo, "red", binModel, length);
+    int tid1 = TrackModel::construct(timeline);
+    std::unordered_set<int> clips;
+    for (int i = 0; i < clipCount; ++i) {
+        int cid;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, i * length, cid, false));
+        clips.insert(cid);
+    }
+    int gid = timeline->requestClipsGroup(clips, false);
+    REQUIRE(gid > -1);
+    const int first = *clips.begin();
+    const int position = timeline->getClipPosition(first);
+
+    BENCHMARK("Move a 5000 clips group")
+    {
+        REQUIRE(timeline->requestGroupMove(first, gid, 0, length, true, true));
+    }
+    BENCHMARK("Undo the group moves")
+    {
+        while (undoStack->canUndo()) {
+            undoStack->undo();
+        }
+    }
+    REQUIRE(timeline->getClipPosition(first) == position);
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
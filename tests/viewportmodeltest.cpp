@@ -0,0 +1,172 @@
+#include "test_utils.hpp"
+#include "timeline2/view/timelineviewportmodel.h"
+
+#include <QElapsedTimer>
+
+Mlt::Profile profile_viewport;
+
+TEST_CASE("Timeline viewport filtering", "[TimelineViewportModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_viewport, guideModel, undoStack);
+
+    const int length = 10;
+    QString binId = createProducer(profile_viewport, "red", binModel, length);
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    // 100 clips covering [0, 999] on the first track
+    std::vector<int> clips;
+    for (int i = 0; i < 100; ++i) {
+        int cid;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, i * length, cid));
+        clips.push_back(cid);
+    }
+
+    TimelineViewportModel viewport;
+    viewport.setSourceModel(timeline.get());
+    auto itemCount = [&](int tid) {
+        QModelIndex source = timeline->makeTrackIndexFromID(tid);
+        return viewport.rowCount(viewport.mapFromSource(source));
+    };
+
+    // Without a range, everything is displayed
+    REQUIRE(viewport.rowCount() == 2);
+    REQUIRE(itemCount(tid1) == 100);
+
+    // Covered range is the visible one plus a screen on each side: [100, 400[
+    viewport.setVisibleRange(200, 300);
+    REQUIRE(viewport.coveredStart() == 100);
+    REQUIRE(viewport.coveredEnd() == 400);
+    REQUIRE(viewport.rowCount() == 2);
+    REQUIRE(itemCount(tid1) == 30);
+    int passes = viewport.filterPasses();
+
+    SECTION("Small scrolls don't touch the filter")
+    {
+        viewport.setVisibleRange(220, 320);
+        viewport.setVisibleRange(180, 280);
+        REQUIRE(viewport.filterPasses() == passes);
+        REQUIRE(viewport.coveredStart() == 100);
+        REQUIRE(itemCount(tid1) == 30);
+
+        viewport.setVisibleRange(700, 800);
+        REQUIRE(viewport.filterPasses() == passes + 1);
+        REQUIRE(itemCount(tid1) == 30);
+
+        // Zooming in shrinks the covered range, zooming out extends it
+        viewport.setVisibleRange(740, 760);
+        REQUIRE(viewport.coveredStart() == 720);
+        REQUIRE(viewport.coveredEnd() == 780);
+        REQUIRE(itemCount(tid1) == 6);
+        viewport.setVisibleRange(0, 1000);
+        REQUIRE(itemCount(tid1) == 100);
+    }
+
+    SECTION("Empty areas don't trigger a filter pass")
+    {
+        viewport.setVisibleRange(5000, 5100);
+        REQUIRE(itemCount(tid1) == 0);
+        passes = viewport.filterPasses();
+        viewport.setVisibleRange(8000, 8100);
+        REQUIRE(viewport.filterPasses() == passes);
+    }
+
+    SECTION("Items follow their moves")
+    {
+        REQUIRE(timeline->requestClipMove(clips[0], tid2, 250));
+        REQUIRE(itemCount(tid2) == 1);
+        REQUIRE(timeline->requestClipMove(clips[0], tid2, 2000));
+        REQUIRE(itemCount(tid2) == 0);
+        REQUIRE(timeline->requestClipMove(clips[50], tid2, 150));
+        REQUIRE(itemCount(tid1) == 30);
+        REQUIRE(itemCount(tid2) == 1);
+        undoStack->undo();
+        REQUIRE(itemCount(tid2) == 0);
+        REQUIRE(itemCount(tid1) == 30);
+    }
+
+    SECTION("Selected items are kept")
+    {
+        REQUIRE(timeline->requestSetSelection({clips[25]}));
+        viewport.setVisibleRange(700, 800);
+        REQUIRE(itemCount(tid1) == 31);
+        REQUIRE(timeline->requestClearSelection());
+        viewport.setVisibleRange(5000, 5100);
+        REQUIRE(itemCount(tid1) == 0);
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
+
+TEST_CASE("Timeline viewport scrolling benchmark", "[.][benchmark][TimelineViewportModel]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    std::shared_ptr<TimelineItemModel> timeline = TimelineItemModel::construct(&profile_viewport, guideModel, undoStack);
+
+    // 4 tracks of 5000 clips
+    const int tracks = 4;
+    const int clipCount = 5000;
+    const int length = 10;
+    QString binId = createProducer(profile_viewport, "red", binModel, length);
+    for (int t = 0; t < tracks; ++t) {
+        int tid = TrackModel::construct(timeline);
+        for (int i = 0; i < clipCount; ++i) {
+            int cid;
+            REQUIRE(timeline->requestClipInsertion(binId, tid, i * length, cid, false));
+        }
+    }
+    const int duration = clipCount * length;
+    const int screen = 400;
+
+    TimelineViewportModel viewport;
+    viewport.setSourceModel(timeline.get());
+    auto materialized = [&]() {
+        int count = 0;
+        for (int row = 0; row < viewport.rowCount(); ++row) {
+            count += viewport.rowCount(viewport.index(row, 0));
+        }
+        return count;
+    };
+    REQUIRE(materialized() == tracks * clipCount);
+
+    // Scroll through the whole project by steps of a tenth of screen, as a wheel scroll would do
+    QElapsedTimer timer;
+    qint64 worst = 0;
+    int maxItems = 0;
+    BENCHMARK("Scrolling 20k clips, 400 frames visible")
+    {
+        for (int start = 0; start + screen < duration; start += screen / 10) {
+            timer.start();
+            viewport.setVisibleRange(start, start + screen);
+            worst = qMax(worst, timer.nsecsElapsed());
+            maxItems = qMax(maxItems, materialized());
+        }
+    }
+    qDebug() << "worst scroll step" << worst / 1000 << "us, filter passes" << viewport.filterPasses() << ", at most" << maxItems << "delegates out of"
+             << tracks * clipCount;
+    REQUIRE(maxItems <= tracks * (4 * screen / length + 2));
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+}
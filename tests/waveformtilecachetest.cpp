@@ -0,0 +1,119 @@
+#include "test_utils.hpp"
+
+#include "lib/audio/audioPeaks.h"
+#include "utils/waveformtilecache.hpp"
+#include <QTemporaryDir>
+
+namespace {
+WaveformTileCache::TileKey makeKey(const QString &clipHash, int tile)
+{
+    WaveformTileCache::TileKey key;
+    key.clipHash = clipHash;
+    key.stream = 0;
+    key.zoom = WaveformTileCache::zoomKey(0.5);
+    key.tile = tile;
+    key.height = 40;
+    key.channels = 2;
+    key.separateChannels = false;
+    key.color = QColor(Qt::red).rgba();
+    return key;
+}
+
+QImage makeTile(const QColor &color)
+{
+    QImage img(WaveformTileCache::TileWidth, 40, QImage::Format_ARGB32_Premultiplied);
+    img.fill(color);
+    return img;
+}
+} // namespace
+
+TEST_CASE("Waveform tile cache", "[WaveformTileCache]")
+{
+    std::unique_ptr<WaveformTileCache> cache(new WaveformTileCache());
+    QStringList ready;
+    QObject::connect(cache.get(), &WaveformTileCache::tileReady, [&](const QString &clipHash) { ready << clipHash; });
+    // Simulates the request of a tile, returns the generation that the renderer would use
+    auto request = [&](const WaveformTileCache::TileKey &key) {
+        quint64 generation = ++cache->m_generation;
+        cache->m_pending[key] = generation;
+        return generation;
+    };
+    const QString clip = QStringLiteral("abcd");
+
+    SECTION("Rendered tiles are cached")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("test.peaks"));
+        // Full scale square wave, so that the merged waveform fills the tile
+        std::vector<qint16> minimums(1000 * 2 * 2, -32768);
+        std::vector<qint16> maximums(1000 * 2 * 2, 32767);
+        REQUIRE(AudioPeakFile::write(path, 2, 2, minimums, maximums));
+        auto peaks = AudioPeakFile::open(path);
+        REQUIRE(peaks);
+
+        auto key = makeKey(clip, 1);
+        REQUIRE(cache->tile(key, peaks).isNull());
+        // A pending tile is not rendered twice
+        REQUIRE(cache->tile(key, peaks).isNull());
+        cache->m_pool.waitForDone();
+        REQUIRE(ready == QStringList({clip}));
+        QImage img = cache->tile(key, nullptr);
+        REQUIRE(img.size() == QSize(WaveformTileCache::TileWidth, 40));
+        REQUIRE(img.pixelColor(WaveformTileCache::TileWidth / 2, 20) == QColor(Qt::red));
+        // Without peaks, a missing tile is not rendered
+        REQUIRE(cache->tile(makeKey(clip, 2), nullptr).isNull());
+        REQUIRE(cache->m_pending.empty());
+    }
+
+    SECTION("Least recently used tiles are evicted")
+    {
+        cache->m_maxMemory = 2 * makeTile(Qt::red).sizeInBytes();
+        for (int i = 0; i < 2; ++i) {
+            auto key = makeKey(clip, i);
+            cache->insert(key, makeTile(Qt::red), request(key));
+        }
+        // Use the first tile so that the second is the oldest
+        REQUIRE_FALSE(cache->tile(makeKey(clip, 0), nullptr).isNull());
+        auto key = makeKey(clip, 2);
+        cache->insert(key, makeTile(Qt::red), request(key));
+        REQUIRE(cache->m_tiles.size() == 2);
+        REQUIRE_FALSE(cache->tile(makeKey(clip, 0), nullptr).isNull());
+        REQUIRE(cache->tile(makeKey(clip, 1), nullptr).isNull());
+        REQUIRE_FALSE(cache->tile(makeKey(clip, 2), nullptr).isNull());
+        REQUIRE(cache->m_memory == cache->m_maxMemory);
+    }
+
+    SECTION("Invalidation removes the tiles of a clip")
+    {
+        const QString other = QStringLiteral("efgh");
+        auto key = makeKey(clip, 0);
+        auto otherKey = makeKey(other, 0);
+        cache->insert(key, makeTile(Qt::red), request(key));
+        cache->insert(otherKey, makeTile(Qt::red), request(otherKey));
+        cache->invalidateClip(clip);
+        REQUIRE(cache->tile(key, nullptr).isNull());
+        REQUIRE_FALSE(cache->tile(otherKey, nullptr).isNull());
+        REQUIRE(cache->m_memory == makeTile(Qt::red).sizeInBytes());
+    }
+
+    SECTION("Tiles rendered before an invalidation are dropped")
+    {
+        auto key = makeKey(clip, 0);
+        quint64 stale = request(key);
+        cache->invalidateClip(clip);
+        ready.clear();
+        cache->insert(key, makeTile(Qt::red), stale);
+        REQUIRE(cache->tile(key, nullptr).isNull());
+        REQUIRE(ready.isEmpty());
+
+        // The tile is requested again before the outdated render ends
+        quint64 current = request(key);
+        cache->insert(key, makeTile(Qt::red), stale);
+        REQUIRE(cache->tile(key, nullptr).isNull());
+        REQUIRE(cache->m_pending.count(key) == 1);
+        cache->insert(key, makeTile(Qt::blue), current);
+        REQUIRE(cache->tile(key, nullptr).pixelColor(0, 0) == QColor(Qt::blue));
+        REQUIRE(ready == QStringList({clip}));
+    }
+}